@@ -28,6 +28,7 @@
 #include "Component/ParticleEmitter.hpp"
 #include "Component/RigidBody.hpp"
 #include "Component/Terrain.hpp"
+#include "Component/TerrainStream.hpp"
 #include "Component/Texture.hpp"
 #include "Component/Transform.hpp"
 
@@ -146,6 +147,7 @@ private:
 				m_openGL_renderer.end_frame();
 				m_window.end_ImGui_frame();
 				m_window.swap_buffers();
+				m_asset_manager.destroy_released();
 
 				duration_since_last_render_tick = Duration::zero();
 			}
@@ -185,6 +187,7 @@ int main(int argc, char* argv[])
 		ECS::Component::set_info<Component::ParticleEmitter>();
 		ECS::Component::set_info<Component::RigidBody>();
 		ECS::Component::set_info<Component::Terrain>();
+		ECS::Component::set_info<Component::TerrainStream>();
 		ECS::Component::set_info<Component::Texture>();
 		ECS::Component::set_info<Component::Transform>();
 
@@ -4,8 +4,48 @@
 
 #include "imgui.h"
 
+#include <algorithm>
+#include <tuple>
+
 namespace Data
 {
+	void Mesh::remove_duplicate_positions()
+	{
+		std::sort(vertex_positions.begin(), vertex_positions.end(), [](const glm::vec3& p_a, const glm::vec3& p_b)
+			{ return std::tie(p_a.x, p_a.y, p_a.z) < std::tie(p_b.x, p_b.y, p_b.z); });
+		vertex_positions.erase(std::unique(vertex_positions.begin(), vertex_positions.end()), vertex_positions.end());
+		vertex_positions.shrink_to_fit();
+	}
+
+	const Geometry::ConvexHull& Mesh::get_convex_hull() const
+	{
+		std::call_once(convex_hull->build_flag, [this]()
+		{
+			convex_hull->hull  = Geometry::ConvexHull(vertex_positions);
+			convex_hull->built = true;
+		});
+		return convex_hull->hull;
+	}
+
+	void Mesh::build_triangle_BVH(const std::vector<unsigned int>* p_indices)
+	{
+		std::vector<Geometry::Triangle> triangles;
+		if (p_indices)
+		{
+			triangles.reserve(p_indices->size() / 3);
+			for (size_t i = 0; i + 2 < p_indices->size(); i += 3)
+				triangles.emplace_back(vertex_positions[(*p_indices)[i]], vertex_positions[(*p_indices)[i + 1]], vertex_positions[(*p_indices)[i + 2]]);
+		}
+		else
+		{
+			triangles.reserve(vertex_positions.size() / 3);
+			for (size_t i = 0; i + 2 < vertex_positions.size(); i += 3)
+				triangles.emplace_back(vertex_positions[i], vertex_positions[i + 1], vertex_positions[i + 2]);
+		}
+
+		triangle_BVH.emplace(std::move(triangles));
+	}
+
 	void Mesh::draw_UI()
 	{
 		auto formated_verts = Utility::number_with_seperator(VAO.draw_count());
@@ -38,6 +78,14 @@ namespace Data
 		ImGui::Text_Manual("Buffer used %sB (%.2f%%)", formatted_used_capacity.c_str(), vert_buffer.used_capacity_ratio() * 100.f);
 
 		AABB.draw_UI("Bounds");
+		ImGui::Text("Unique positions",    vertex_positions.size());
+		if (convex_hull->built)
+			ImGui::Text("Convex hull vertices", convex_hull->hull.vertices().size());
+		if (triangle_BVH)
+		{
+			ImGui::Text("BVH triangles", triangle_BVH->triangles().size());
+			ImGui::Text("BVH nodes",     triangle_BVH->bvh().nodes().size());
+		}
 	}
 }
 
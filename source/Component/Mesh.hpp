@@ -2,11 +2,17 @@
 
 #include "Data/Vertex.hpp"
 #include "Geometry/AABB.hpp"
+#include "Geometry/ConvexHull.hpp"
+#include "Geometry/TriangleBVH.hpp"
 #include "OpenGL/Types.hpp"
 #include "Utility/ResourceManager.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <vector>
 
 namespace Data
@@ -17,20 +23,41 @@ namespace Data
 		OpenGL::Buffer vert_buffer; // VBO for vertex data.
 		std::optional<OpenGL::Buffer> index_buffer; // EBO for indexed rendering.
 
+		// The convex hull is only used by GJK/EPA so it's built on the first get_convex_hull rather than for every mesh constructed.
+		// Held by pointer as the once_flag can't be moved.
+		struct LazyConvexHull
+		{
+			std::once_flag build_flag;
+			std::atomic<bool> built = false;
+			Geometry::ConvexHull hull;
+		};
+		std::unique_ptr<LazyConvexHull> convex_hull;
+
+		// Remove the duplicate vertex_positions shared between faces.
+		void remove_duplicate_positions();
+		// Build the triangle_BVH from the triangles of vertex_positions before they are deduplicated by remove_duplicate_positions.
+		//@param p_indices The index buffer of an indexed mesh, nullptr if every 3 vertex_positions form a triangle.
+		void build_triangle_BVH(const std::vector<unsigned int>* p_indices);
+
 	public:
 		std::vector<glm::vec3> vertex_positions; // Unique vertex positions for collision detection.
+		std::optional<Geometry::TriangleBVH> triangle_BVH; // Object-space triangles for exact raycasts. Only retained if requested on construction.
 		Geometry::AABB AABB;                     // Object-space AABB for broad-phase collision detection.
 		bool has_alpha;                          // If the mesh has any alpha values in its colour data.
+		std::string name;                        // Identifies the mesh to AssetManager::get_mesh. Empty if it was inserted without one.
 
 		template <typename VertexType>
 		requires Data::is_valid_mesh_vert<VertexType>
-		Mesh(const std::vector<VertexType>& vertex_data, OpenGL::PrimitiveMode primitive_mode)
+		//@param p_retain_triangles Keep a triangle_BVH of the mesh on the CPU for exact raycasts. Ignored unless primitive_mode is Triangles.
+		Mesh(const std::vector<VertexType>& vertex_data, OpenGL::PrimitiveMode primitive_mode, bool p_retain_triangles = false)
 			: VAO{}
 			, vert_buffer{{OpenGL::BufferStorageFlag::DynamicStorageBit}, vertex_data}
 			, index_buffer{}
-			, vertex_positions{}// }
-			, AABB{}            // |> TODO: these out of the MeshBuilder directly.
-			, has_alpha{false}  // }
+			, convex_hull{std::make_unique<LazyConvexHull>()}
+			, vertex_positions{}
+			, triangle_BVH{}
+			, AABB{}            // TODO: Feed AABB out of the MeshBuilder directly.
+			, has_alpha{false}
 		{
 			static_assert(has_position_member<VertexType>, "VertexType must have a position member");
 			ASSERT_THROW(!vertex_data.empty(), "Vertex data is empty");
@@ -75,17 +102,27 @@ namespace Data
 
 			VAO.attach_buffer(vert_buffer, 0, 0, sizeof(VertexType), (GLsizei)vertex_data.size());
 
+			vertex_positions.reserve(vertex_data.size());
 			for (const auto& vertex : vertex_data)
+			{
 				AABB.unite(vertex.position);
+				vertex_positions.push_back(vertex.position);
+			}
+			if (p_retain_triangles && primitive_mode == OpenGL::PrimitiveMode::Triangles)
+				build_triangle_BVH(nullptr);
+			remove_duplicate_positions();
 		}
 
 		template <typename VertexType>
 		requires Data::is_valid_mesh_vert<VertexType>
-		Mesh(std::vector<VertexType>&& vertex_data, std::vector<unsigned int> indices, OpenGL::PrimitiveMode primitive_mode)
+		//@param p_retain_triangles Keep a triangle_BVH of the mesh on the CPU for exact raycasts. Ignored unless primitive_mode is Triangles.
+		Mesh(std::vector<VertexType>&& vertex_data, std::vector<unsigned int> indices, OpenGL::PrimitiveMode primitive_mode, bool p_retain_triangles = false)
 			: VAO{}
 			, vert_buffer{{OpenGL::BufferStorageFlag::DynamicStorageBit}, vertex_data}
 			, index_buffer{OpenGL::Buffer{{OpenGL::BufferStorageFlag::DynamicStorageBit}, indices}}
-			, vertex_positions{}// TODO: Feed vertex_positions out of the MeshBuilder directly.
+			, convex_hull{std::make_unique<LazyConvexHull>()}
+			, vertex_positions{}
+			, triangle_BVH{}
 			, AABB{} // TODO: Feed AABB out of the MeshBuilder directly.
 		{
 			ASSERT_THROW(!vertex_data.empty(), "Vertex data is empty");
@@ -128,8 +165,15 @@ namespace Data
 			VAO.attach_buffer(vert_buffer, 0, 0, sizeof(VertexType), (GLsizei)vertex_data.size());
 			VAO.attach_element_buffer(index_buffer.value(), (GLsizei)indices.size());
 
+			vertex_positions.reserve(vertex_data.size());
 			for (const auto& vertex : vertex_data)
+			{
 				AABB.unite(vertex.position);
+				vertex_positions.push_back(vertex.position);
+			}
+			if (p_retain_triangles && primitive_mode == OpenGL::PrimitiveMode::Triangles)
+				build_triangle_BVH(&indices);
+			remove_duplicate_positions();
 		}
 
 		Mesh(const Mesh&)            = delete;
@@ -138,7 +182,15 @@ namespace Data
 		Mesh& operator=(Mesh&&)      = default;
 
 		const OpenGL::VAO& get_VAO() const { return VAO; }
+		// Object-space convex hull of vertex_positions for GJK/EPA support queries. Built on the first call, safe to call from multiple threads.
+		const Geometry::ConvexHull& get_convex_hull() const;
 		bool empty()                 const { return VAO.draw_count() > 0; }
+		// The bytes of the GPU buffers and the collision shapes.
+		size_t memory_size() const
+		{
+			return vert_buffer.capacity() + (index_buffer ? index_buffer->capacity() : 0) + vertex_positions.size() * sizeof(glm::vec3)
+				+ (convex_hull->built ? convex_hull->hull.memory_size() : 0) + (triangle_BVH ? triangle_BVH->memory_size() : 0);
+		}
 		void draw_UI();
 	};
 }
@@ -18,11 +18,28 @@ namespace Component
 		, m_inertia_tensor{glm::identity<glm::mat3>()}
 		, m_mass{1}
 		, m_apply_gravity{p_apply_gravity}
+		, m_continuous_collision{false}
+		, m_time_at_rest{0.f}
+		, m_asleep{false}
 	{}
 
 	void RigidBody::apply_linear_force(const glm::vec3& p_force)
 	{
 		m_force += p_force;
+		wake();
+	}
+	void RigidBody::sleep()
+	{
+		m_asleep           = true;
+		m_momentum         = {0.f, 0.f, 0.f};
+		m_velocity         = {0.f, 0.f, 0.f};
+		m_angular_momentum = {0.f, 0.f, 0.f};
+		m_angular_velocity = {0.f, 0.f, 0.f};
+	}
+	void RigidBody::wake()
+	{
+		m_asleep       = false;
+		m_time_at_rest = 0.f;
 	}
 
 	void RigidBody::draw_UI()
@@ -48,6 +65,13 @@ namespace Component
 
 			ImGui::Separator();
 			ImGui::Checkbox("Apply Gravity", &m_apply_gravity);
+			ImGui::Checkbox("Continuous collision", &m_continuous_collision);
+
+			ImGui::Separator();
+			bool asleep = m_asleep;
+			if (ImGui::Checkbox("Asleep", &asleep))
+				asleep ? sleep() : wake();
+			ImGui::Text("Time at rest (s): %.2f", m_time_at_rest);
 			ImGui::TreePop();
 
 			if (ImGui::Button("Reset"))
@@ -61,6 +85,7 @@ namespace Component
 				m_torque           = {0.f, 0.f, 0.f};
 				m_angular_momentum = {0.f, 0.f, 0.f};
 				m_angular_velocity = {0.f, 0.f, 0.f};
+				wake();
 				//m_inertia_tensor   = {glm::identity<glm::mat3>()};
 			}
 		}
@@ -77,6 +102,7 @@ namespace Component
 		Utility::write_binary(p_out, p_version, p_rigid_body.m_inertia_tensor);
 		Utility::write_binary(p_out, p_version, p_rigid_body.m_mass);
 		Utility::write_binary(p_out, p_version, p_rigid_body.m_apply_gravity);
+		// m_continuous_collision and the sleep state are not saved to keep the format readable by older scenes, bodies load awake with discrete collision.
 	}
 	RigidBody RigidBody::deserialise(std::istream& p_in, uint16_t p_version)
 	{
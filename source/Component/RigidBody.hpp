@@ -29,11 +29,21 @@ namespace Component
 
 		float m_mass; // Inertial mass measuring the body's resistance to acceleration when a force is applied (kg)
 		bool m_apply_gravity;
+		bool m_continuous_collision; // Sweep the Collider along the body's motion each tick so fast bodies cannot pass through thin Colliders.
 		// Position and orientation are stored in Component::Transform.
 
+		// Sleeping
+		// -----------------------------------------------------------------------------
+		float m_time_at_rest; // Seconds the body has continuously been below the PhysicsSystem sleep velocity thresholds.
+		bool m_asleep;        // A sleeping body is skipped by PhysicsSystem::integrate and the CollisionSystem broad phase until woken.
+
 		RigidBody(bool p_apply_gravity = true) noexcept;
-		// Apply a linear p_force (kg m/s²) on the body. Force is applied on a PhysicsSystem::update tick.
+		// Apply a linear p_force (kg m/s²) on the body. Force is applied on a PhysicsSystem::update tick. Wakes the body if asleep.
 		void apply_linear_force(const glm::vec3& p_force);
+		// Put the body to sleep, zeroing its motion so it remains at rest when woken.
+		void sleep();
+		// Wake the body and restart its time at rest.
+		void wake();
 		void draw_UI();
 
 		static void serialise(std::ostream& p_out, uint16_t p_version, const RigidBody& p_rigid_body);
@@ -4,11 +4,28 @@
 #include "Utility/MeshBuilder.hpp"
 #include "Utility/PerlinNoise.hpp"
 #include "Utility/Stopwatch.hpp"
+#include "Utility/ThreadPool.hpp"
+#include "Utility/Utility.hpp"
 
 #include "imgui.h"
 
+#include <algorithm>
+#include <array>
+
+// Rows of height samples computed per parallel_for index. Small enough to balance the load across threads for the smallest terrains.
+static constexpr size_t Band_rows = 16;
+
+// Shared by every terrain. Generation only happens on the main thread so parallel_for is never called concurrently.
+static Utility::ThreadPool& get_thread_pool()
+{
+	static Utility::ThreadPool thread_pool;
+	return thread_pool;
+}
+
 Component::Terrain::Terrain(const glm::vec3& p_position, int p_size_x, int p_size_z, float amplitude) noexcept
-	: m_position{p_position}
+	: m_noise_layers{}
+	, m_chunk_indices{}
+	, m_position{p_position}
 	, m_size_x{p_size_x}
 	, m_size_z{p_size_z}
 	, m_scale_factor{0.03f}
@@ -23,145 +40,278 @@ Component::Terrain::Terrain(const glm::vec3& p_position, int p_size_x, int p_siz
 	, m_sand_tex{}
 	, m_snow_tex{}
 	, m_seed{Utility::get_random_number<unsigned int>()}
-	, m_mesh{generate_mesh(m_seed)}
-{}
-Component::Terrain::Terrain(const Terrain& p_other) noexcept
-	: m_position{p_other.m_position}
-	, m_size_x{p_other.m_size_x}
-	, m_size_z{p_other.m_size_z}
-	, m_scale_factor{p_other.m_scale_factor}
-	, m_amplitude{p_other.m_amplitude}
-	, m_lacunarity{p_other.m_lacunarity}
-	, m_persistence{p_other.m_persistence}
-	, m_octaves{p_other.m_octaves}
-	, m_grass_tex{p_other.m_grass_tex}
-	, m_gravel_tex{p_other.m_gravel_tex}
-	, m_ground_tex{p_other.m_ground_tex}
-	, m_rock_tex{p_other.m_rock_tex}
-	, m_sand_tex{p_other.m_sand_tex}
-	, m_snow_tex{p_other.m_snow_tex}
-	, m_seed{p_other.m_seed}
-	, m_mesh{generate_mesh(m_seed)} // TODO: Implement a Data::Mesh copy.
-{}
-Component::Terrain& Component::Terrain::operator=(const Terrain& p_other) noexcept
+	, m_lod_distance{64.f}
+	, m_heightfield{}
+	, m_chunks{}
+	, m_chunk_meshes{}
 {
-	m_position     = p_other.m_position;
-	m_size_x       = p_other.m_size_x;
-	m_size_z       = p_other.m_size_z;
-	m_scale_factor = p_other.m_scale_factor;
-	m_amplitude    = p_other.m_amplitude;
-	m_lacunarity   = p_other.m_lacunarity;
-	m_persistence  = p_other.m_persistence;
-	m_octaves      = p_other.m_octaves;
-	m_grass_tex    = p_other.m_grass_tex;
-	m_gravel_tex   = p_other.m_gravel_tex;
-	m_ground_tex   = p_other.m_ground_tex;
-	m_rock_tex     = p_other.m_rock_tex;
-	m_sand_tex     = p_other.m_sand_tex;
-	m_snow_tex     = p_other.m_snow_tex;
-	m_seed         = p_other.m_seed;
-	m_mesh         = generate_mesh(m_seed); // TODO: Implement a Data::Mesh copy.
-	return *this;
+	regenerate();
 }
 
-float Component::Terrain::compute_height(float p_x, float p_z, const siv::PerlinNoise& perlin)
+void Component::Terrain::compute_noise(const siv::PerlinNoise& p_perlin, size_t p_octave, size_t p_first_row, size_t p_last_row, size_t p_first_column)
 {
-	float accumulate       = 0.f;
 	float octave_frequency = 1.f;
-	float octave_amplitude = 1.f;
-	float max_value        = 0.f;
+	for (size_t i = 0; i < p_octave; i++)
+		octave_frequency *= m_lacunarity;
 
-	for (int i = 0; i < m_octaves; i++)
+	auto& layers = *m_noise_layers;
+	auto& noise  = layers.octaves[p_octave];
+	// Rounded up to a whole number of batches of four so no sample takes the scalar path noise2DBatch uses for the remainder.
+	const size_t count = (layers.columns - p_first_column + 3) / 4 * 4;
+	std::vector<double> x_coords(count);
+	std::vector<double> z_coords(count);
+	std::vector<double> row_noise(count);
+
+	for (size_t z = p_first_row; z < p_last_row; z++)
 	{
-		accumulate       += static_cast<float>(perlin.noise2D(p_x * m_scale_factor * octave_frequency, p_z * m_scale_factor * octave_frequency)) * octave_amplitude;
-		max_value        += octave_amplitude;
-		octave_amplitude *= m_persistence;
-		octave_frequency *= m_lacunarity;
-	}
+		for (size_t i = 0; i < count; i++)
+		{
+			x_coords[i] = static_cast<float>(p_first_column + i) * m_scale_factor * octave_frequency;
+			z_coords[i] = static_cast<float>(z) * m_scale_factor * octave_frequency;
+		}
+		p_perlin.noise2DBatch(x_coords.data(), z_coords.data(), row_noise.data(), count);
 
-	return accumulate / max_value * m_amplitude;
+		for (size_t x = p_first_column; x < layers.columns; x++)
+			noise[z * layers.columns + x] = static_cast<float>(row_noise[x - p_first_column]);
+	}
 }
 
-Data::Mesh Component::Terrain::generate_mesh(unsigned int p_seed) noexcept
+void Component::Terrain::regenerate() noexcept
 {
-	const siv::PerlinNoise perlin{p_seed};
-	std::vector<Data::Vertex> unique_verts;
-	std::vector<unsigned int> indices;
+	if (!m_noise_layers)
+		m_noise_layers = std::make_shared<NoiseLayers>();
+	else if (m_noise_layers.use_count() > 1)
+		m_noise_layers = std::make_shared<NoiseLayers>(*m_noise_layers); // Leave the shared layers to the copies still using them.
+	auto& layers = *m_noise_layers;
+
+	const size_t rows        = m_size_z + 1;
+	const size_t columns     = m_size_x + 1;
+	const size_t octaves     = static_cast<size_t>(m_octaves);
+	const size_t old_rows    = layers.rows;
+	const size_t old_columns = layers.columns;
+
+	// The first octave samples at frequency 1 so only depends on the seed and scale factor.
+	if (layers.seed != m_seed || layers.scale_factor != m_scale_factor)
+		layers.octaves.clear();
+	else if (layers.lacunarity != m_lacunarity)
+		layers.octaves.resize(std::min<size_t>(layers.octaves.size(), 1));
+	const bool heights_changed = layers.octaves.size() != octaves || layers.persistence != m_persistence || layers.amplitude != m_amplitude;
+	layers.octaves.resize(std::min(layers.octaves.size(), octaves));
+
+	layers.seed         = m_seed;
+	layers.scale_factor = m_scale_factor;
+	layers.lacunarity   = m_lacunarity;
+	layers.persistence  = m_persistence;
+	layers.amplitude    = m_amplitude;
+	layers.rows         = rows;
+	layers.columns      = columns;
 
-	for (int z = 0; z <= m_size_z; ++z)
+	// The noise left to compute as (octave, first row, last row, first column), split into bands of rows to spread across threads.
+	struct NoiseBand
 	{
-		for (int x = 0; x <= m_size_x; ++x)
+		size_t octave;
+		size_t first_row;
+		size_t last_row;
+		size_t first_column;
+	};
+	std::vector<NoiseBand> bands;
+	auto add_bands = [&bands](size_t p_octave, size_t p_first_row, size_t p_last_row, size_t p_first_column)
+	{
+		for (size_t row = p_first_row; row < p_last_row; row += Band_rows)
+			bands.push_back({p_octave, row, std::min(p_last_row, row + Band_rows), p_first_column});
+	};
+
+	if (rows != old_rows || columns != old_columns)
+	{// Keep the samples the old and new sizes overlap, only the added rows and columns need sampling.
+		const size_t kept_rows    = std::min(rows, old_rows);
+		const size_t kept_columns = std::min(columns, old_columns);
+		for (size_t octave = 0; octave < layers.octaves.size(); octave++)
 		{
-			Data::Vertex vert;
-			auto y = compute_height((float)x, (float)z, perlin);
-			vert.position = {x, y, z};
-			vert.normal   = {0.f, 0.f, 0.f}; // Calculate normals later
-			unique_verts.push_back(vert);
+			std::vector<float> resized(rows * columns);
+			for (size_t z = 0; z < kept_rows; z++)
+				std::copy_n(layers.octaves[octave].begin() + z * old_columns, kept_columns, resized.begin() + z * columns);
+			layers.octaves[octave] = std::move(resized);
+
+			if (columns > old_columns)
+				add_bands(octave, 0, kept_rows, old_columns);
+			add_bands(octave, kept_rows, rows, 0);
 		}
 	}
+	for (size_t octave = layers.octaves.size(); octave < octaves; octave++)
+	{
+		layers.octaves.emplace_back(rows * columns);
+		add_bands(octave, 0, rows, 0);
+	}
+
+	const siv::PerlinNoise perlin{m_seed};
+	get_thread_pool().parallel_for(bands.size(), [&](size_t p_band)
+	{
+		const auto& band = bands[p_band];
+		compute_noise(perlin, band.octave, band.first_row, band.last_row, band.first_column);
+	});
 
-	// Generate indices for each quad (two triangles per quad)
-	for (int z = 0; z < m_size_z; ++z)
+	std::vector<float> heights(rows * columns);
+	get_thread_pool().parallel_for((rows + Band_rows - 1) / Band_rows, [&](size_t p_band)
 	{
-		for (int x = 0; x < m_size_x; ++x)
+		const size_t first = p_band * Band_rows * columns;
+		const size_t last  = std::min(rows, (p_band + 1) * Band_rows) * columns;
+		float octave_amplitude = 1.f;
+		float max_value        = 0.f;
+		for (const auto& noise : layers.octaves)
 		{
-			// Get the indices for the four corners of the current quad
-			unsigned int top_left     = z * (m_size_x + 1) + x;
-			unsigned int top_right    = top_left + 1;
-			unsigned int bottom_left  = (z + 1) * (m_size_x + 1) + x;
-			unsigned int bottom_right = bottom_left + 1;
-
-			// First triangle (top-left, bottom-left, top-right)
-			indices.push_back(top_left);
-			indices.push_back(bottom_left);
-			indices.push_back(top_right);
-			// Second triangle (top-right, bottom-left, bottom-right)
-			indices.push_back(top_right);
-			indices.push_back(bottom_left);
-			indices.push_back(bottom_right);
-
-			// Calculate normals for the first triangle then accumulate the normal to each of the triangle's vertices
-			glm::vec3 v0     = unique_verts[top_left].position;
-			glm::vec3 v1     = unique_verts[bottom_left].position;
-			glm::vec3 v2     = unique_verts[top_right].position;
-			glm::vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
-			unique_verts[top_left].normal    += normal;
-			unique_verts[bottom_left].normal += normal;
-			unique_verts[top_right].normal   += normal;
-
-			// Calculate normals for the second triangle
-			// Accumulate the normal to each of the triangle's vertices
-			v0     = unique_verts[top_right].position;
-			v1     = unique_verts[bottom_left].position;
-			v2     = unique_verts[bottom_right].position;
-			normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
-			unique_verts[top_right].normal    += normal;
-			unique_verts[bottom_left].normal  += normal;
-			unique_verts[bottom_right].normal += normal;
-
-			// Calculate UV coordinates based on vertex position within the terrain grid.
-			// UV coordinates range from 0.0 to size_x or size_z
-			float u = static_cast<float>(x);
-			float v = static_cast<float>(z);
-			unique_verts[top_left].uv     = {u, v + 1.0f};
-			unique_verts[bottom_left].uv  = {u, v};
-			unique_verts[top_right].uv    = {u + 1.0f, v + 1.0f};
-			unique_verts[bottom_right].uv = {u + 1.0f, v};
+			for (size_t i = first; i < last; i++)
+				heights[i] += noise[i] * octave_amplitude;
+
+			max_value        += octave_amplitude;
+			octave_amplitude *= m_persistence;
+		}
+		for (size_t i = first; i < last; i++)
+			heights[i] = heights[i] / max_value * m_amplitude;
+	});
+
+	const size_t old_cells_x = m_heightfield.cells_x();
+	const auto old_bounds    = m_heightfield.get_AABB();
+	const size_t old_cells_z = m_heightfield.cells_z();
+	auto old_chunks          = std::move(m_chunks);
+	auto old_chunk_meshes    = std::move(m_chunk_meshes);
+	m_heightfield  = Geometry::Heightfield(m_size_x, m_size_z, 1.f, std::move(heights));
+	m_chunks       = Geometry::HeightfieldChunks(m_heightfield);
+	m_chunk_meshes = std::vector<ChunkMesh>(m_chunks.chunks().size());
+
+	// Chunk meshes quantise heights over the range of the whole heightfield so are only valid while it is unchanged.
+	const bool height_range_changed = old_bounds.m_min.y != m_heightfield.get_AABB().m_min.y || old_bounds.m_max.y != m_heightfield.get_AABB().m_max.y;
+	if (!heights_changed && !height_range_changed && !old_chunks.empty())
+	{// After a size change keep the meshes of chunks whose samples and the samples around them, which their normals depend on, are unchanged.
+		for (size_t i = 0; i < m_chunks.chunks().size(); i++)
+		{
+			const auto& chunk    = m_chunks.chunks()[i];
+			const size_t chunk_x = chunk.first_x / Geometry::HeightfieldChunks::Chunk_cells;
+			const size_t chunk_z = chunk.first_z / Geometry::HeightfieldChunks::Chunk_cells;
+			const size_t last_x  = chunk.first_x + chunk.cells_x;
+			const size_t last_z  = chunk.first_z + chunk.cells_z;
+			if (chunk_x >= old_chunks.chunks_x() || chunk_z >= old_chunks.chunks_z() || last_x >= std::min(old_cells_x, m_heightfield.cells_x()) || last_z >= std::min(old_cells_z, m_heightfield.cells_z()))
+				continue;
+
+			const size_t old_index = chunk_z * old_chunks.chunks_x() + chunk_x;
+			const auto& old_chunk  = old_chunks.chunks()[old_index];
+			if (old_chunk.cells_x == chunk.cells_x && old_chunk.cells_z == chunk.cells_z)
+				m_chunk_meshes[i] = std::move(old_chunk_meshes[old_index]);
 		}
 	}
+}
 
-	// Normalize the vertex normals
-	for (auto& vert : unique_verts)
-		vert.normal = glm::normalize(vert.normal);
+void Component::Terrain::update_chunks(const glm::vec3& p_view_position)
+{
+	m_chunks.update(p_view_position - m_position, m_lod_distance);
+}
+
+std::vector<Data::TerrainVertex> Component::Terrain::make_chunk_vertices(size_t p_chunk) const
+{
+	const auto& chunk        = m_chunks.chunks()[p_chunk];
+	const size_t step        = chunk.step();
+	const float min_height   = m_heightfield.get_AABB().m_min.y;
+	const float height_range = m_heightfield.get_AABB().m_max.y - min_height;
+	std::vector<Data::TerrainVertex> vertices;
+	vertices.reserve(chunk.vertices_x() * chunk.vertices_z());
+
+	// Normals come from the heightfield samples rather than the chunk's triangles so both sides of a seam shade alike.
+	// Positions on the grid are implied by the vertex index, phong_terrain.vert places them from the chunk's grid uniforms.
+	// Heights are quantised over the range of the whole heightfield so chunks sharing a sample decode it to the same height.
+	for (size_t j = 0; j < chunk.vertices_z(); ++j)
+	{
+		for (size_t i = 0; i < chunk.vertices_x(); ++i)
+		{
+			const size_t x = chunk.first_x + i * step;
+			const size_t z = chunk.first_z + j * step;
+			vertices.emplace_back(m_heightfield.get_sample(x, z), min_height, height_range, m_heightfield.get_sample_normal(x, z));
+		}
+	}
+	return vertices;
+}
+bool Component::Terrain::is_chunk_mesh_stale(size_t p_chunk) const
+{
+	const auto& chunk      = m_chunks.chunks()[p_chunk];
+	const auto& chunk_mesh = m_chunk_meshes[p_chunk];
+	return !chunk_mesh.mesh || chunk_mesh.lod != chunk.lod || chunk_mesh.stitch_mask != chunk.stitch_mask;
+}
+
+const Data::TerrainMesh& Component::Terrain::get_chunk_mesh(size_t p_chunk)
+{
+	if (is_chunk_mesh_stale(p_chunk))
+		build_chunk_meshes(std::span<const size_t>(&p_chunk, 1));
 
-	return Data::Mesh{std::move(unique_verts), std::move(indices), OpenGL::PrimitiveMode::Triangles};
+	return *m_chunk_meshes[p_chunk].mesh;
+}
+void Component::Terrain::build_chunk_meshes(std::span<const size_t> p_chunks)
+{
+	std::vector<size_t> stale_chunks;
+	for (auto chunk : p_chunks)
+		if (is_chunk_mesh_stale(chunk))
+			stale_chunks.push_back(chunk);
+
+	// Chunks missing the vertex buffer of their LOD and one chunk of each triangulation without an index buffer.
+	std::vector<size_t> vertex_chunks;
+	std::vector<size_t> index_chunks;
+	for (auto chunk_index : stale_chunks)
+	{
+		const auto& chunk = m_chunks.chunks()[chunk_index];
+		if (!m_chunk_meshes[chunk_index].vertex_buffers[chunk.lod])
+			vertex_chunks.push_back(chunk_index);
+
+		const auto key = ChunkIndicesKey(chunk);
+		if (!m_chunk_indices.contains(key) && std::none_of(index_chunks.begin(), index_chunks.end(), [&](size_t p_other) { return ChunkIndicesKey(m_chunks.chunks()[p_other]) == key; }))
+			index_chunks.push_back(chunk_index);
+	}
+
+	std::vector<std::vector<Data::TerrainVertex>> vertices(vertex_chunks.size());
+	std::vector<std::vector<unsigned int>> indices(index_chunks.size());
+	get_thread_pool().parallel_for(vertex_chunks.size() + index_chunks.size(), [&](size_t p_index)
+	{
+		if (p_index < vertex_chunks.size())
+			vertices[p_index] = make_chunk_vertices(vertex_chunks[p_index]);
+		else
+			indices[p_index - vertex_chunks.size()] = m_chunks.get_indices(m_chunks.chunks()[index_chunks[p_index - vertex_chunks.size()]]);
+	});
+
+	const auto storage = OpenGL::BufferStorageBitfield{OpenGL::BufferStorageFlag::DynamicStorageBit};
+	for (size_t i = 0; i < vertex_chunks.size(); i++)
+		m_chunk_meshes[vertex_chunks[i]].vertex_buffers[m_chunks.chunks()[vertex_chunks[i]].lod] = std::make_shared<OpenGL::Buffer>(storage, vertices[i]);
+	for (size_t i = 0; i < index_chunks.size(); i++)
+		m_chunk_indices.emplace(ChunkIndicesKey(m_chunks.chunks()[index_chunks[i]]), ChunkIndices{std::make_shared<OpenGL::Buffer>(storage, indices[i]), indices[i].size()});
+
+	// Every buffer now exists, the meshes only create a VAO over them.
+	const auto& bounds = m_heightfield.get_AABB();
+	for (auto chunk_index : stale_chunks)
+	{
+		const auto& chunk         = m_chunks.chunks()[chunk_index];
+		const auto& chunk_indices = m_chunk_indices.at(ChunkIndicesKey(chunk));
+		auto& chunk_mesh          = m_chunk_meshes[chunk_index];
+		chunk_mesh.mesh        = std::make_shared<const Data::TerrainMesh>(chunk_mesh.vertex_buffers[chunk.lod], chunk.vertices_x() * chunk.vertices_z(), chunk_indices.buffer, chunk_indices.count,
+			glm::vec2(chunk.first_x, chunk.first_z), static_cast<float>(chunk.step()), chunk.vertices_x(), bounds.m_min.y, bounds.m_max.y - bounds.m_min.y);
+		chunk_mesh.lod         = chunk.lod;
+		chunk_mesh.stitch_mask = chunk.stitch_mask;
+	}
 }
 
 void Component::Terrain::draw_UI(System::AssetManager& p_asset_manager)
 {
 	if (ImGui::TreeNode("Terrain"))
 	{
-		m_mesh.draw_UI();
+		{
+			std::array<size_t, Geometry::HeightfieldChunks::Lod_count> chunks_per_LOD = {};
+			size_t vertex_count = 0;
+			for (const auto& chunk : m_chunks.chunks())
+			{
+				chunks_per_LOD[chunk.lod]++;
+				vertex_count += chunk.vertices_x() * chunk.vertices_z();
+			}
+			ImGui::Text("Chunks: %zu x %zu", m_chunks.chunks_x(), m_chunks.chunks_z());
+			for (size_t lod = 0; lod < chunks_per_LOD.size(); lod++)
+				ImGui::Text("LOD %zu: %zu chunks", lod, chunks_per_LOD[lod]);
+			auto formatted_verts = Utility::number_with_seperator(vertex_count);
+			ImGui::Text_Manual("Vertices: %s", formatted_verts.c_str());
+			ImGui::Slider("LOD distance", m_lod_distance, 1.f, 500.f, "%.1fm");
+		}
 
 		ImGui::SeparatorText("Textures");
 		p_asset_manager.draw_texture_selector("Grass texture", m_grass_tex);
@@ -174,7 +324,7 @@ void Component::Terrain::draw_UI(System::AssetManager& p_asset_manager)
 		ImGui::SeparatorText("Generation settings");
 		static bool m_regen_on_changes = true;
 		bool changed = false;
-		changed |= ImGui::Slider("Position", m_position, -100.f, 100.f, "%.3fm");
+		ImGui::Slider("Position", m_position, -100.f, 100.f, "%.3fm"); // Heights are relative to the position so moving needs no regeneration.
 		changed |= ImGui::Slider("Size X", m_size_x, 1, 1000, "%dm");
 		changed |= ImGui::Slider("Size Z", m_size_z, 1, 1000, "%dm");
 		changed |= ImGui::Slider("Scale factor", m_scale_factor, 0.01f , 0.15f);
@@ -191,10 +341,13 @@ void Component::Terrain::draw_UI(System::AssetManager& p_asset_manager)
 		}
 
 		static auto most_recent_time_taken_s = std::optional<float>{};
-		if (ImGui::Button("Re-generate terrain") || (changed && m_regen_on_changes))
+		const bool regenerate_all = ImGui::Button("Re-generate terrain");
+		if (regenerate_all || (changed && m_regen_on_changes))
 		{
 			Utility::Stopwatch stopwatch;
-			m_mesh = generate_mesh(m_seed);
+			if (regenerate_all)
+				m_noise_layers.reset();
+			regenerate();
 			most_recent_time_taken_s = stopwatch.getTime<std::ratio<1, 1>, float>();
 		}
 		if (most_recent_time_taken_s)
@@ -1,21 +1,79 @@
 #pragma once
 
 #include "Component/Texture.hpp"
-#include "Component/Mesh.hpp"
+#include "Component/TerrainMesh.hpp"
+
+#include "Geometry/Heightfield.hpp"
+#include "Geometry/HeightfieldChunks.hpp"
 
 #include "Utility/PerlinNoise.hpp"
 
+#include <array>
+#include <compare>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
 
 
 namespace System
 {
 	class AssetManager;
 }
+namespace Test
+{
+	class TerrainTester;
+}
 namespace Component
 {
 	class Terrain
 	{
-		Data::Mesh generate_mesh(unsigned int p_seed) noexcept;
+		friend class Test::TerrainTester; // Checks copies share m_noise_layers until either regenerates.
+
+		// The noise m_heightfield was combined from, kept so regenerate only recomputes what a parameter change invalidates.
+		// Shared by copies of the terrain, a terrain regenerating from a shared cache copies it first.
+		struct NoiseLayers
+		{
+			unsigned int seed  = 0;
+			float scale_factor = 0.f;
+			float lacunarity   = 0.f;
+			float persistence  = 0.f;
+			float amplitude    = 0.f;
+			size_t columns     = 0;
+			size_t rows        = 0;
+			std::vector<std::vector<float>> octaves; // Noise of each octave per sample, row-major with X varying fastest.
+		};
+		std::shared_ptr<NoiseLayers> m_noise_layers;
+
+		// Fill samples [p_first_column, columns) of rows [p_first_row, p_last_row) of octave p_octave in m_noise_layers.
+		// Noise is evaluated a row at a time with siv::PerlinNoise::noise2DBatch, padded to whole batches so every sample takes the same path
+		// and is identical however the rows and columns were split.
+		void compute_noise(const siv::PerlinNoise& p_perlin, size_t p_octave, size_t p_first_row, size_t p_last_row, size_t p_first_column);
+
+		// The vertices of chunk p_chunk at its current LOD. Only reads the terrain so is safe to call from several threads.
+		std::vector<Data::TerrainVertex> make_chunk_vertices(size_t p_chunk) const;
+		bool is_chunk_mesh_stale(size_t p_chunk) const;
+
+		// Chunks with the same cell counts, LOD and stitch mask are triangulated alike so share one index buffer.
+		struct ChunkIndicesKey
+		{
+			size_t cells_x;
+			size_t cells_z;
+			size_t lod;
+			uint8_t stitch_mask;
+
+			explicit ChunkIndicesKey(const Geometry::HeightfieldChunks::Chunk& p_chunk) noexcept
+				: cells_x{p_chunk.cells_x}, cells_z{p_chunk.cells_z}, lod{p_chunk.lod}, stitch_mask{p_chunk.stitch_mask}
+			{}
+			auto operator<=>(const ChunkIndicesKey&) const = default;
+		};
+		struct ChunkIndices
+		{
+			std::shared_ptr<OpenGL::Buffer> buffer;
+			size_t count;
+		};
+		// Index buffers built so far. Indices don't depend on the heights so are kept across regenerate.
+		std::map<ChunkIndicesKey, ChunkIndices> m_chunk_indices;
 
 	public:
 		constexpr static size_t Persistent_ID = 6;
@@ -36,18 +94,44 @@ namespace Component
 		TextureRef m_sand_tex;
 		TextureRef m_snow_tex;
 
-		unsigned int m_seed; // Seed used to generate m_mesh.
-		Data::Mesh m_mesh;
+		unsigned int m_seed; // Seed used to generate m_heightfield.
+		float m_lod_distance; // Distance from the view chunks stay at full detail, each coarser LOD covers twice the distance of the previous.
+		Geometry::Heightfield m_heightfield; // Height samples relative to m_position for rendering, ray and contact queries. Set by regenerate.
+		Geometry::HeightfieldChunks m_chunks; // Chunks of m_heightfield each meshed at the LOD chosen by update_chunks.
+
+		// The mesh of a chunk at the LOD and stitch mask it was built for. Rebuilt by get_chunk_mesh when the chunk's LOD or stitch mask changes.
+		// The vertex buffer of each LOD is kept once built and index buffers are shared between chunks, so a rebuild only uploads the vertices
+		// of a LOD the chunk wasn't meshed at before. Shared by copies of the terrain until either rebuilds it.
+		struct ChunkMesh
+		{
+			std::shared_ptr<const Data::TerrainMesh> mesh;
+			size_t lod;
+			uint8_t stitch_mask;
+			std::array<std::shared_ptr<OpenGL::Buffer>, Geometry::HeightfieldChunks::Lod_count> vertex_buffers; // Per LOD, empty until meshed at it.
+		};
+		std::vector<ChunkMesh> m_chunk_meshes; // Parallel to m_chunks.chunks().
 
 		Terrain(const glm::vec3& p_position, int p_size_x, int p_size_z, float amplitude) noexcept;
-		// Copy constructor has to be implemented because Data::Mesh GL members are not copyable.
-		Terrain(const Terrain& p_other) noexcept;
-		// Copy assignment operator has to be implemented because Data::Mesh GL members are not copyable.
-		Terrain& operator=(const Terrain& p_other) noexcept;
-		Terrain(Terrain&& p_other) noexcept            = default;
-		Terrain& operator=(Terrain&& p_other) noexcept = default;
-
-		float compute_height(float p_x, float p_z, const siv::PerlinNoise& perlin);
+		// Copies share the noise layers and chunk meshes of p_other rather than generating their own.
+		Terrain(const Terrain& p_other) noexcept            = default;
+		Terrain& operator=(const Terrain& p_other) noexcept = default;
+		Terrain(Terrain&& p_other) noexcept                 = default;
+		Terrain& operator=(Terrain&& p_other) noexcept      = default;
+
+		// Bring m_heightfield and its chunks up to date with the generation settings. Chunk meshes are built on demand by get_chunk_mesh.
+		// Only the noise invalidated since the last call is computed: amplitude and persistence changes recombine the cached octaves,
+		// octave count changes add or drop octaves, lacunarity changes keep the first octave and size changes only sample the added rows and
+		// columns. Noise is computed in bands of rows across a thread pool and the result is identical for a given seed whichever path produced it.
+		void regenerate() noexcept;
+		// Choose the LOD of every chunk for a view at world space p_view_position.
+		void update_chunks(const glm::vec3& p_view_position);
+		// The mesh of chunk p_chunk at the LOD chosen by the last update_chunks, building it if the LOD or stitch mask changed since it was last built.
+		// Vertex positions are relative to m_position.
+		const Data::TerrainMesh& get_chunk_mesh(size_t p_chunk);
+		// Rebuild the meshes of p_chunks whose LOD or stitch mask changed since they were last built.
+		// Vertices of LODs not built before and indices of new triangulations are generated across a thread pool,
+		// the buffers and meshes are then created on the calling thread which must own the GL context.
+		void build_chunk_meshes(std::span<const size_t> p_chunks);
 		void draw_UI(System::AssetManager& p_asset_manager);
 	};
 } // namespace Component
\ No newline at end of file
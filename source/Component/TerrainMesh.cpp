@@ -0,0 +1,35 @@
+#include "TerrainMesh.hpp"
+
+#include "Utility/Logger.hpp"
+
+namespace Data
+{
+	TerrainMesh::TerrainMesh(const std::vector<TerrainVertex>& p_vertices, std::shared_ptr<OpenGL::Buffer> p_index_buffer, size_t p_index_count,
+	                         const glm::vec2& p_first_sample, float p_step, size_t p_columns, float p_min_height, float p_height_range)
+		: TerrainMesh(std::make_shared<OpenGL::Buffer>(OpenGL::BufferStorageBitfield{OpenGL::BufferStorageFlag::DynamicStorageBit}, p_vertices), p_vertices.size(),
+		              std::move(p_index_buffer), p_index_count, p_first_sample, p_step, p_columns, p_min_height, p_height_range)
+	{}
+	TerrainMesh::TerrainMesh(std::shared_ptr<OpenGL::Buffer> p_vertex_buffer, size_t p_vertex_count, std::shared_ptr<OpenGL::Buffer> p_index_buffer, size_t p_index_count,
+	                         const glm::vec2& p_first_sample, float p_step, size_t p_columns, float p_min_height, float p_height_range)
+		: VAO{}
+		, vert_buffer{std::move(p_vertex_buffer)}
+		, index_buffer{std::move(p_index_buffer)}
+		, first_sample{p_first_sample}
+		, step{p_step}
+		, columns{p_columns}
+		, min_height{p_min_height}
+		, height_range{p_height_range}
+	{
+		ASSERT_THROW(vert_buffer && p_vertex_count > 0, "Vertex data is empty");
+		ASSERT_THROW(index_buffer && p_index_count > 0, "Index data is empty");
+		ASSERT_THROW(p_columns > 0 && p_vertex_count % p_columns == 0, "Vertices do not fill whole rows");
+
+		constexpr GLint vertex_buffer_binding_point = 0;
+		VAO.set_vertex_attrib_pointers(OpenGL::PrimitiveMode::Triangles, {
+			{0, 1, OpenGL::BufferDataType::UnsignedShort, offsetof(TerrainVertex, height), vertex_buffer_binding_point, true},
+			{1, 2, OpenGL::BufferDataType::Byte,          offsetof(TerrainVertex, normal), vertex_buffer_binding_point, true}
+		});
+		VAO.attach_buffer(*vert_buffer, 0, vertex_buffer_binding_point, sizeof(TerrainVertex), (GLsizei)p_vertex_count);
+		VAO.attach_element_buffer(*index_buffer, (GLsizei)p_index_count);
+	}
+} // namespace Data
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Data/Vertex.hpp"
+#include "OpenGL/Types.hpp"
+
+#include "glm/vec2.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace Data
+{
+	// The GPU buffers of a terrain chunk of TerrainVertex, drawn by phong_terrain with the chunk_grid and chunk_height uniforms set from it.
+	// Vertices are row-major with X varying fastest, vertex (i, j) is at grid position first_sample + (i, j) * step.
+	class TerrainMesh
+	{
+		OpenGL::VAO VAO;
+		std::shared_ptr<OpenGL::Buffer> vert_buffer;  // Meshes of the same chunk at the same LOD can share one vertex buffer.
+		std::shared_ptr<OpenGL::Buffer> index_buffer; // Chunks with the same triangulation can share one index buffer.
+
+	public:
+		glm::vec2 first_sample; // Grid position of vertex (0, 0).
+		float step;             // Cells between neighbouring vertices.
+		size_t columns;         // Vertices per row.
+		float min_height;       // Height of a quantised height of 0.
+		float height_range;     // Height between a quantised height of 0 and 65535.
+
+		//@param p_index_buffer Triangle indices into p_vertices, p_index_count of them.
+		TerrainMesh(const std::vector<TerrainVertex>& p_vertices, std::shared_ptr<OpenGL::Buffer> p_index_buffer, size_t p_index_count,
+		            const glm::vec2& p_first_sample, float p_step, size_t p_columns, float p_min_height, float p_height_range);
+		// Construct a mesh over existing buffers, only the VAO is created.
+		//@param p_vertex_buffer Holds p_vertex_count TerrainVertex.
+		//@param p_index_buffer Triangle indices into p_vertex_buffer, p_index_count of them.
+		TerrainMesh(std::shared_ptr<OpenGL::Buffer> p_vertex_buffer, size_t p_vertex_count, std::shared_ptr<OpenGL::Buffer> p_index_buffer, size_t p_index_count,
+		            const glm::vec2& p_first_sample, float p_step, size_t p_columns, float p_min_height, float p_height_range);
+
+		const OpenGL::VAO& get_VAO() const { return VAO; }
+		size_t vertex_bytes()        const { return vert_buffer->used_capacity(); }
+	};
+} // namespace Data
\ No newline at end of file
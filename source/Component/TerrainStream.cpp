@@ -0,0 +1,419 @@
+#include "TerrainStream.hpp"
+
+#include "System/AssetManager.hpp"
+#include "Utility/PerlinNoise.hpp"
+#include "Utility/Utility.hpp"
+
+#include "glm/glm.hpp"
+#include "imgui.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Leave threads free for the render and physics loops, generation only has to keep ahead of the view.
+static size_t get_worker_count()
+{
+	return std::max<size_t>(1, std::thread::hardware_concurrency() / 2);
+}
+
+// Indices of a chunk of p_cells * p_cells cells, split along the diagonal from (i + 1, j) to (i, j + 1) matching Geometry::Heightfield.
+static std::vector<unsigned int> make_chunk_indices(size_t p_cells)
+{
+	const size_t vertices_x = p_cells + 1;
+	std::vector<unsigned int> indices;
+	indices.reserve(p_cells * p_cells * 6);
+	for (size_t j = 0; j < p_cells; j++)
+	{
+		for (size_t i = 0; i < p_cells; i++)
+		{
+			const auto index = [vertices_x](size_t p_i, size_t p_j) { return static_cast<unsigned int>(p_j * vertices_x + p_i); };
+			indices.insert(indices.end(), {index(i, j), index(i, j + 1), index(i + 1, j)});
+			indices.insert(indices.end(), {index(i + 1, j), index(i, j + 1), index(i + 1, j + 1)});
+		}
+	}
+	return indices;
+}
+
+// Distance in the XZ plane from p_point to the square of cells chunk p_coord covers.
+static float distance_to_chunk(const glm::vec2& p_point, int p_x, int p_z, int p_chunk_cells)
+{
+	const auto min = glm::vec2(p_x, p_z) * static_cast<float>(p_chunk_cells);
+	const auto max = min + static_cast<float>(p_chunk_cells);
+	return glm::length(glm::max(glm::max(min - p_point, p_point - max), glm::vec2(0.f)));
+}
+
+Component::TerrainStream::Generator::Generator(size_t p_worker_count)
+	: mutex{}
+	, work_available{}
+	, m_queues{}
+	, m_next_queue{0}
+	, m_workers{}
+	, m_stopping{false}
+{
+	m_workers.reserve(p_worker_count);
+	for (size_t i = 0; i < p_worker_count; i++)
+		m_workers.emplace_back(&Generator::worker_loop, this);
+}
+Component::TerrainStream::Generator::~Generator()
+{
+	{
+		std::lock_guard lock(mutex);
+		m_stopping = true;
+	}
+	work_available.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+}
+Component::TerrainStream::Generator& Component::TerrainStream::Generator::get()
+{
+	static Generator generator{get_worker_count()};
+	return generator;
+}
+void Component::TerrainStream::Generator::add_queue(const std::shared_ptr<Queue>& p_queue)
+{
+	std::lock_guard lock(mutex);
+	m_queues.push_back(p_queue);
+}
+std::shared_ptr<Component::TerrainStream::Queue> Component::TerrainStream::Generator::next_queue()
+{
+	std::erase_if(m_queues, [](const std::weak_ptr<Queue>& p_queue) { return p_queue.expired(); });
+	for (size_t i = 0; i < m_queues.size(); i++)
+	{
+		const size_t index = (m_next_queue + i) % m_queues.size();
+		if (auto queue = m_queues[index].lock(); queue && !queue->requests.empty())
+		{
+			m_next_queue = index + 1;
+			return queue;
+		}
+	}
+	return nullptr;
+}
+void Component::TerrainStream::Generator::worker_loop()
+{
+	while (true)
+	{
+		std::shared_ptr<Queue> queue; // Keeps the queue alive for the result if its stream is destroyed while the chunk is generated.
+		Coord coord;
+		Settings job_settings;
+		size_t job_generation;
+		{
+			std::unique_lock lock(mutex);
+			work_available.wait(lock, [this, &queue] { return m_stopping || (queue = next_queue()); });
+			if (m_stopping)
+				return;
+
+			coord          = queue->requests.front();
+			job_settings   = queue->settings;
+			job_generation = queue->generation;
+			queue->requests.pop_front();
+		}
+
+		auto generated       = TerrainStream::generate(job_settings, coord);
+		generated.generation = job_generation;
+
+		std::lock_guard lock(mutex);
+		queue->finished.push_back(std::move(generated));
+	}
+}
+
+Component::TerrainStream::TerrainStream(const glm::vec3& p_position, float p_amplitude)
+	: m_queue{std::make_shared<Queue>()}
+	, m_settings{}
+	, m_generation{0}
+	, m_chunks{}
+	, m_pending{}
+	, m_ready{}
+	, m_index_buffer{}
+	, m_resident_bytes{0}
+	, m_position{p_position}
+	, m_chunk_cells{32}
+	, m_scale_factor{0.03f}
+	, m_amplitude{p_amplitude}
+	, m_lacunarity{2.f}
+	, m_persistence{0.5f}
+	, m_octaves{4}
+	, m_seed{Utility::get_random_number<unsigned int>()}
+	, m_load_radius{384.f}
+	, m_unload_margin{64.f}
+	, m_memory_budget{128 * 1024 * 1024}
+	, m_uploads_per_update{8}
+	, m_grass_tex{}
+	, m_rock_tex{}
+	, m_snow_tex{}
+{
+	Generator::get().add_queue(m_queue);
+}
+Component::TerrainStream::TerrainStream(const TerrainStream& p_other)
+	: TerrainStream(p_other.m_position, p_other.m_amplitude)
+{
+	*this = p_other;
+}
+Component::TerrainStream& Component::TerrainStream::operator=(const TerrainStream& p_other)
+{
+	if (this != &p_other)
+	{
+		m_position           = p_other.m_position;
+		m_chunk_cells        = p_other.m_chunk_cells;
+		m_scale_factor       = p_other.m_scale_factor;
+		m_amplitude          = p_other.m_amplitude;
+		m_lacunarity         = p_other.m_lacunarity;
+		m_persistence        = p_other.m_persistence;
+		m_octaves            = p_other.m_octaves;
+		m_seed               = p_other.m_seed;
+		m_load_radius        = p_other.m_load_radius;
+		m_unload_margin      = p_other.m_unload_margin;
+		m_memory_budget      = p_other.m_memory_budget;
+		m_uploads_per_update = p_other.m_uploads_per_update;
+		m_grass_tex          = p_other.m_grass_tex;
+		m_rock_tex           = p_other.m_rock_tex;
+		m_snow_tex           = p_other.m_snow_tex;
+	}
+	return *this;
+}
+
+Component::TerrainStream::Settings Component::TerrainStream::get_settings() const
+{
+	return {m_seed, m_chunk_cells, m_scale_factor, m_amplitude, m_lacunarity, m_persistence, m_octaves};
+}
+
+Component::TerrainStream::Generated Component::TerrainStream::generate(const Settings& p_settings, Coord p_coord)
+{
+	// Samples are taken on a grid one sample wider on every side than the chunk for the central difference normals of its border.
+	const size_t cells   = static_cast<size_t>(p_settings.chunk_cells);
+	const size_t samples = cells + 3;
+	const int first_x    = p_coord.x * p_settings.chunk_cells - 1;
+	const int first_z    = p_coord.z * p_settings.chunk_cells - 1;
+
+	// Rounded up to a whole number of batches of four so no sample takes the scalar path noise2DBatch uses for the remainder.
+	// Every sample is then a function of its grid position alone and neighbouring chunks agree on the samples they share.
+	const size_t batch_count = (samples + 3) / 4 * 4;
+	std::vector<double> x_coords(batch_count);
+	std::vector<double> z_coords(batch_count);
+	std::vector<double> row_noise(batch_count);
+	std::vector<float> heights(samples * samples, 0.f);
+
+	const siv::PerlinNoise perlin{p_settings.seed};
+	float octave_frequency = 1.f;
+	float octave_amplitude = 1.f;
+	float max_value        = 0.f;
+	for (int octave = 0; octave < p_settings.octaves; octave++)
+	{
+		for (size_t z = 0; z < samples; z++)
+		{
+			for (size_t i = 0; i < batch_count; i++)
+			{
+				x_coords[i] = static_cast<float>(first_x + static_cast<int>(i)) * p_settings.scale_factor * octave_frequency;
+				z_coords[i] = static_cast<float>(first_z + static_cast<int>(z)) * p_settings.scale_factor * octave_frequency;
+			}
+			perlin.noise2DBatch(x_coords.data(), z_coords.data(), row_noise.data(), batch_count);
+
+			for (size_t x = 0; x < samples; x++)
+				heights[z * samples + x] += static_cast<float>(row_noise[x]) * octave_amplitude;
+		}
+		max_value        += octave_amplitude;
+		octave_amplitude *= p_settings.persistence;
+		octave_frequency *= p_settings.lacunarity;
+	}
+	for (auto& height : heights)
+		height = height / max_value * p_settings.amplitude;
+
+	Generated generated;
+	generated.coord      = p_coord;
+	generated.generation = 0;
+	generated.vertices.reserve((cells + 1) * (cells + 1));
+	auto height = [&](size_t p_x, size_t p_z) { return heights[p_z * samples + p_x]; };
+	float min_height = std::numeric_limits<float>::max();
+	float max_height = std::numeric_limits<float>::lowest();
+
+	for (size_t z = 1; z <= cells + 1; z++)
+	{
+		for (size_t x = 1; x <= cells + 1; x++)
+		{
+			min_height = std::min(min_height, height(x, z));
+			max_height = std::max(max_height, height(x, z));
+		}
+	}
+	// Heights are quantised over the range every chunk can reach rather than their own so neighbours decode shared samples to the same height.
+	for (size_t z = 1; z <= cells + 1; z++)
+	{
+		for (size_t x = 1; x <= cells + 1; x++)
+		{
+			const auto normal = glm::normalize(glm::vec3((height(x - 1, z) - height(x + 1, z)) * 0.5f, 1.f, (height(x, z - 1) - height(x, z + 1)) * 0.5f));
+			generated.vertices.emplace_back(height(x, z), -p_settings.amplitude, 2.f * p_settings.amplitude, normal);
+		}
+	}
+	const auto chunk_min = glm::vec3(p_coord.x * p_settings.chunk_cells, min_height, p_coord.z * p_settings.chunk_cells);
+	generated.bounds     = Geometry::AABB(chunk_min, glm::vec3(chunk_min.x + static_cast<float>(cells), max_height, chunk_min.z + static_cast<float>(cells)));
+	return generated;
+}
+
+void Component::TerrainStream::upload(Generated&& p_generated)
+{
+	if (!m_index_buffer)
+	{
+		const auto indices = make_chunk_indices(static_cast<size_t>(m_settings.chunk_cells));
+		m_index_buffer     = std::make_shared<OpenGL::Buffer>(OpenGL::BufferStorageBitfield{OpenGL::BufferStorageFlag::DynamicStorageBit}, indices);
+		m_resident_bytes  += indices.size() * sizeof(unsigned int);
+	}
+
+	const auto& bounds       = p_generated.bounds;
+	const size_t index_count = static_cast<size_t>(m_settings.chunk_cells * m_settings.chunk_cells * 6);
+	auto mesh = Data::TerrainMesh(p_generated.vertices, m_index_buffer, index_count, glm::vec2(bounds.m_min.x, bounds.m_min.z), 1.f,
+	                              static_cast<size_t>(m_settings.chunk_cells + 1), -m_settings.amplitude, 2.f * m_settings.amplitude);
+
+	m_resident_bytes += mesh.vertex_bytes();
+	m_chunks.emplace(p_generated.coord, Chunk{bounds, std::move(mesh)});
+}
+void Component::TerrainStream::evict(std::map<Coord, Chunk>::iterator p_chunk)
+{
+	m_resident_bytes -= p_chunk->second.mesh.vertex_bytes();
+	m_chunks.erase(p_chunk);
+}
+
+void Component::TerrainStream::update(const glm::vec3& p_view_position)
+{
+	auto& generator = Generator::get();
+	if (const auto settings = get_settings(); settings != m_settings)
+	{// Chunks of the old settings are discarded, the generation lets the workers' results still in flight be told apart and dropped.
+		m_settings = settings;
+		m_chunks.clear();
+		m_pending.clear();
+		m_ready.clear();
+		m_index_buffer.reset();
+		m_resident_bytes = 0;
+
+		std::lock_guard lock(generator.mutex);
+		m_queue->settings = m_settings;
+		m_generation      = ++m_queue->generation;
+		m_queue->requests.clear();
+		m_queue->finished.clear();
+	}
+	{
+		std::lock_guard lock(generator.mutex);
+		for (auto& generated : m_queue->finished)
+		{
+			if (generated.generation == m_generation)
+				m_ready.push_back(std::move(generated));
+		}
+		m_queue->finished.clear();
+	}
+
+	const auto view            = glm::vec2(p_view_position.x - m_position.x, p_view_position.z - m_position.z);
+	const float unload_radius  = m_load_radius + m_unload_margin;
+	const size_t vertex_bytes  = static_cast<size_t>((m_chunk_cells + 1) * (m_chunk_cells + 1)) * sizeof(Data::TerrainVertex);
+	const size_t index_bytes   = static_cast<size_t>(m_chunk_cells * m_chunk_cells * 6) * sizeof(unsigned int);
+	const size_t max_chunks    = m_memory_budget > index_bytes ? (m_memory_budget - index_bytes) / vertex_bytes : 0;
+	auto distance = [&](Coord p_coord) { return distance_to_chunk(view, p_coord.x, p_coord.z, m_chunk_cells); };
+
+	// Hysteresis: chunks load within m_load_radius but only unload beyond unload_radius.
+	for (auto it = m_chunks.begin(); it != m_chunks.end();)
+	{
+		if (distance(it->first) > unload_radius)
+			evict(it++);
+		else
+			++it;
+	}
+	auto furthest_chunk = [&]() { return std::max_element(m_chunks.begin(), m_chunks.end(), [&](const auto& p_lhs, const auto& p_rhs) { return distance(p_lhs.first) < distance(p_rhs.first); }); };
+	while (m_chunks.size() > max_chunks) // The budget was lowered.
+		evict(furthest_chunk());
+
+	{// Upload the nearest generated chunks still in range, making room in the budget by evicting chunks further away than them.
+		std::sort(m_ready.begin(), m_ready.end(), [&](const Generated& p_lhs, const Generated& p_rhs) { return distance(p_lhs.coord) < distance(p_rhs.coord); });
+		size_t processed = 0;
+		for (auto& generated : m_ready)
+		{
+			if (processed == m_uploads_per_update)
+				break;
+			const float generated_distance = distance(generated.coord);
+			processed++;
+			m_pending.erase(generated.coord);
+
+			while (m_chunks.size() >= max_chunks && !m_chunks.empty())
+			{
+				auto furthest = furthest_chunk();
+				if (distance(furthest->first) <= generated_distance)
+					break;
+				evict(furthest);
+			}
+			if (generated_distance <= unload_radius && m_chunks.size() < max_chunks)
+				upload(std::move(generated));
+		}
+		m_ready.erase(m_ready.begin(), m_ready.begin() + processed);
+	}
+
+	{// Request the chunks within m_load_radius missing, nearest first, up to the number m_memory_budget can hold.
+		const int chunk_cells = m_chunk_cells;
+		const int first_x     = static_cast<int>(std::floor((view.x - m_load_radius) / static_cast<float>(chunk_cells)));
+		const int last_x      = static_cast<int>(std::floor((view.x + m_load_radius) / static_cast<float>(chunk_cells)));
+		const int first_z     = static_cast<int>(std::floor((view.y - m_load_radius) / static_cast<float>(chunk_cells)));
+		const int last_z      = static_cast<int>(std::floor((view.y + m_load_radius) / static_cast<float>(chunk_cells)));
+
+		std::vector<std::pair<float, Coord>> in_range;
+		for (int z = first_z; z <= last_z; z++)
+		{
+			for (int x = first_x; x <= last_x; x++)
+			{
+				if (const float chunk_distance = distance({x, z}); chunk_distance <= m_load_radius)
+					in_range.push_back({chunk_distance, Coord{x, z}});
+			}
+		}
+		std::sort(in_range.begin(), in_range.end());
+		in_range.resize(std::min(in_range.size(), max_chunks));
+
+		std::lock_guard lock(generator.mutex);
+		for (const auto& coord : m_queue->requests)
+			m_pending.erase(coord); // Requeued below if still wanted.
+		m_queue->requests.clear();
+
+		for (const auto& [chunk_distance, coord] : in_range)
+		{
+			if (!m_chunks.contains(coord) && m_pending.insert(coord).second)
+				m_queue->requests.push_back(coord);
+		}
+	}
+	generator.work_available.notify_all();
+}
+
+void Component::TerrainStream::draw_UI(System::AssetManager& p_asset_manager)
+{
+	if (ImGui::TreeNode("Terrain stream"))
+	{
+		auto formatted_used   = Utility::format_number(static_cast<float>(m_resident_bytes) / (1024.f * 1024.f), 1);
+		auto formatted_budget = Utility::format_number(static_cast<float>(m_memory_budget) / (1024.f * 1024.f), 1);
+		ImGui::Text("Resident chunks: %zu", m_chunks.size());
+		ImGui::Text("Pending chunks: %zu", m_pending.size());
+		ImGui::Text_Manual("Memory: %s/%sMB", formatted_used.c_str(), formatted_budget.c_str());
+
+		ImGui::SeparatorText("Streaming");
+		ImGui::Slider("Load radius", m_load_radius, 32.f, 2048.f, "%.1fm");
+		ImGui::Slider("Unload margin", m_unload_margin, 0.f, 512.f, "%.1fm");
+		int budget_MB = static_cast<int>(m_memory_budget / (1024 * 1024));
+		if (ImGui::Slider("Memory budget", budget_MB, 1, 2048, "%dMB"))
+			m_memory_budget = static_cast<size_t>(budget_MB) * 1024 * 1024;
+		int uploads_per_update = static_cast<int>(m_uploads_per_update);
+		if (ImGui::Slider("Uploads per update", uploads_per_update, 1, 64))
+			m_uploads_per_update = static_cast<size_t>(uploads_per_update);
+
+		ImGui::SeparatorText("Textures");
+		p_asset_manager.draw_texture_selector("Grass texture", m_grass_tex);
+		p_asset_manager.draw_texture_selector("Rock texture", m_rock_tex);
+		p_asset_manager.draw_texture_selector("Snow texture", m_snow_tex);
+
+		// Changes to the generation settings are picked up by the next update.
+		ImGui::SeparatorText("Generation settings");
+		ImGui::Slider("Position", m_position, -100.f, 100.f, "%.3fm");
+		ImGui::Slider("Chunk cells", m_chunk_cells, 8, 128, "%dm");
+		ImGui::Slider("Scale factor", m_scale_factor, 0.01f , 0.15f);
+		ImGui::Slider("Amplitude", m_amplitude, 0.01f, 100.f);
+		ImGui::Slider("Lacunarity", m_lacunarity, 0.01f, 4.f);
+		ImGui::Slider("Persistence", m_persistence, 0.01f, 1.f);
+		ImGui::Slider("Octaves", m_octaves, 1, 10);
+		ImGui::InputScalar("Seed", ImGuiDataType_U32, &m_seed);
+		ImGui::SameLine();
+		if (ImGui::Button("Rand"))
+			m_seed = Utility::get_random_number<unsigned int>();
+
+		ImGui::TreePop();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "Component/TerrainMesh.hpp"
+#include "Component/Texture.hpp"
+#include "Data/Vertex.hpp"
+#include "Geometry/AABB.hpp"
+#include "OpenGL/Types.hpp"
+
+#include "glm/vec3.hpp"
+
+#include <compare>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace System
+{
+	class AssetManager;
+}
+namespace Component
+{
+	// Terrain without bounds, generated as square chunks within m_load_radius of the view and evicted once the view moves away.
+	// Chunks are generated on background threads, update only uploads finished chunks to the GPU on the calling thread which must own the GL context.
+	// The heights of a chunk depend only on its coordinate and the generation settings, so an evicted chunk regenerates identically and
+	// neighbouring chunks agree on the samples and normals along their shared border.
+	class TerrainStream
+	{
+	public:
+		// Chunk (x, z) covers cells [x * m_chunk_cells, (x + 1) * m_chunk_cells) of the grid of unit cells starting at m_position, likewise along Z.
+		struct Coord
+		{
+			int x;
+			int z;
+			auto operator<=>(const Coord&) const = default;
+		};
+		struct Chunk
+		{
+			Geometry::AABB bounds; // Bounds of the chunk's samples relative to m_position.
+			Data::TerrainMesh mesh;
+		};
+
+		// The settings chunks are generated with. Chunks generated with different settings are discarded.
+		struct Settings
+		{
+			unsigned int seed  = 0;
+			int chunk_cells    = 0;
+			float scale_factor = 0.f;
+			float amplitude    = 0.f;
+			float lacunarity   = 0.f;
+			float persistence  = 0.f;
+			int octaves        = 0;
+			bool operator==(const Settings&) const = default;
+		};
+		struct Generated
+		{
+			Coord coord;
+			size_t generation;
+			Geometry::AABB bounds;
+			std::vector<Data::TerrainVertex> vertices; // Heights quantised over [-amplitude, amplitude].
+		};
+		// Generate the vertices of chunk p_coord. A pure function of its arguments, safe to call from any thread.
+		// Samples one past each edge of the chunk so normals on the border match the neighbouring chunk.
+		static Generated generate(const Settings& p_settings, Coord p_coord);
+
+	private:
+		// The requests and results of one TerrainStream. Held by pointer so the TerrainStream can move while its chunks are generated.
+		// Only accessed with Generator::mutex held.
+		struct Queue
+		{
+			std::deque<Coord> requests;      // Chunks to generate, nearest to the view first. Replaced by every TerrainStream::update.
+			std::vector<Generated> finished; // Generated chunks waiting for TerrainStream::update to collect them.
+			Settings settings;
+			size_t generation = 0; // Incremented when the settings change so chunks generated with the old settings can be told apart.
+		};
+		// Worker threads generating the chunks of every TerrainStream. Shared so the number of threads doesn't grow with the number of streams.
+		// Workers take a request from each queue in turn so a stream with many requests doesn't hold up the others.
+		class Generator
+		{
+		public:
+			std::mutex mutex;
+			std::condition_variable work_available;
+
+			static Generator& get();
+			// Start generating the requests of p_queue. The queue is dropped once the TerrainStream owning it is destroyed.
+			void add_queue(const std::shared_ptr<Queue>& p_queue);
+
+			~Generator();
+			Generator(const Generator&)            = delete;
+			Generator& operator=(const Generator&) = delete;
+
+		private:
+			std::vector<std::weak_ptr<Queue>> m_queues;
+			size_t m_next_queue; // Index into m_queues of the queue to take the next request from.
+			std::vector<std::thread> m_workers;
+			bool m_stopping;
+
+			explicit Generator(size_t p_worker_count);
+			void worker_loop();
+			// The first queue from m_next_queue with requests, nullptr if none have any. Drops the queues of destroyed streams. Called with mutex held.
+			std::shared_ptr<Queue> next_queue();
+		};
+
+		std::shared_ptr<Queue> m_queue;
+		Settings m_settings;    // The settings of the resident chunks.
+		size_t m_generation;    // The Queue::generation m_settings were given to the generator as.
+		std::map<Coord, Chunk> m_chunks;
+		std::set<Coord> m_pending;      // Chunks requested but not yet resident, queued, being generated or in m_ready.
+		std::vector<Generated> m_ready; // Generated chunks waiting to be uploaded.
+		std::shared_ptr<OpenGL::Buffer> m_index_buffer; // Every chunk has the same triangulation so shares one index buffer.
+		size_t m_resident_bytes;
+
+		Settings get_settings() const;
+		// Create the GPU buffers of p_generated, the only work of streaming done on the thread calling update.
+		// Every chunk has the same number of vertices and triangulation, the first upload after a settings change creates the shared index buffer.
+		void upload(Generated&& p_generated);
+		void evict(std::map<Coord, Chunk>::iterator p_chunk);
+
+	public:
+		constexpr static size_t Persistent_ID = 13;
+
+		glm::vec3 m_position; // Origin of the chunk grid. Moving it shifts the terrain without regenerating.
+		int m_chunk_cells;
+		float m_scale_factor;
+		float m_amplitude;
+		float m_lacunarity;
+		float m_persistence;
+		int m_octaves;
+		unsigned int m_seed;
+		float m_load_radius;         // Chunks within this distance of the view in the XZ plane are generated.
+		float m_unload_margin;       // Chunks stay resident until this far beyond m_load_radius so moving back and forth over a border doesn't regenerate them.
+		size_t m_memory_budget;      // Bytes of GPU buffers resident chunks may use. Nearer chunks are preferred when the chunks in range exceed it.
+		size_t m_uploads_per_update; // Generated chunks uploaded per update, spreading the upload of a burst of chunks over several frames.
+
+		TextureRef m_grass_tex;
+		TextureRef m_rock_tex;
+		TextureRef m_snow_tex;
+
+		TerrainStream(const glm::vec3& p_position, float p_amplitude);
+		// Copies take the settings of p_other and stream their own chunks, which generate identically.
+		TerrainStream(const TerrainStream& p_other);
+		TerrainStream& operator=(const TerrainStream& p_other);
+		TerrainStream(TerrainStream&& p_other) noexcept            = default;
+		TerrainStream& operator=(TerrainStream&& p_other) noexcept = default;
+
+		// Stream chunks for a view at world space p_view_position.
+		// Collects the chunks generated since the last update, uploads the nearest, evicts chunks out of range and requests the missing ones.
+		// A change of generation settings discards every chunk.
+		void update(const glm::vec3& p_view_position);
+		const std::map<Coord, Chunk>& chunks() const { return m_chunks; }
+		size_t resident_bytes()                const { return m_resident_bytes; }
+		void draw_UI(System::AssetManager& p_asset_manager);
+	};
+} // namespace Component
\ No newline at end of file
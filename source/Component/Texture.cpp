@@ -43,6 +43,11 @@ namespace Data
 		                true,
 		                m_image.data }
 	{}
+	size_t Texture::memory_size() const
+	{
+		const size_t pixel_bytes = static_cast<size_t>(m_image.width) * static_cast<size_t>(m_image.height) * m_image.number_of_channels;
+		return pixel_bytes + pixel_bytes * 4 / 3; // The mip chain adds a third to the GPU copy.
+	}
 } // namespace Data
 
 namespace Component
@@ -38,6 +38,8 @@ namespace Data
 		glm::uvec2 resolution() const { return {m_image.width, m_image.height}; }
 		// Return the filepath of the image.
 		const std::filesystem::path& filepath() const { return m_filepath; }
+		// Return the bytes of the pixel data, held in memory and again on the GPU with its mipmaps.
+		size_t memory_size() const;
 	};
 }
 
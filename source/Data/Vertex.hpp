@@ -3,8 +3,13 @@
 #include "glm/vec4.hpp"
 #include "glm/vec3.hpp"
 #include "glm/vec2.hpp"
+#include "glm/geometric.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <concepts>
+#include <cstdint>
 #include <stdexcept>
 #include <type_traits>
 
@@ -47,4 +52,44 @@ namespace Data
 	{
 		glm::vec3 position = glm::vec3{0.f};
 	};
+	// Vertex of a terrain chunk on a grid of unit cells, 4 bytes against the 48 of Vertex.
+	// Only the height is stored, phong_terrain.vert reconstructs the grid position from the index of the vertex in its row-major chunk
+	// and uses it as the UV. Heights are quantised over one range shared by every chunk of a terrain, so chunks sharing a border sample
+	// decode it to the same height: the heightfield bounds for Terrain, +-amplitude for TerrainStream. The normal is octahedral encoded around +Y.
+	struct TerrainVertex
+	{
+		uint16_t height               = 0;      // 0 is the bottom of the terrain's shared height range and 65535 the top.
+		std::array<int8_t, 2> normal  = {0, 0}; // X and Z of the normal projected onto the octahedron |x| + |y| + |z| = 1, lower half folded out.
+
+		TerrainVertex() = default;
+		//@param p_min_height,p_height_range The heights quantised to 0 and 65535.
+		TerrainVertex(float p_height, float p_min_height, float p_height_range, const glm::vec3& p_normal)
+		{
+			const float height_01 = p_height_range > 0.f ? std::clamp((p_height - p_min_height) / p_height_range, 0.f, 1.f) : 0.f;
+			height = static_cast<uint16_t>(std::lround(height_01 * 65535.f));
+
+			const float l1_norm = std::abs(p_normal.x) + std::abs(p_normal.y) + std::abs(p_normal.z);
+			glm::vec2 octahedral = glm::vec2(p_normal.x, p_normal.z) / l1_norm;
+			if (p_normal.y < 0.f)
+			{
+				const glm::vec2 folded = glm::vec2(1.f - std::abs(octahedral.y), 1.f - std::abs(octahedral.x));
+				octahedral = glm::vec2(octahedral.x >= 0.f ? folded.x : -folded.x, octahedral.y >= 0.f ? folded.y : -folded.y);
+			}
+			normal = {static_cast<int8_t>(std::lround(std::clamp(octahedral.x, -1.f, 1.f) * 127.f)),
+			          static_cast<int8_t>(std::lround(std::clamp(octahedral.y, -1.f, 1.f) * 127.f))};
+		}
+
+		// Decoding matching phong_terrain.vert.
+		float get_height(float p_min_height, float p_height_range) const { return p_min_height + static_cast<float>(height) / 65535.f * p_height_range; }
+		glm::vec3 get_normal() const
+		{
+			const glm::vec2 octahedral = glm::vec2(std::max(normal[0] / 127.f, -1.f), std::max(normal[1] / 127.f, -1.f));
+			glm::vec3 result = glm::vec3(octahedral.x, 1.f - std::abs(octahedral.x) - std::abs(octahedral.y), octahedral.y);
+			const float fold = std::max(-result.y, 0.f);
+			result.x += result.x >= 0.f ? -fold : fold;
+			result.z += result.z >= 0.f ? -fold : fold;
+			return glm::normalize(result);
+		}
+	};
+	static_assert(sizeof(TerrainVertex) == 4);
 } // namespace Data
@@ -71,6 +71,12 @@ namespace ECS
 			type_infos[get_ID<ComponentType>()] = ComponentData(Meta::PackArg<ComponentType>());
 		}
 
+		// Unregister every ComponentType. Lets testers register their own ComponentTypes sharing the Persistent_ID of another.
+		static inline void clear_info()
+		{
+			type_infos = {};
+		}
+
 		// Get the ComponentData given a ComponentID.
 		static inline const ComponentData& get_info(ComponentID p_component_ID)
 		{
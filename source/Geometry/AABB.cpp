@@ -1,14 +1,22 @@
 #include "AABB.hpp"
 
+#include "Utility/Logger.hpp"
 #include "Utility/Serialise.hpp"
 
 #include "glm/vec3.hpp"
 #include "glm/mat4x4.hpp"
+#include "glm/gtc/quaternion.hpp"
 #include "glm/gtx/transform.hpp"
 
 #include "imgui.h"
 
 #include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define Z_AABB_SSE
+	#include <emmintrin.h>
+#endif
 
 namespace Geometry
 {
@@ -119,6 +127,93 @@ namespace Geometry
 		return transformedAABB;
 	}
 
+	// Transform the AABB as a center and half extents: the center is transformed as a point and the half extents by the absolute
+	// of the rotation-scale matrix. Equivalent to summing the smaller and larger terms of each axis in transform().
+	static AABB transform_one(const AABB& p_AABB, const glm::vec3& p_position, const glm::quat& p_orientation, const glm::vec3& p_scale)
+	{
+		const auto rotation = glm::mat3_cast(p_orientation);
+		const auto center   = (p_AABB.m_min + p_AABB.m_max) * 0.5f;
+		const auto half     = (p_AABB.m_max - p_AABB.m_min) * 0.5f;
+
+		glm::vec3 world_center = p_position;
+		glm::vec3 world_half   = glm::vec3(0.f);
+		for (int j = 0; j < 3; j++)
+		{
+			const auto column = rotation[j] * p_scale[j];
+			world_center += column * center[j];
+			world_half   += glm::abs(column) * half[j];
+		}
+		return AABB(world_center - world_half, world_center + world_half);
+	}
+
+	void AABB::transform(std::span<const AABB> p_AABBs, std::span<const glm::vec3> p_positions, std::span<const glm::quat> p_orientations, std::span<const glm::vec3> p_scales, std::span<AABB> out_AABBs)
+	{
+		ASSERT_THROW(p_positions.size() == p_AABBs.size() && p_orientations.size() == p_AABBs.size() && p_scales.size() == p_AABBs.size() && out_AABBs.size() == p_AABBs.size(),
+			"[AABB] Batched transform expects a position, orientation, scale and output per AABB.");
+
+		size_t i = 0;
+#ifdef Z_AABB_SSE
+		// Each lane holds one of four AABBs, the components are gathered into lanes so every operation transforms all four at once.
+		auto gather = [](const auto& p_get) { return _mm_setr_ps(p_get(0), p_get(1), p_get(2), p_get(3)); };
+		const __m128 sign_mask = _mm_set1_ps(-0.f);
+		const __m128 one       = _mm_set1_ps(1.f);
+		const __m128 two       = _mm_set1_ps(2.f);
+		const __m128 half      = _mm_set1_ps(0.5f);
+
+		for (; i + 4 <= p_AABBs.size(); i += 4)
+		{
+			const __m128 qx = gather([&](size_t p_lane) { return p_orientations[i + p_lane].x; });
+			const __m128 qy = gather([&](size_t p_lane) { return p_orientations[i + p_lane].y; });
+			const __m128 qz = gather([&](size_t p_lane) { return p_orientations[i + p_lane].z; });
+			const __m128 qw = gather([&](size_t p_lane) { return p_orientations[i + p_lane].w; });
+
+			// Rotation matrix columns as in glm::mat3_cast, rotation[column][row].
+			const __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+			const __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+			const __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+			__m128 rotation[3][3] = {
+				{_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), _mm_mul_ps(two, _mm_add_ps(xy, wz)), _mm_mul_ps(two, _mm_sub_ps(xz, wy))},
+				{_mm_mul_ps(two, _mm_sub_ps(xy, wz)), _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), _mm_mul_ps(two, _mm_add_ps(yz, wx))},
+				{_mm_mul_ps(two, _mm_add_ps(xz, wy)), _mm_mul_ps(two, _mm_sub_ps(yz, wx)), _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)))}};
+
+			__m128 world_center[3];
+			__m128 world_half[3];
+			for (int row = 0; row < 3; row++)
+			{
+				world_center[row] = gather([&](size_t p_lane) { return p_positions[i + p_lane][row]; });
+				world_half[row]   = _mm_setzero_ps();
+			}
+			for (int column = 0; column < 3; column++)
+			{
+				const __m128 scale  = gather([&](size_t p_lane) { return p_scales[i + p_lane][column]; });
+				const __m128 min    = gather([&](size_t p_lane) { return p_AABBs[i + p_lane].m_min[column]; });
+				const __m128 max    = gather([&](size_t p_lane) { return p_AABBs[i + p_lane].m_max[column]; });
+				const __m128 center = _mm_mul_ps(_mm_add_ps(min, max), half);
+				const __m128 extent = _mm_mul_ps(_mm_sub_ps(max, min), half);
+				for (int row = 0; row < 3; row++)
+				{
+					const __m128 element = _mm_mul_ps(rotation[column][row], scale);
+					world_center[row] = _mm_add_ps(world_center[row], _mm_mul_ps(element, center));
+					world_half[row]   = _mm_add_ps(world_half[row], _mm_mul_ps(_mm_andnot_ps(sign_mask, element), extent));
+				}
+			}
+
+			// Scatter the lanes back out to the AABBs.
+			alignas(16) float world_min[3][4];
+			alignas(16) float world_max[3][4];
+			for (int row = 0; row < 3; row++)
+			{
+				_mm_store_ps(world_min[row], _mm_sub_ps(world_center[row], world_half[row]));
+				_mm_store_ps(world_max[row], _mm_add_ps(world_center[row], world_half[row]));
+			}
+			for (size_t lane = 0; lane < 4; lane++)
+				out_AABBs[i + lane] = AABB(glm::vec3(world_min[0][lane], world_min[1][lane], world_min[2][lane]), glm::vec3(world_max[0][lane], world_max[1][lane], world_max[2][lane]));
+		}
+#endif
+		for (; i < p_AABBs.size(); i++)
+			out_AABBs[i] = transform_one(p_AABBs[i], p_positions[i], p_orientations[i], p_scales[i]);
+	}
+
 	void AABB::draw_UI(const char* title) const
 	{
 		if (title)
@@ -172,6 +267,18 @@ namespace Geometry
 			min.y <= point.y &&
 			max.y >= point.y;
 	}
+	bool AABB2D::intersects(const AABB2D& AABB) const
+	{
+		return
+			min.x <= AABB.max.x &&
+			max.x >= AABB.min.x &&
+			min.y <= AABB.max.y &&
+			max.y >= AABB.min.y;
+	}
+	glm::vec2 AABB2D::closest_point(const glm::vec2& point) const
+	{
+		return glm::vec2(std::clamp(point.x, min.x, max.x), std::clamp(point.y, min.y, max.y));
+	}
 	void AABB2D::draw_UI(const char* title) const
 	{
 		if (title)
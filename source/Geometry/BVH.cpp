@@ -0,0 +1,251 @@
+#include "BVH.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Geometry
+{
+	// Half the surface area of p_AABB, the SAH only compares areas so the factor of 2 is dropped.
+	static float half_area(const AABB& p_AABB)
+	{
+		const auto size = p_AABB.get_size();
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	BVH::BVH(std::span<const AABB> p_bounds, uint32_t p_max_leaf_size)
+		: m_nodes{}
+		, m_item_indices{}
+		, m_item_bounds{p_bounds.begin(), p_bounds.end()}
+	{
+		ASSERT_THROW(p_max_leaf_size > 0, "[BVH] Leaves must be allowed at least one item.");
+		ASSERT_THROW(p_bounds.size() < std::numeric_limits<uint32_t>::max(), "[BVH] Too many items, item indices are stored as uint32_t.");
+
+		if (p_bounds.empty())
+			return;
+
+		const auto count = static_cast<uint32_t>(p_bounds.size());
+		m_item_indices.resize(count);
+		std::vector<glm::vec3> centroids(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			m_item_indices[i] = i;
+			centroids[i]      = p_bounds[i].get_center();
+		}
+
+		// A binary tree with leaves of at least one item has fewer than 2n nodes.
+		m_nodes.reserve(count * 2);
+		m_nodes.push_back({});
+		build(0, 0, count, 0, p_max_leaf_size, centroids);
+	}
+
+	void BVH::refit(std::span<const AABB> p_bounds)
+	{
+		ASSERT_THROW(p_bounds.size() == m_item_bounds.size(), "[BVH] Refit expects an AABB per item the BVH was built from.");
+		std::copy(p_bounds.begin(), p_bounds.end(), m_item_bounds.begin());
+
+		// Children are always stored after their parent, walking the nodes backwards fits every child before its parent.
+		for (auto node = m_nodes.rbegin(); node != m_nodes.rend(); node++)
+		{
+			if (node->is_leaf())
+			{
+				node->bounds = m_item_bounds[m_item_indices[node->first]];
+				for (uint32_t i = node->first + 1; i < node->first + node->count; i++)
+					node->bounds.unite(m_item_bounds[m_item_indices[i]]);
+			}
+			else
+				node->bounds = AABB::unite(m_nodes[node->first].bounds, m_nodes[node->first + 1].bounds);
+		}
+	}
+
+	float BVH::SAH_cost() const
+	{
+		if (m_nodes.empty())
+			return 0.f;
+
+		// A ray entering a node tests its children or items, the chance it enters is the node's area relative to the root.
+		float cost = 0.f;
+		for (const auto& node : m_nodes)
+			cost += half_area(node.bounds) * static_cast<float>(node.is_leaf() ? node.count : 2);
+
+		const float root_area = half_area(m_nodes.front().bounds);
+		return root_area > 0.f ? cost / root_area : 0.f;
+	}
+
+	void BVH::build(uint32_t p_node, uint32_t p_first, uint32_t p_count, size_t p_depth, uint32_t p_max_leaf_size, const std::vector<glm::vec3>& p_centroids)
+	{
+		AABB bounds          = m_item_bounds[m_item_indices[p_first]];
+		AABB centroid_bounds = AABB(p_centroids[m_item_indices[p_first]], p_centroids[m_item_indices[p_first]]);
+		for (uint32_t i = p_first + 1; i < p_first + p_count; i++)
+		{
+			bounds.unite(m_item_bounds[m_item_indices[i]]);
+			centroid_bounds.unite(p_centroids[m_item_indices[i]]);
+		}
+		m_nodes[p_node].bounds = bounds;
+
+		auto make_leaf = [&]()
+		{
+			m_nodes[p_node].first = p_first;
+			m_nodes[p_node].count = p_count;
+		};
+
+		if (p_count <= p_max_leaf_size)
+			return make_leaf();
+
+		const auto centroid_size = centroid_bounds.get_size();
+		const int longest_axis   = centroid_size.x > centroid_size.y ? (centroid_size.x > centroid_size.z ? 0 : 2) : (centroid_size.y > centroid_size.z ? 1 : 2);
+		const auto first         = m_item_indices.begin() + p_first;
+		const auto last          = first + p_count;
+		uint32_t split_count     = 0; // Number of items going into the left child.
+
+		if (centroid_size[longest_axis] <= 0.f)
+		{// Every centroid coincides, no plane can separate them.
+			if (p_count <= p_max_leaf_size * 4)
+				return make_leaf();
+			split_count = p_count / 2; // Split arbitrarily to keep leaves small.
+		}
+		else if (p_depth >= SAH_depth_limit)
+		{
+			split_count = p_count / 2;
+			std::nth_element(first, first + split_count, last, [&](uint32_t p_left, uint32_t p_right)
+				{ return p_centroids[p_left][longest_axis] < p_centroids[p_right][longest_axis]; });
+		}
+		else
+		{// Binned SAH: bucket the centroids along each axis and evaluate a split plane between every pair of buckets.
+			constexpr int Bin_count = 12;
+			struct Bin
+			{
+				AABB bounds;
+				uint32_t count = 0;
+			};
+
+			float best_cost = half_area(bounds) * static_cast<float>(p_count); // Cost of not splitting.
+			int best_axis   = -1;
+			int best_split  = 0;
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if (centroid_size[axis] <= 0.f)
+					continue;
+
+				std::array<Bin, Bin_count> bins;
+				const float scale = static_cast<float>(Bin_count) / centroid_size[axis];
+				for (auto it = first; it != last; it++)
+				{
+					const int bin_index = std::min(Bin_count - 1, static_cast<int>((p_centroids[*it][axis] - centroid_bounds.m_min[axis]) * scale));
+					auto& bin = bins[bin_index];
+					bin.bounds = bin.count == 0 ? m_item_bounds[*it] : AABB::unite(bin.bounds, m_item_bounds[*it]);
+					bin.count++;
+				}
+
+				// Sweep from the right accumulating the cost of the right side of every split, then sweep from the left to complete it.
+				std::array<float, Bin_count - 1> right_costs;
+				AABB right_bounds;
+				uint32_t right_count = 0;
+				for (int i = Bin_count - 1; i > 0; i--)
+				{
+					if (bins[i].count > 0)
+					{
+						right_bounds = right_count == 0 ? bins[i].bounds : AABB::unite(right_bounds, bins[i].bounds);
+						right_count += bins[i].count;
+					}
+					right_costs[i - 1] = right_count == 0 ? 0.f : half_area(right_bounds) * static_cast<float>(right_count);
+				}
+
+				AABB left_bounds;
+				uint32_t left_count = 0;
+				for (int i = 0; i < Bin_count - 1; i++)
+				{
+					if (bins[i].count > 0)
+					{
+						left_bounds = left_count == 0 ? bins[i].bounds : AABB::unite(left_bounds, bins[i].bounds);
+						left_count += bins[i].count;
+					}
+					if (left_count == 0 || left_count == p_count)
+						continue;
+
+					const float cost = half_area(left_bounds) * static_cast<float>(left_count) + right_costs[i];
+					if (cost < best_cost)
+					{
+						best_cost  = cost;
+						best_axis  = axis;
+						best_split = i;
+					}
+				}
+			}
+
+			if (best_axis == -1)
+			{// No split is cheaper than testing every item.
+				if (p_count <= p_max_leaf_size * 4)
+					return make_leaf();
+
+				split_count = p_count / 2;
+				std::nth_element(first, first + split_count, last, [&](uint32_t p_left, uint32_t p_right)
+					{ return p_centroids[p_left][longest_axis] < p_centroids[p_right][longest_axis]; });
+			}
+			else
+			{
+				const float scale = static_cast<float>(Bin_count) / centroid_size[best_axis];
+				const auto middle = std::partition(first, last, [&](uint32_t p_item)
+				{
+					const int bin_index = std::min(Bin_count - 1, static_cast<int>((p_centroids[p_item][best_axis] - centroid_bounds.m_min[best_axis]) * scale));
+					return bin_index <= best_split;
+				});
+				split_count = static_cast<uint32_t>(middle - first);
+			}
+		}
+
+		const auto left_child = static_cast<uint32_t>(m_nodes.size());
+		m_nodes[p_node].first = left_child;
+		m_nodes[p_node].count = 0;
+		m_nodes.push_back({});
+		m_nodes.push_back({});
+		build(left_child,     p_first,               split_count,           p_depth + 1, p_max_leaf_size, p_centroids);
+		build(left_child + 1, p_first + split_count, p_count - split_count, p_depth + 1, p_max_leaf_size, p_centroids);
+	}
+
+	BVH::RaySlab::RaySlab(const Ray& p_ray)
+		: start{p_ray.m_start}
+		, inverse_direction{0.f}
+		, parallel{}
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			parallel[i] = std::abs(p_ray.m_direction[i]) < std::numeric_limits<float>::epsilon();
+			if (!parallel[i])
+				inverse_direction[i] = 1.f / p_ray.m_direction[i];
+		}
+	}
+
+	bool BVH::RaySlab::intersect(const AABB& p_AABB, float& p_entry) const
+	{
+		float farthest_entry = -Max_distance;
+		float nearest_exit   = Max_distance;
+
+		for (int i = 0; i < 3; i++)
+		{
+			if (parallel[i])
+			{
+				if (start[i] < p_AABB.m_min[i] || start[i] > p_AABB.m_max[i])
+					return false;
+			}
+			else
+			{
+				float entry = (p_AABB.m_min[i] - start[i]) * inverse_direction[i];
+				float exit  = (p_AABB.m_max[i] - start[i]) * inverse_direction[i];
+				if (entry > exit)
+					std::swap(entry, exit);
+
+				farthest_entry = std::max(farthest_entry, entry);
+				nearest_exit   = std::min(nearest_exit, exit);
+				if (farthest_entry > nearest_exit)
+					return false;
+			}
+		}
+
+		if (farthest_entry == -Max_distance || nearest_exit == Max_distance)
+			return false;
+
+		p_entry = farthest_entry;
+		return true;
+	}
+} // namespace Geometry
\ No newline at end of file
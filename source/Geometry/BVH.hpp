@@ -0,0 +1,259 @@
+#pragma once
+
+#include "AABB.hpp"
+#include "Ray.hpp"
+
+#include "Utility/Logger.hpp"
+
+#include "glm/vec3.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Geometry
+{
+	// Bounding volume hierarchy over a set of items represented by their AABB.
+	// Built top-down splitting on the surface area heuristic (SAH) into a flat array of nodes, children are stored next to each other.
+	// Items are referred to by their index in the span the BVH was built from, the BVH does not own the items.
+	class BVH
+	{
+	public:
+		static constexpr float Max_distance = std::numeric_limits<float>::max();
+
+		struct Node
+		{
+			AABB bounds;
+			uint32_t first; // Leaf: index of the first item in m_item_indices. Internal: index of the left child, the right child follows it.
+			uint32_t count; // Number of items in a leaf, 0 for internal nodes.
+
+			bool is_leaf() const { return count > 0; }
+		};
+
+		BVH() = default;
+		//@param p_bounds The AABB of each item to partition.
+		//@param p_max_leaf_size Leaves are split until they hold at most this many items or splitting is no cheaper by the SAH.
+		explicit BVH(std::span<const AABB> p_bounds, uint32_t p_max_leaf_size = 4);
+
+		// Update the AABB of every item to p_bounds and grow or shrink the nodes to fit, keeping the tree as built.
+		// Much cheaper than rebuilding, but as items move away from where the tree partitioned them nodes overlap more, see SAH_cost.
+		//@param p_bounds The AABB of each item, as many as the BVH was built from.
+		void refit(std::span<const AABB> p_bounds);
+		// The SAH cost of a ray query relative to testing the root, comparable before and after refit to judge when to rebuild.
+		float SAH_cost() const;
+
+		bool empty()                          const { return m_nodes.empty(); }
+		size_t size()                         const { return m_item_bounds.size(); }
+		std::span<const Node> nodes()         const { return m_nodes; }
+		const AABB& item_bounds(size_t p_item) const { return m_item_bounds[p_item]; }
+		// The bytes of the nodes and items.
+		size_t memory_size()                  const { return m_nodes.size() * sizeof(Node) + m_item_indices.size() * sizeof(uint32_t) + m_item_bounds.size() * sizeof(AABB); }
+
+		// Visit the items whose AABB p_ray intersects, nearest node first.
+		// As with get_intersection(AABB, Ray) distances are the entry distance along p_ray and can be negative for AABBs around or behind the ray start.
+		//@param p_visitor Called with (item index, entry distance) returning the distance to keep searching up to.
+		// Returning the distance of an accepted hit terminates once nothing nearer remains, returning the distance passed in visits every hit.
+		//@param p_max_distance Nodes and items entered beyond this distance along p_ray are skipped.
+		template <typename Visitor>
+		void traverse(const Ray& p_ray, Visitor&& p_visitor, float p_max_distance = Max_distance) const
+		{
+			if (m_nodes.empty())
+				return;
+
+			const auto slab = RaySlab(p_ray);
+			std::array<std::pair<uint32_t, float>, Max_depth> stack; // Node index and the distance p_ray enters it.
+			size_t stack_size = 0;
+			float entry = 0.f;
+			if (slab.intersect(m_nodes[0].bounds, entry))
+				stack[stack_size++] = {0, entry};
+
+			while (stack_size > 0)
+			{
+				const auto [node_index, node_entry] = stack[--stack_size];
+				if (node_entry > p_max_distance)
+					continue; // p_max_distance has shrunk since the node was pushed.
+
+				const auto& node = m_nodes[node_index];
+				if (node.is_leaf())
+				{
+					for (uint32_t i = node.first; i < node.first + node.count; i++)
+					{
+						const auto item = m_item_indices[i];
+						if (slab.intersect(m_item_bounds[item], entry) && entry <= p_max_distance)
+							p_max_distance = p_visitor(static_cast<size_t>(item), entry);
+					}
+				}
+				else
+				{
+					float left_entry  = 0.f;
+					float right_entry = 0.f;
+					const bool hit_left  = slab.intersect(m_nodes[node.first].bounds, left_entry)      && left_entry  <= p_max_distance;
+					const bool hit_right = slab.intersect(m_nodes[node.first + 1].bounds, right_entry) && right_entry <= p_max_distance;
+
+					if (hit_left && hit_right)
+					{// Push the far child first so the near child is visited first.
+						if (left_entry <= right_entry)
+						{
+							stack[stack_size++] = {node.first + 1, right_entry};
+							stack[stack_size++] = {node.first, left_entry};
+						}
+						else
+						{
+							stack[stack_size++] = {node.first, left_entry};
+							stack[stack_size++] = {node.first + 1, right_entry};
+						}
+					}
+					else if (hit_left)
+						stack[stack_size++] = {node.first, left_entry};
+					else if (hit_right)
+						stack[stack_size++] = {node.first + 1, right_entry};
+				}
+			}
+		}
+
+		// Visit the items each ray of p_rays intersects sharing the node tests between the rays.
+		// Suited to coherent rays such as a picking region or a line-of-sight fan where most nodes are hit or missed by all rays together.
+		//@param p_max_distances Per ray of p_rays, the distance to search up to, updated with the value returned by p_visitor.
+		//@param p_visitor Called with (ray index, item index, entry distance) returning the distance to keep searching up to for that ray.
+		template <typename Visitor>
+		void traverse(std::span<const Ray> p_rays, std::span<float> p_max_distances, Visitor&& p_visitor) const
+		{
+			ASSERT_THROW(p_rays.size() == p_max_distances.size(), "[BVH] Packet traversal expects a max distance per ray.");
+			if (m_nodes.empty() || p_rays.empty())
+				return;
+
+			std::vector<RaySlab> slabs;
+			slabs.reserve(p_rays.size());
+			for (const auto& ray : p_rays)
+				slabs.emplace_back(ray);
+
+			// A node is visited if any ray in the packet enters it before its max distance.
+			auto any_ray_intersects = [&](const AABB& p_bounds)
+			{
+				float entry = 0.f;
+				for (size_t r = 0; r < slabs.size(); r++)
+				{
+					if (slabs[r].intersect(p_bounds, entry) && entry <= p_max_distances[r])
+						return true;
+				}
+				return false;
+			};
+
+			// Children are ordered by the first ray of the packet, coherent rays share the same near child.
+			const auto& lead_slab = slabs.front();
+			std::array<uint32_t, Max_depth> stack;
+			size_t stack_size = 0;
+			if (any_ray_intersects(m_nodes[0].bounds))
+				stack[stack_size++] = 0;
+
+			while (stack_size > 0)
+			{
+				const auto& node = m_nodes[stack[--stack_size]];
+				if (!any_ray_intersects(node.bounds))
+					continue;
+
+				if (node.is_leaf())
+				{
+					for (uint32_t i = node.first; i < node.first + node.count; i++)
+					{
+						const auto item = m_item_indices[i];
+						for (size_t r = 0; r < slabs.size(); r++)
+						{
+							float entry = 0.f;
+							if (slabs[r].intersect(m_item_bounds[item], entry) && entry <= p_max_distances[r])
+								p_max_distances[r] = p_visitor(r, static_cast<size_t>(item), entry);
+						}
+					}
+				}
+				else
+				{
+					float left_entry  = Max_distance;
+					float right_entry = Max_distance;
+					lead_slab.intersect(m_nodes[node.first].bounds, left_entry);
+					lead_slab.intersect(m_nodes[node.first + 1].bounds, right_entry);
+
+					const bool left_first = left_entry <= right_entry;
+					stack[stack_size++] = left_first ? node.first + 1 : node.first;
+					stack[stack_size++] = left_first ? node.first : node.first + 1;
+				}
+			}
+		}
+
+		// Visit the pairs of items of this and p_other whose AABBs overlap, descending both trees together so only overlapping nodes are opened.
+		//@param p_overlaps Called with (AABB in this, AABB in p_other) returning if they overlap, allowing p_other to be in another space.
+		//@param p_visitor Called with (item index in this, item index in p_other) returning false to end the traversal.
+		template <typename Overlaps, typename Visitor>
+		void traverse(const BVH& p_other, Overlaps&& p_overlaps, Visitor&& p_visitor) const
+		{
+			if (m_nodes.empty() || p_other.m_nodes.empty() || !p_overlaps(m_nodes[0].bounds, p_other.m_nodes[0].bounds))
+				return;
+
+			// Every pair popped pushes at most two, descending one side, bounding the stack by the sum of the depths.
+			std::array<std::pair<uint32_t, uint32_t>, Max_depth * 2> stack;
+			size_t stack_size = 0;
+			stack[stack_size++] = {0, 0};
+
+			while (stack_size > 0)
+			{
+				const auto [node_index, other_node_index] = stack[--stack_size];
+				const auto& node       = m_nodes[node_index];
+				const auto& other_node = p_other.m_nodes[other_node_index];
+
+				if (node.is_leaf() && other_node.is_leaf())
+				{
+					for (uint32_t i = node.first; i < node.first + node.count; i++)
+					{
+						const auto item = m_item_indices[i];
+						for (uint32_t j = other_node.first; j < other_node.first + other_node.count; j++)
+						{
+							const auto other_item = p_other.m_item_indices[j];
+							if (p_overlaps(m_item_bounds[item], p_other.m_item_bounds[other_item]) && !p_visitor(static_cast<size_t>(item), static_cast<size_t>(other_item)))
+								return;
+						}
+					}
+				}
+				else
+				{// Descend the larger node, or the only internal one, pairing its children with the other node.
+					auto extent = [](const AABB& p_bounds) { const auto size = p_bounds.get_size(); return size.x + size.y + size.z; };
+					const bool descend_this = other_node.is_leaf() || (!node.is_leaf() && extent(node.bounds) >= extent(other_node.bounds));
+					for (uint32_t child = 0; child < 2; child++)
+					{
+						if (descend_this)
+						{
+							if (p_overlaps(m_nodes[node.first + child].bounds, other_node.bounds))
+								stack[stack_size++] = {node.first + child, other_node_index};
+						}
+						else if (p_overlaps(node.bounds, p_other.m_nodes[other_node.first + child].bounds))
+							stack[stack_size++] = {node_index, other_node.first + child};
+					}
+				}
+			}
+		}
+
+	private:
+		// Deeper than this the build falls back to splitting at the median item which bounds the depth to log2 of the item count.
+		static constexpr size_t SAH_depth_limit = 32;
+		static constexpr size_t Max_depth       = SAH_depth_limit + 32;
+
+		// A Ray prepared for repeated slab tests against AABBs.
+		struct RaySlab
+		{
+			glm::vec3 start;
+			glm::vec3 inverse_direction;
+			std::array<bool, 3> parallel; // The ray is parallel to the slab of this axis.
+
+			explicit RaySlab(const Ray& p_ray);
+			// Matches get_intersection(AABB, Ray) returning the distance the ray enters p_AABB in p_entry.
+			bool intersect(const AABB& p_AABB, float& p_entry) const;
+		};
+
+		std::vector<Node> m_nodes;
+		std::vector<uint32_t> m_item_indices; // Item indices ordered so each leaf covers a contiguous range.
+		std::vector<AABB> m_item_bounds;      // The AABB of each item by item index.
+
+		void build(uint32_t p_node, uint32_t p_first, uint32_t p_count, size_t p_depth, uint32_t p_max_leaf_size, const std::vector<glm::vec3>& p_centroids);
+	};
+} // namespace Geometry
\ No newline at end of file
@@ -0,0 +1,351 @@
+#include "ConvexHull.hpp"
+
+#include "Utility/Logger.hpp"
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <unordered_set>
+
+namespace Geometry
+{
+	// A triangle of the hull under construction and the points outside of it yet to be processed.
+	struct HullFace
+	{
+		std::array<uint32_t, 3> indices;
+		glm::vec3 normal;
+		float distance;               // Distance of the face plane from the origin along normal.
+		std::vector<uint32_t> outside; // Indices of points in front of this face.
+		bool alive;
+
+		HullFace(uint32_t p_a, uint32_t p_b, uint32_t p_c, const std::vector<glm::vec3>& p_points)
+			: indices{p_a, p_b, p_c}
+			, normal{glm::normalize(glm::cross(p_points[p_b] - p_points[p_a], p_points[p_c] - p_points[p_a]))}
+			, distance{glm::dot(normal, p_points[p_a])}
+			, outside{}
+			, alive{true}
+		{}
+		float signed_distance(const glm::vec3& p_point) const { return glm::dot(normal, p_point) - distance; }
+	};
+	// Pack the directed edge p_from -> p_to into one key, the reversed edge has a different key.
+	static uint64_t edge_key(uint32_t p_from, uint32_t p_to)
+	{
+		return (static_cast<uint64_t>(p_from) << 32) | p_to;
+	}
+
+	ConvexHull::ConvexHull(const std::vector<glm::vec3>& p_points)
+		: m_vertices{}
+		, m_x{}
+		, m_y{}
+		, m_z{}
+		, m_triangles{}
+		, m_adjacency_offsets{}
+		, m_adjacency{}
+	{
+		// Incremental hull construction with outside sets as per Quickhull (Barber, Dobkin, Huhdanpaa).
+		// Starting from a tetrahedron of extreme points, the furthest outside point of each face is repeatedly added by removing every face it can see
+		// and connecting the horizon of the removed faces to it. Points are only ever retested against the faces replacing the face they were outside of.
+		if (p_points.size() < 4)
+		{
+			make_degenerate(p_points);
+			return;
+		}
+
+		// Tolerance scaled to the magnitude of the coordinates to absorb floating point error in the plane tests.
+		glm::vec3 max_abs = glm::vec3(0.f);
+		for (const auto& point : p_points)
+			max_abs = glm::max(max_abs, glm::abs(point));
+		const float epsilon = 3.f * std::numeric_limits<float>::epsilon() * (max_abs.x + max_abs.y + max_abs.z);
+
+		std::array<uint32_t, 4> tetrahedron = {0, 0, 0, 0};
+		{// Initial tetrahedron, the most distant pair of axis extremes followed by the points furthest from their line and then plane.
+			std::array<uint32_t, 3> min_index = {0, 0, 0};
+			std::array<uint32_t, 3> max_index = {0, 0, 0};
+			for (uint32_t i = 0; i < static_cast<uint32_t>(p_points.size()); i++)
+			{
+				for (int axis = 0; axis < 3; axis++)
+				{
+					if (p_points[i][axis] < p_points[min_index[axis]][axis]) min_index[axis] = i;
+					if (p_points[i][axis] > p_points[max_index[axis]][axis]) max_index[axis] = i;
+				}
+			}
+			float max_distance = -1.f;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				const float distance = glm::distance(p_points[min_index[axis]], p_points[max_index[axis]]);
+				if (distance > max_distance)
+				{
+					max_distance   = distance;
+					tetrahedron[0] = min_index[axis];
+					tetrahedron[1] = max_index[axis];
+				}
+			}
+			if (max_distance <= epsilon)
+			{
+				make_degenerate(p_points);
+				return;
+			}
+
+			const glm::vec3 line = p_points[tetrahedron[1]] - p_points[tetrahedron[0]];
+			max_distance = -1.f;
+			for (uint32_t i = 0; i < static_cast<uint32_t>(p_points.size()); i++)
+			{
+				const float distance = glm::length(glm::cross(p_points[i] - p_points[tetrahedron[0]], line));
+				if (distance > max_distance)
+				{
+					max_distance   = distance;
+					tetrahedron[2] = i;
+				}
+			}
+			if (max_distance <= epsilon * glm::length(line))
+			{
+				make_degenerate(p_points);
+				return;
+			}
+
+			const glm::vec3 normal = glm::normalize(glm::cross(line, p_points[tetrahedron[2]] - p_points[tetrahedron[0]]));
+			max_distance = -1.f;
+			for (uint32_t i = 0; i < static_cast<uint32_t>(p_points.size()); i++)
+			{
+				const float distance = std::abs(glm::dot(normal, p_points[i] - p_points[tetrahedron[0]]));
+				if (distance > max_distance)
+				{
+					max_distance   = distance;
+					tetrahedron[3] = i;
+				}
+			}
+			if (max_distance <= epsilon)
+			{
+				make_degenerate(p_points);
+				return;
+			}
+		}
+
+		std::vector<HullFace> faces;
+		{// Wind the tetrahedron faces so their normals point away from its centroid.
+			const glm::vec3 centroid = (p_points[tetrahedron[0]] + p_points[tetrahedron[1]] + p_points[tetrahedron[2]] + p_points[tetrahedron[3]]) / 4.f;
+			const std::array<std::array<uint32_t, 3>, 4> tetrahedron_faces = {{{0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2}}};
+			for (const auto& [a, b, c] : tetrahedron_faces)
+			{
+				HullFace face(tetrahedron[a], tetrahedron[b], tetrahedron[c], p_points);
+				if (face.signed_distance(centroid) > 0.f)
+					face = HullFace(tetrahedron[a], tetrahedron[c], tetrahedron[b], p_points);
+				faces.push_back(std::move(face));
+			}
+		}
+
+		// Assign each point to the outside set of the first face it is in front of, points behind every face are inside the hull.
+		const auto assign_outside = [&faces, &p_points, epsilon](uint32_t p_point, size_t p_first_face)
+		{
+			for (size_t f = p_first_face; f < faces.size(); f++)
+			{
+				if (faces[f].alive && faces[f].signed_distance(p_points[p_point]) > epsilon)
+				{
+					faces[f].outside.push_back(p_point);
+					return;
+				}
+			}
+		};
+		for (uint32_t i = 0; i < static_cast<uint32_t>(p_points.size()); i++)
+		{
+			if (std::find(tetrahedron.begin(), tetrahedron.end(), i) == tetrahedron.end())
+				assign_outside(i, 0);
+		}
+
+		std::vector<std::pair<uint32_t, uint32_t>> visible_edges;
+		std::unordered_set<uint64_t> visible_edge_keys;
+		std::vector<uint32_t> orphaned_points;
+		// New faces are appended as we go, so a single pass visits every face that is ever created.
+		for (size_t f = 0; f < faces.size(); f++)
+		{
+			if (!faces[f].alive || faces[f].outside.empty())
+				continue;
+
+			const uint32_t eye = *std::max_element(faces[f].outside.begin(), faces[f].outside.end(), [&](const uint32_t& p_a, const uint32_t& p_b)
+				{ return faces[f].signed_distance(p_points[p_a]) < faces[f].signed_distance(p_points[p_b]); });
+
+			// Remove every face the eye point can see, keeping their edges and outside points.
+			visible_edges.clear();
+			orphaned_points.clear();
+			for (auto& face : faces)
+			{
+				if (face.alive && face.signed_distance(p_points[eye]) > epsilon)
+				{
+					face.alive = false;
+					visible_edges.emplace_back(face.indices[0], face.indices[1]);
+					visible_edges.emplace_back(face.indices[1], face.indices[2]);
+					visible_edges.emplace_back(face.indices[2], face.indices[0]);
+					for (const auto& point : face.outside)
+					{
+						if (point != eye)
+							orphaned_points.push_back(point);
+					}
+					face.outside.clear();
+					face.outside.shrink_to_fit();
+				}
+			}
+
+			// The horizon is the boundary of the visible region, edges whose neighbouring face was not removed.
+			// Neighbouring faces wind their shared edge in opposite directions, an edge is on the horizon if its reverse was not removed.
+			// Connecting each horizon edge to the eye in the same winding keeps the new faces pointing outward.
+			visible_edge_keys.clear();
+			for (const auto& [a, b] : visible_edges)
+				visible_edge_keys.insert(edge_key(a, b));
+
+			const size_t first_new_face = faces.size();
+			for (const auto& [a, b] : visible_edges)
+			{
+				if (!visible_edge_keys.contains(edge_key(b, a)))
+					faces.emplace_back(a, b, eye, p_points);
+			}
+
+			for (const auto& point : orphaned_points)
+				assign_outside(point, first_new_face);
+		}
+
+		{// Compact the surviving faces into the hull, keeping vertices in the order of the input points.
+			std::vector<uint32_t> remap(p_points.size(), std::numeric_limits<uint32_t>::max());
+			for (const auto& face : faces)
+			{
+				if (face.alive)
+				{
+					for (const auto& index : face.indices)
+						remap[index] = 0;
+				}
+			}
+			for (uint32_t i = 0; i < static_cast<uint32_t>(p_points.size()); i++)
+			{
+				if (remap[i] == 0)
+				{
+					remap[i] = static_cast<uint32_t>(m_vertices.size());
+					m_vertices.push_back(p_points[i]);
+				}
+			}
+
+			std::vector<std::vector<uint32_t>> neighbours(m_vertices.size());
+			for (const auto& face : faces)
+			{
+				if (!face.alive)
+					continue;
+
+				for (size_t i = 0; i < 3; i++)
+				{
+					const auto a = remap[face.indices[i]];
+					const auto b = remap[face.indices[(i + 1) % 3]];
+					m_triangles.push_back(a);
+					neighbours[a].push_back(b);
+					neighbours[b].push_back(a);
+				}
+			}
+
+			m_adjacency_offsets.reserve(m_vertices.size() + 1);
+			for (auto& vertex_neighbours : neighbours)
+			{
+				std::sort(vertex_neighbours.begin(), vertex_neighbours.end());
+				vertex_neighbours.erase(std::unique(vertex_neighbours.begin(), vertex_neighbours.end()), vertex_neighbours.end());
+				m_adjacency_offsets.push_back(static_cast<uint32_t>(m_adjacency.size()));
+				m_adjacency.insert(m_adjacency.end(), vertex_neighbours.begin(), vertex_neighbours.end());
+			}
+			m_adjacency_offsets.push_back(static_cast<uint32_t>(m_adjacency.size()));
+		}
+
+		make_linear_search_layout();
+	}
+
+	void ConvexHull::make_degenerate(const std::vector<glm::vec3>& p_points)
+	{
+		m_vertices.clear();
+		for (const auto& point : p_points)
+		{
+			if (std::find(m_vertices.begin(), m_vertices.end(), point) == m_vertices.end())
+				m_vertices.push_back(point);
+		}
+
+		m_adjacency_offsets.clear();
+		m_adjacency.clear();
+		for (uint32_t i = 0; i < static_cast<uint32_t>(m_vertices.size()); i++)
+		{
+			m_adjacency_offsets.push_back(static_cast<uint32_t>(m_adjacency.size()));
+			for (uint32_t j = 0; j < static_cast<uint32_t>(m_vertices.size()); j++)
+			{
+				if (i != j)
+					m_adjacency.push_back(j);
+			}
+		}
+		m_adjacency_offsets.push_back(static_cast<uint32_t>(m_adjacency.size()));
+
+		make_linear_search_layout();
+	}
+
+	void ConvexHull::make_linear_search_layout()
+	{
+		if (m_vertices.size() > Linear_search_vertex_limit)
+			return;
+
+		m_x.resize(m_vertices.size());
+		m_y.resize(m_vertices.size());
+		m_z.resize(m_vertices.size());
+		for (size_t i = 0; i < m_vertices.size(); i++)
+		{
+			m_x[i] = m_vertices[i].x;
+			m_y[i] = m_vertices[i].y;
+			m_z[i] = m_vertices[i].z;
+		}
+	}
+
+	std::span<const uint32_t> ConvexHull::neighbours(size_t p_vertex) const
+	{
+		return std::span<const uint32_t>(m_adjacency.data() + m_adjacency_offsets[p_vertex], m_adjacency.data() + m_adjacency_offsets[p_vertex + 1]);
+	}
+
+	size_t ConvexHull::support_index(const glm::vec3& p_direction, size_t p_start_vertex) const
+	{
+		ASSERT_THROW(!m_vertices.empty(), "[CONVEXHULL] Empty hull in support_index func.");
+
+		if (!m_x.empty())
+		{
+			size_t furthest        = 0;
+			float furthest_distance = std::numeric_limits<float>::lowest();
+			for (size_t i = 0; i < m_x.size(); i++)
+			{
+				const float distance = p_direction.x * m_x[i] + p_direction.y * m_y[i] + p_direction.z * m_z[i];
+				if (distance > furthest_distance)
+				{
+					furthest_distance = distance;
+					furthest          = i;
+				}
+			}
+			return furthest;
+		}
+
+		size_t current         = p_start_vertex < m_vertices.size() ? p_start_vertex : 0;
+		float current_distance = glm::dot(p_direction, m_vertices[current]);
+
+		while (true) // Move to the furthest neighbour along p_direction until no neighbour improves, distance strictly increases so this terminates.
+		{
+			size_t furthest = current;
+			for (const auto& neighbour : neighbours(current))
+			{
+				const float distance = glm::dot(p_direction, m_vertices[neighbour]);
+				if (distance > current_distance)
+				{
+					current_distance = distance;
+					furthest         = neighbour;
+				}
+			}
+
+			if (furthest == current)
+				return current;
+
+			current = furthest;
+		}
+	}
+
+	glm::vec3 ConvexHull::support_point(const glm::vec3& p_direction, size_t& io_vertex) const
+	{
+		io_vertex = support_index(p_direction, io_vertex);
+		return m_vertices[io_vertex];
+	}
+} // namespace Geometry
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "glm/vec3.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Geometry
+{
+	// The convex hull of a point set stored as its vertices and the edges connecting them.
+	// Vertex adjacency allows support queries to hill-climb across the hull surface instead of testing every point.
+	class ConvexHull
+	{
+	public:
+		ConvexHull() = default;
+		// Construct the convex hull of p_points, points on or inside the hull surface are discarded.
+		// Degenerate point sets (fewer than 4 points or all coplanar) keep every unique point, each adjacent to all others.
+		explicit ConvexHull(const std::vector<glm::vec3>& p_points);
+
+		const std::vector<glm::vec3>& vertices() const { return m_vertices; }
+		// Triangles of the hull as triplets of indices into vertices(), wound counter-clockwise viewed from outside. Empty if degenerate.
+		const std::vector<uint32_t>& triangles() const { return m_triangles; }
+		// Indices into vertices() of the vertices sharing an edge with p_vertex.
+		std::span<const uint32_t> neighbours(size_t p_vertex) const;
+		bool empty() const { return m_vertices.empty(); }
+		// The bytes of the vertices, their per-axis copies, the triangles and the adjacency.
+		size_t memory_size() const
+		{
+			return m_vertices.size() * sizeof(glm::vec3) + (m_x.size() + m_y.size() + m_z.size()) * sizeof(float)
+				+ (m_triangles.size() + m_adjacency_offsets.size() + m_adjacency.size()) * sizeof(uint32_t);
+		}
+
+		// Find the vertex furthest in p_direction by hill-climbing from p_start_vertex to the neighbour furthest in p_direction until none are further.
+		// On a convex hull a vertex with no neighbour further along p_direction is a global maximum.
+		// Starting from the answer to a query in a similar direction, e.g. the previous tick or GJK iteration, only a few vertices are visited.
+		// Hulls of up to Linear_search_vertex_limit vertices are instead scanned in full over contiguous per-axis arrays which vectorise
+		// and avoid the branching of the climb.
+		//@param p_direction The direction to search in. Doesn't have to be normalized since we only care about direction.
+		//@param p_start_vertex Index into vertices() to start climbing from.
+		//@returns Index into vertices() of the support vertex.
+		size_t support_index(const glm::vec3& p_direction, size_t p_start_vertex = 0) const;
+		// Find the vertex furthest in p_direction, starting from and updating io_vertex to the vertex found for use in the next query.
+		glm::vec3 support_point(const glm::vec3& p_direction, size_t& io_vertex) const;
+
+		static constexpr size_t Linear_search_vertex_limit = 32;
+
+	private:
+		std::vector<glm::vec3> m_vertices;
+		std::vector<float> m_x; // }
+		std::vector<float> m_y; // |> Per-axis copies of m_vertices for the linear support search of small hulls.
+		std::vector<float> m_z; // }
+		std::vector<uint32_t> m_triangles;
+		std::vector<uint32_t> m_adjacency_offsets; // Offset of each vertex's neighbour list in m_adjacency. Size is vertex count + 1.
+		std::vector<uint32_t> m_adjacency;         // Neighbour lists of every vertex concatenated.
+
+		// Fallback for point sets with no volume, every unique point is kept and adjacent to every other.
+		void make_degenerate(const std::vector<glm::vec3>& p_points);
+		// Fill m_x, m_y and m_z from m_vertices if the hull is small enough to be searched linearly.
+		void make_linear_search_layout();
+	};
+} // namespace Geometry
\ No newline at end of file
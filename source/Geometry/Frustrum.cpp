@@ -1,9 +1,28 @@
 #include "Frustrum.hpp"
+#include "AABB.hpp"
 
+#include "Utility/Logger.hpp"
+
+#include "glm/glm.hpp"
 #include "glm/mat4x4.hpp"
 
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define Z_FRUSTRUM_SSE
+	#include <emmintrin.h>
+#endif
+
 namespace Geometry
 {
+	// Is p_AABB entirely behind p_plane, tested at its corner furthest along the plane normal (the positive vertex).
+	static bool outside(const glm::vec4& p_plane, const AABB& p_AABB)
+	{
+		const auto positive_vertex = glm::vec3(p_plane.x >= 0.f ? p_AABB.m_max.x : p_AABB.m_min.x, p_plane.y >= 0.f ? p_AABB.m_max.y : p_AABB.m_min.y, p_plane.z >= 0.f ? p_AABB.m_max.z : p_AABB.m_min.z);
+		return glm::dot(glm::vec3(p_plane), positive_vertex) + p_plane.w < 0.f;
+	}
+
 	Frustrum::Frustrum(const glm::mat4& p_projection) noexcept
 		: m_left{  glm::vec4{p_projection[0][3] + p_projection[0][0], p_projection[1][3] + p_projection[1][0], p_projection[2][3] + p_projection[2][0], p_projection[3][3] + p_projection[3][0]}}
 		, m_right{ glm::vec4{p_projection[0][3] - p_projection[0][0], p_projection[1][3] - p_projection[1][0], p_projection[2][3] - p_projection[2][0], p_projection[3][3] - p_projection[3][0]}}
@@ -20,4 +39,102 @@ namespace Geometry
 		m_near.normalise();
 		m_far.normalise();
 	}
+
+	std::array<glm::vec4, 6> Frustrum::inside_plane_equations() const
+	{
+		return {
+			glm::vec4(m_left.m_normal,    m_left.m_distance),
+			glm::vec4(m_right.m_normal,   m_right.m_distance),
+			glm::vec4(m_bottom.m_normal,  m_bottom.m_distance),
+			glm::vec4(m_top.m_normal,     m_top.m_distance),
+			glm::vec4(-m_near.m_normal,  -m_near.m_distance),
+			glm::vec4(-m_far.m_normal,   -m_far.m_distance)};
+	}
+
+	size_t Frustrum::cull(std::span<const AABB> p_AABBs, std::span<uint8_t> io_plane_cache, std::span<uint8_t> out_visible) const
+	{
+		ASSERT_THROW(io_plane_cache.size() == p_AABBs.size() && out_visible.size() == p_AABBs.size(), "[FRUSTRUM] Culling expects a plane cache and visibility output per AABB.");
+
+		const auto planes = inside_plane_equations();
+		size_t visible_count = 0;
+		size_t i = 0;
+#ifdef Z_FRUSTRUM_SSE
+		// Each lane holds one of four AABBs so every plane is tested against all four at once.
+		// The positive vertex and distance are computed in the same order as outside() so both paths agree on AABBs touching a plane.
+		static_assert(sizeof(AABB) == sizeof(float) * 6 && offsetof(AABB, m_min) == 0 && offsetof(AABB, m_max) == sizeof(float) * 3, "Frustrum::cull loads AABBs as 6 packed floats.");
+		auto distance = [](__m128 p_x, __m128 p_y, __m128 p_z, __m128 p_a, __m128 p_b, __m128 p_c, __m128 p_d)
+		{
+			return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p_a, p_x), _mm_mul_ps(p_b, p_y)), _mm_mul_ps(p_c, p_z)), p_d);
+		};
+		// Per lane, p_max where p_coefficient is non-negative and p_min otherwise.
+		auto select = [](__m128 p_coefficient, __m128 p_min, __m128 p_max)
+		{
+			const __m128 positive = _mm_cmpge_ps(p_coefficient, _mm_setzero_ps());
+			return _mm_or_ps(_mm_and_ps(positive, p_max), _mm_andnot_ps(positive, p_min));
+		};
+		const __m128 zero = _mm_setzero_ps();
+
+		for (; i + 4 <= p_AABBs.size(); i += 4)
+		{
+			// Transpose the four AABBs into a register per component. Loading (min x, min y, min z, max x) and (min z, max x, max y, max z)
+			// keeps both loads within each AABB.
+			const float* AABB_data = &p_AABBs[i].m_min.x;
+			__m128 min_x          = _mm_loadu_ps(AABB_data),     min_y = _mm_loadu_ps(AABB_data + 6), min_z = _mm_loadu_ps(AABB_data + 12), repeated_max_x = _mm_loadu_ps(AABB_data + 18);
+			__m128 repeated_min_z = _mm_loadu_ps(AABB_data + 2), max_x = _mm_loadu_ps(AABB_data + 8), max_y = _mm_loadu_ps(AABB_data + 14), max_z = _mm_loadu_ps(AABB_data + 20);
+			_MM_TRANSPOSE4_PS(min_x, min_y, min_z, repeated_max_x);
+			_MM_TRANSPOSE4_PS(repeated_min_z, max_x, max_y, max_z);
+
+			// Every lane is first tested against its own cached plane, transposing the four plane equations into a register per coefficient.
+			for (size_t lane = 0; lane < 4; lane++)
+				io_plane_cache[i + lane] = std::min<uint8_t>(io_plane_cache[i + lane], 5);
+			__m128 a = _mm_loadu_ps(&planes[io_plane_cache[i]].x),     b = _mm_loadu_ps(&planes[io_plane_cache[i + 1]].x);
+			__m128 c = _mm_loadu_ps(&planes[io_plane_cache[i + 2]].x), d = _mm_loadu_ps(&planes[io_plane_cache[i + 3]].x);
+			_MM_TRANSPOSE4_PS(a, b, c, d);
+			__m128 outside_mask = _mm_cmplt_ps(distance(select(a, min_x, max_x), select(b, min_y, max_y), select(c, min_z, max_z), a, b, c, d), zero);
+
+			// The lanes still visible are tested against every plane until all four are rejected.
+			for (size_t p = 0; p < planes.size() && _mm_movemask_ps(outside_mask) != 0xF; p++)
+			{
+				const auto& plane = planes[p];
+				const __m128 distances = distance(
+					plane.x >= 0.f ? max_x : min_x, plane.y >= 0.f ? max_y : min_y, plane.z >= 0.f ? max_z : min_z,
+					_mm_set1_ps(plane.x), _mm_set1_ps(plane.y), _mm_set1_ps(plane.z), _mm_set1_ps(plane.w));
+				const __m128 rejected = _mm_andnot_ps(outside_mask, _mm_cmplt_ps(distances, zero));
+				if (const int rejected_lanes = _mm_movemask_ps(rejected); rejected_lanes != 0)
+				{
+					for (size_t lane = 0; lane < 4; lane++)
+					{
+						if (rejected_lanes & (1 << lane))
+							io_plane_cache[i + lane] = static_cast<uint8_t>(p);
+					}
+					outside_mask = _mm_or_ps(outside_mask, rejected);
+				}
+			}
+
+			const int outside_lanes = _mm_movemask_ps(outside_mask);
+			for (size_t lane = 0; lane < 4; lane++)
+			{
+				out_visible[i + lane] = (outside_lanes & (1 << lane)) ? 0 : 1;
+				visible_count += out_visible[i + lane];
+			}
+		}
+#endif
+		for (; i < p_AABBs.size(); i++)
+		{
+			io_plane_cache[i] = std::min<uint8_t>(io_plane_cache[i], 5);
+			const uint8_t cached = io_plane_cache[i];
+			bool visible = !outside(planes[cached], p_AABBs[i]);
+			for (uint8_t p = 0; p < planes.size() && visible; p++)
+			{
+				if (p != cached && outside(planes[p], p_AABBs[i]))
+				{
+					io_plane_cache[i] = p;
+					visible = false;
+				}
+			}
+			out_visible[i] = visible ? 1 : 0;
+			visible_count += visible;
+		}
+		return visible_count;
+	}
 }
\ No newline at end of file
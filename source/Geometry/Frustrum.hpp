@@ -4,9 +4,16 @@
 
 #include "glm/fwd.hpp"
 #include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
 
 namespace Geometry
 {
+	class AABB;
+
 	// Frustrum represnts a portion of space bounded by 6 planes.
 	// By convention the plane normal's point inside the bounded volume/frustrum.
 	class Frustrum
@@ -21,5 +28,18 @@ namespace Geometry
 
 		// Construct a frustrum from a projection matrix. p_projection is expected to be using right-handed system.
 		Frustrum(const glm::mat4& p_projection) noexcept;
+
+		// The six planes as equations (a, b, c, d) where a point p is inside the frustrum if dot(abc, p) + d >= 0 for every plane.
+		// The left, right, bottom and top planes are stored this way. The near and far planes are stored with their normal and distance
+		// negated, which leaves them facing out of the frustrum, so they are flipped back here.
+		std::array<glm::vec4, 6> inside_plane_equations() const;
+
+		// Test every one of p_AABBs against the frustrum, matching intersecting(Frustrum, AABB) per AABB.
+		// Four AABBs are tested at once in SSE lanes when available, otherwise one at a time.
+		//@param io_plane_cache Per AABB, the index [0-5] of the plane that last rejected it. Tested first and updated on rejection, so AABBs
+		// staying outside the same plane between frames are rejected with one plane test. Zero initialise when the AABBs are first culled.
+		//@param out_visible Per AABB, set to 1 if it intersects the frustrum and 0 if not.
+		//@returns The number of visible AABBs.
+		size_t cull(std::span<const AABB> p_AABBs, std::span<uint8_t> io_plane_cache, std::span<uint8_t> out_visible) const;
 	};
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "GJK.hpp"
+#include "ConvexHull.hpp"
 #include "Intersect.hpp"
 #include "Triangle.hpp"
 
@@ -56,6 +57,19 @@ namespace GJK
 		return mesh_1_support_point_world_space - mesh_2_support_point_world_space;
 	}
 
+	glm::vec3 support_point(const glm::vec3& p_direction,
+	                        const Geometry::ConvexHull& p_hull_1, const glm::mat4& p_transform_1, const glm::quat& p_inverse_orientation_1,
+	                        const Geometry::ConvexHull& p_hull_2, const glm::mat4& p_transform_2, const glm::quat& p_inverse_orientation_2,
+	                        SupportCache& p_cache)
+	{
+		const auto mesh_1_support_point_object_space = p_hull_1.support_point(  p_inverse_orientation_1 * p_direction,  p_cache.vertex_1);
+		const auto mesh_2_support_point_object_space = p_hull_2.support_point(-(p_inverse_orientation_2 * p_direction), p_cache.vertex_2);
+		const auto mesh_1_support_point_world_space  = p_transform_1 * glm::vec4(mesh_1_support_point_object_space, 1.f);
+		const auto mesh_2_support_point_world_space  = p_transform_2 * glm::vec4(mesh_2_support_point_object_space, 1.f);
+
+		return mesh_1_support_point_world_space - mesh_2_support_point_world_space;
+	}
+
 	bool do_simplex(Simplex& p_simplex, glm::vec3& p_direction)
 	{
 		// Purpose of the do_simplex function is to iteratively construct a simplex that encloses the origin.
@@ -94,6 +108,17 @@ namespace GJK
 			if (same_direction(AB, AO)) // If origin is in the direction of AB we are in region 1.
 			{
 				p_direction = glm::cross(glm::cross(AB, AO), AB); // Return the direction perpendicular to AB in the direction of the origin.
+
+				// The origin lies on AB, e.g. for shapes overlapping along an axis they're aligned to, so there is no perpendicular towards it.
+				// Any perpendicular continues towards a triangle around the origin, cross AB with the axis it is least aligned to.
+				if (p_direction == glm::vec3(0.f))
+				{
+					const auto abs_AB = glm::abs(AB);
+					const auto axis   = abs_AB.x <= abs_AB.y && abs_AB.x <= abs_AB.z ? glm::vec3(1.f, 0.f, 0.f)
+					                  : abs_AB.y <= abs_AB.z                          ? glm::vec3(0.f, 1.f, 0.f)
+					                                                                  : glm::vec3(0.f, 0.f, 1.f);
+					p_direction = glm::cross(AB, axis);
+				}
 			}
 			else // The origin is in region 2, beyond vertex A.
 			{// We revert to a point case A, returning the direction as A to origin.
@@ -228,34 +253,62 @@ namespace GJK
 		}
 	}
 
-	bool intersecting(const std::vector<glm::vec3>& p_points_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
-	                  const std::vector<glm::vec3>& p_points_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2,
-	                  const glm::vec3& p_initial_direction)
+	// The GJK loop shared by the point set and ConvexHull overloads of intersecting.
+	//@param p_support Callable returning the support point of the Minkowski difference in a world space direction.
+	//@param p_simplex Out: the simplex enclosing the origin if intersecting.
+	//@param p_direction Out: a separating axis if not intersecting.
+	template <typename SupportFunc>
+	bool run_GJK(const SupportFunc& p_support, const glm::vec3& p_initial_direction, Simplex& p_simplex, glm::vec3& p_direction)
 	{
-		glm::vec3 direction = p_initial_direction;
-		Simplex simplex = {support_point(direction,
-		                                 p_points_1, p_transform_1, p_orientation_1,
-		                                 p_points_2, p_transform_2, p_orientation_2)};
-		direction = -simplex[0]; // AO, search in the direction of the origin. Reversed direction to point towards the origin.
+		p_direction = p_initial_direction;
+		p_simplex   = {p_support(p_direction)};
+		p_direction = -p_simplex[0]; // AO, search in the direction of the origin. Reversed direction to point towards the origin.
 
 		while (true) // Main GJK loop. Converge on A simplex that encloses the origin.
 		{
-			auto new_support_point = support_point(direction,
-			                                       p_points_1, p_transform_1, p_orientation_1,
-			                                       p_points_2, p_transform_2, p_orientation_2);
+			auto new_support_point = p_support(p_direction);
 
 			// If the new support point is not past the origin then its impossible to enclose the origin.
-			if (glm::dot(new_support_point, direction) <= 0.f)
+			if (glm::dot(new_support_point, p_direction) <= 0.f)
 				return false;
 
 			// Shift the simplex points along to retain A as the most recently added support point as do_simplex expects.
-			simplex.push_front(new_support_point);
+			p_simplex.push_front(new_support_point);
 
-			if (do_simplex(simplex, direction))
+			if (do_simplex(p_simplex, p_direction))
 				return true;
 		}
 	}
 
+	bool intersecting(const std::vector<glm::vec3>& p_points_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
+	                  const std::vector<glm::vec3>& p_points_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2,
+	                  const glm::vec3& p_initial_direction)
+	{
+		Simplex simplex;
+		glm::vec3 direction;
+		return run_GJK([&](const glm::vec3& p_direction)
+		{
+			return support_point(p_direction, p_points_1, p_transform_1, p_orientation_1, p_points_2, p_transform_2, p_orientation_2);
+		}, p_initial_direction, simplex, direction);
+	}
+
+	bool intersecting(const Geometry::ConvexHull& p_hull_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
+	                  const Geometry::ConvexHull& p_hull_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2,
+	                  const glm::vec3& p_initial_direction, SupportCache* p_cache)
+	{
+		SupportCache local_cache;
+		auto& cache = p_cache ? *p_cache : local_cache;
+
+		const auto inverse_orientation_1 = glm::inverse(p_orientation_1);
+		const auto inverse_orientation_2 = glm::inverse(p_orientation_2);
+		Simplex simplex;
+		glm::vec3 direction;
+		return run_GJK([&](const glm::vec3& p_direction)
+		{
+			return support_point(p_direction, p_hull_1, p_transform_1, inverse_orientation_1, p_hull_2, p_transform_2, inverse_orientation_2, cache);
+		}, p_initial_direction, simplex, direction);
+	}
+
 	// Tests if the reverse of an edge already exists in the list and if so, removes it.
 	void add_if_unique_edge(std::vector<std::pair<unsigned int, unsigned int>>& edges, const std::vector<unsigned int>& faces, unsigned int a, unsigned int b)
 	{
@@ -307,9 +360,10 @@ namespace GJK
 		return {face_normals, min_triangle};
 	}
 
-	CollisionPoint EPA(const Simplex& p_simplex,
-	                   const std::vector<glm::vec3>& p_points_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
-	                   const std::vector<glm::vec3>& p_points_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2)
+	// The EPA shared by the point set and ConvexHull overloads.
+	//@param p_support Callable returning the support point of the Minkowski difference in a world space direction.
+	template <typename SupportFunc>
+	CollisionPoint run_EPA(const Simplex& p_simplex, const SupportFunc& p_support, const glm::mat4& p_transform_1, const glm::mat4& p_transform_2)
 	{
 		if (p_simplex.size != 4)
 			throw std::runtime_error("[GJK] Invalid simplex size in EPA function. EPA expects incoming simplex to be a tetrahedron.");
@@ -330,9 +384,7 @@ namespace GJK
 			min_normal   = face_normals[min_face];
 			min_distance = face_normals[min_face].w;
 
-			glm::vec3 support = support_point(min_normal,
-			                                  p_points_1, p_transform_1, p_orientation_1,
-			                                  p_points_2, p_transform_2, p_orientation_2);
+			glm::vec3 support = p_support(min_normal);
 			float s_distance  = dot(min_normal, support);
 
 			if (std::abs(s_distance - min_distance) > 0.001f)
@@ -431,4 +483,90 @@ namespace GJK
 		point.penetration_depth = min_distance + 0.001f;
 		return point;
 	}
+
+	CollisionPoint EPA(const Simplex& p_simplex,
+	                   const std::vector<glm::vec3>& p_points_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
+	                   const std::vector<glm::vec3>& p_points_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2)
+	{
+		return run_EPA(p_simplex, [&](const glm::vec3& p_direction)
+		{
+			return support_point(p_direction, p_points_1, p_transform_1, p_orientation_1, p_points_2, p_transform_2, p_orientation_2);
+		}, p_transform_1, p_transform_2);
+	}
+
+	CollisionPoint EPA(const Simplex& p_simplex,
+	                   const Geometry::ConvexHull& p_hull_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
+	                   const Geometry::ConvexHull& p_hull_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2,
+	                   SupportCache* p_cache)
+	{
+		SupportCache local_cache;
+		auto& cache = p_cache ? *p_cache : local_cache;
+
+		const auto inverse_orientation_1 = glm::inverse(p_orientation_1);
+		const auto inverse_orientation_2 = glm::inverse(p_orientation_2);
+		return run_EPA(p_simplex, [&](const glm::vec3& p_direction)
+		{
+			return support_point(p_direction, p_hull_1, p_transform_1, inverse_orientation_1, p_hull_2, p_transform_2, inverse_orientation_2, cache);
+		}, p_transform_1, p_transform_2);
+	}
+
+	void intersecting(std::span<const HullPair> p_pairs, std::span<PairCache> p_caches, std::vector<size_t>& p_intersecting, std::vector<Simplex>& p_simplices)
+	{
+		if (p_pairs.size() != p_caches.size())
+			throw std::runtime_error("[GJK] Batched intersecting expects a cache per pair.");
+
+		p_intersecting.clear();
+		p_simplices.clear();
+
+		for (size_t i = 0; i < p_pairs.size(); i++)
+		{
+			const auto& pair = p_pairs[i];
+			auto& cache      = p_caches[i];
+			auto support     = [&](const glm::vec3& p_direction)
+			{
+				return support_point(p_direction, *pair.hull_1, pair.transform_1, pair.inverse_orientation_1, *pair.hull_2, pair.transform_2, pair.inverse_orientation_2, cache.support);
+			};
+
+			// Early-out: a separating axis from the last query still separating the pair needs no GJK loop.
+			const bool has_separating_axis = cache.separating_axis != glm::vec3(0.f);
+			if (has_separating_axis && glm::dot(support(cache.separating_axis), cache.separating_axis) <= 0.f)
+				continue;
+
+			auto initial_direction = has_separating_axis ? cache.separating_axis : glm::vec3(pair.transform_1[3] - pair.transform_2[3]);
+			if (initial_direction == glm::vec3(0.f))
+				initial_direction = glm::vec3(1.f, 0.f, 0.f);
+
+			Simplex simplex;
+			glm::vec3 direction;
+			if (run_GJK(support, initial_direction, simplex, direction))
+			{
+				cache.separating_axis = glm::vec3(0.f);
+				p_intersecting.push_back(i);
+				p_simplices.push_back(simplex);
+			}
+			else
+				cache.separating_axis = direction;
+		}
+	}
+
+	void EPA(std::span<const HullPair> p_pairs, std::span<const size_t> p_intersecting, std::span<const Simplex> p_simplices,
+	         std::span<PairCache> p_caches, std::vector<CollisionPoint>& p_collision_points)
+	{
+		if (p_intersecting.size() != p_simplices.size())
+			throw std::runtime_error("[GJK] Batched EPA expects a simplex per intersecting pair.");
+
+		p_collision_points.clear();
+		p_collision_points.reserve(p_intersecting.size());
+
+		for (size_t i = 0; i < p_intersecting.size(); i++)
+		{
+			const auto& pair = p_pairs[p_intersecting[i]];
+			auto& cache      = p_caches[p_intersecting[i]];
+
+			p_collision_points.push_back(run_EPA(p_simplices[i], [&](const glm::vec3& p_direction)
+			{
+				return support_point(p_direction, *pair.hull_1, pair.transform_1, pair.inverse_orientation_1, *pair.hull_2, pair.transform_2, pair.inverse_orientation_2, cache.support);
+			}, pair.transform_1, pair.transform_2));
+		}
+	}
 } // namespace GJK
\ No newline at end of file
@@ -2,12 +2,19 @@
 
 #include "glm/vec3.hpp"
 #include "glm/fwd.hpp"
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/quaternion.hpp"
 
 #include <array>
+#include <span>
 #include <vector>
 #include <initializer_list>
 #include <stdexcept>
 
+namespace Geometry
+{
+	class ConvexHull;
+}
 namespace GJK
 {
 	struct CollisionPoint
@@ -80,6 +87,29 @@ namespace GJK
 	                        const std::vector<glm::vec3>& p_points_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
 	                        const std::vector<glm::vec3>& p_points_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2);
 
+	// The support vertex of each ConvexHull found by the last query of a pair of shapes.
+	// Keeping a SupportCache per pair and passing it to every query of that pair, e.g. every physics tick, starts the hill-climbing
+	// in ConvexHull::support_index from the previous answer which is usually at or next to the new one.
+	struct SupportCache
+	{
+		size_t vertex_1 = 0;
+		size_t vertex_2 = 0;
+	};
+
+	// Given two convex hulls in object space, find the furthest point of their Minkowski difference in world space p_direction.
+	// Each hull is hill-climbed from and updates the vertices in p_cache, near O(1) per call when warm-started.
+	// Taking the inverse orientations lets callers making many queries invert each orientation once rather than per query.
+	//@param p_direction: The direction to search in world space. Doesn't have to be normalized since we only care about direction.
+	//@param p_hull_1,p_hull_2: The object-space convex hulls.
+	//@param p_transform_1,p_transform_2: The object->world space transform of the convex hulls.
+	//@param p_inverse_orientation_1,p_inverse_orientation_2 The inverse orientation of the convex hulls, rotating world space directions into object space.
+	//@param p_cache The support vertices to start from, updated to the support vertices found.
+	//@return The difference between the furthest point of the first hull and the furthest point of the second hull in world space.
+	glm::vec3 support_point(const glm::vec3& p_direction,
+	                        const Geometry::ConvexHull& p_hull_1, const glm::mat4& p_transform_1, const glm::quat& p_inverse_orientation_1,
+	                        const Geometry::ConvexHull& p_hull_2, const glm::mat4& p_transform_2, const glm::quat& p_inverse_orientation_2,
+	                        SupportCache& p_cache);
+
 	// Performs an iteration of the GJK algorithm on p_simplex.
 	// The p_simplex and p_direction are updated in place.
 	//@param p_simplex The simplex to update.
@@ -96,6 +126,11 @@ namespace GJK
 	bool intersecting(const std::vector<glm::vec3>& p_points_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
 	                  const std::vector<glm::vec3>& p_points_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2,
 	                  const glm::vec3& p_initial_direction = glm::vec3(1.f, 0.f, 0.f));
+	// ConvexHull overload of intersecting using hill-climbing support queries.
+	//@param p_cache Optional support vertices to warm-start from, updated with the last support vertices found. Reuse per pair across ticks.
+	bool intersecting(const Geometry::ConvexHull& p_hull_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
+	                  const Geometry::ConvexHull& p_hull_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2,
+	                  const glm::vec3& p_initial_direction = glm::vec3(1.f, 0.f, 0.f), SupportCache* p_cache = nullptr);
 
 	// Expanding Polytope Algorithm (EPA).
 	// Given two convex shapes defined by a set of points in object space, and their transforms and orientations, determine their collision point.
@@ -107,4 +142,47 @@ namespace GJK
 	CollisionPoint EPA(const Simplex& p_simplex,
 	                   const std::vector<glm::vec3>& p_points_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
 	                   const std::vector<glm::vec3>& p_points_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2);
+	// ConvexHull overload of EPA using hill-climbing support queries.
+	//@param p_cache Optional support vertices to warm-start from, pass the cache used by intersecting for the same pair.
+	CollisionPoint EPA(const Simplex& p_simplex,
+	                   const Geometry::ConvexHull& p_hull_1, const glm::mat4& p_transform_1, const glm::quat& p_orientation_1,
+	                   const Geometry::ConvexHull& p_hull_2, const glm::mat4& p_transform_2, const glm::quat& p_orientation_2,
+	                   SupportCache* p_cache = nullptr);
+
+	// A candidate pair of convex hulls for the batched intersecting and EPA functions.
+	// Pairs hold the inverse orientations so a caller testing a shape against many others inverts its orientation once rather than per pair.
+	struct HullPair
+	{
+		const Geometry::ConvexHull* hull_1;
+		glm::mat4 transform_1;
+		glm::quat inverse_orientation_1; // Rotates world space directions into the object space of hull_1.
+		const Geometry::ConvexHull* hull_2;
+		glm::mat4 transform_2;
+		glm::quat inverse_orientation_2; // Rotates world space directions into the object space of hull_2.
+	};
+	// Per-pair state kept between batched queries of the same pair, e.g. across physics ticks.
+	// Pairs that were separated last query usually still are, testing the separating_axis found then rejects them with one support query.
+	struct PairCache
+	{
+		SupportCache support;
+		glm::vec3 separating_axis = glm::vec3(0.f); // World space axis separating the pair in the last query, zero if they were intersecting or never queried.
+	};
+
+	// Batched intersecting for the candidate pairs of a broad phase.
+	// All pairs are first tested against their cached separating axis, only the pairs not rejected run the full GJK loop.
+	// The full loop starts from the cached separating axis if there is one, otherwise from the direction between the pair.
+	// Pairs are independent so a batch can be split into sub-spans across threads as long as the caches are not shared.
+	//@param p_pairs The candidate pairs to test.
+	//@param p_caches Per-pair state matching p_pairs by index, updated with the support vertices and separating axis found.
+	//@param p_intersecting Out: the indices into p_pairs of the intersecting pairs in ascending order, cleared first.
+	//@param p_simplices Out: the simplex enclosing the origin of each pair in p_intersecting for use by EPA, cleared first.
+	void intersecting(std::span<const HullPair> p_pairs, std::span<PairCache> p_caches, std::vector<size_t>& p_intersecting, std::vector<Simplex>& p_simplices);
+	// Batched EPA for the intersecting pairs found by the batched intersecting.
+	//@param p_pairs The candidate pairs passed to intersecting.
+	//@param p_intersecting The indices into p_pairs of the intersecting pairs.
+	//@param p_simplices The simplex of each pair in p_intersecting.
+	//@param p_caches Per-pair state matching p_pairs by index.
+	//@param p_collision_points Out: the collision point of each pair in p_intersecting, cleared first.
+	void EPA(std::span<const HullPair> p_pairs, std::span<const size_t> p_intersecting, std::span<const Simplex> p_simplices,
+	         std::span<PairCache> p_caches, std::vector<CollisionPoint>& p_collision_points);
 } // namespace GJK
\ No newline at end of file
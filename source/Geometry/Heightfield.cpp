@@ -0,0 +1,267 @@
+#include "Heightfield.hpp"
+#include "Intersect.hpp"
+#include "Ray.hpp"
+#include "Sphere.hpp"
+
+#include "Utility/Logger.hpp"
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Geometry
+{
+	Heightfield::Heightfield() noexcept
+		: m_cells_x{0}
+		, m_cells_z{0}
+		, m_cell_size{1.f}
+		, m_heights{}
+		, m_AABB{}
+	{}
+	Heightfield::Heightfield(size_t p_cells_x, size_t p_cells_z, float p_cell_size, std::vector<float>&& p_heights)
+		: m_cells_x{p_cells_x}
+		, m_cells_z{p_cells_z}
+		, m_cell_size{p_cell_size}
+		, m_heights{std::move(p_heights)}
+		, m_AABB{}
+	{
+		ASSERT_THROW(m_cells_x > 0 && m_cells_z > 0, "[HEIGHTFIELD] Heightfield must have at least one cell.");
+		ASSERT_THROW(m_cell_size > 0.f, "[HEIGHTFIELD] Cell size must be positive.");
+		ASSERT_THROW(m_heights.size() == (m_cells_x + 1) * (m_cells_z + 1), "[HEIGHTFIELD] Height sample count does not match the cell count.");
+
+		const auto [min_height, max_height] = std::minmax_element(m_heights.begin(), m_heights.end());
+		m_AABB = AABB(glm::vec3(0.f, *min_height, 0.f), glm::vec3(static_cast<float>(m_cells_x) * m_cell_size, *max_height, static_cast<float>(m_cells_z) * m_cell_size));
+	}
+
+	bool Heightfield::contains(float p_x, float p_z) const
+	{
+		return !empty() && p_x >= 0.f && p_z >= 0.f && p_x <= m_AABB.m_max.x && p_z <= m_AABB.m_max.z;
+	}
+	std::pair<size_t, size_t> Heightfield::get_cell(float p_x, float p_z) const
+	{
+		const auto x = std::clamp(static_cast<long long>(std::floor(p_x / m_cell_size)), 0LL, static_cast<long long>(m_cells_x) - 1);
+		const auto z = std::clamp(static_cast<long long>(std::floor(p_z / m_cell_size)), 0LL, static_cast<long long>(m_cells_z) - 1);
+		return {static_cast<size_t>(x), static_cast<size_t>(z)};
+	}
+	std::array<Triangle, 2> Heightfield::get_triangles(size_t p_x, size_t p_z) const
+	{
+		const float x_0 = static_cast<float>(p_x) * m_cell_size;
+		const float z_0 = static_cast<float>(p_z) * m_cell_size;
+		const auto top_left     = glm::vec3(x_0,               get_sample(p_x,     p_z),     z_0);
+		const auto top_right    = glm::vec3(x_0 + m_cell_size, get_sample(p_x + 1, p_z),     z_0);
+		const auto bottom_left  = glm::vec3(x_0,               get_sample(p_x,     p_z + 1), z_0 + m_cell_size);
+		const auto bottom_right = glm::vec3(x_0 + m_cell_size, get_sample(p_x + 1, p_z + 1), z_0 + m_cell_size);
+		return {Triangle(top_left, bottom_left, top_right), Triangle(top_right, bottom_left, bottom_right)};
+	}
+
+	std::optional<float> Heightfield::get_height(float p_x, float p_z) const
+	{
+		if (!contains(p_x, p_z))
+			return std::nullopt;
+
+		const auto [x, z] = get_cell(p_x, p_z);
+		const float u = p_x / m_cell_size - static_cast<float>(x);
+		const float v = p_z / m_cell_size - static_cast<float>(z);
+		return glm::mix(glm::mix(get_sample(x, z),     get_sample(x + 1, z),     u),
+		                glm::mix(get_sample(x, z + 1), get_sample(x + 1, z + 1), u), v);
+	}
+	std::optional<glm::vec3> Heightfield::get_normal(float p_x, float p_z) const
+	{
+		if (!contains(p_x, p_z))
+			return std::nullopt;
+
+		// The normal of a height function h(x, z) is (-dh/dx, 1, -dh/dz) normalised.
+		const auto [x, z] = get_cell(p_x, p_z);
+		const float u = p_x / m_cell_size - static_cast<float>(x);
+		const float v = p_z / m_cell_size - static_cast<float>(z);
+		const float dh_dx = glm::mix(get_sample(x + 1, z) - get_sample(x, z), get_sample(x + 1, z + 1) - get_sample(x, z + 1), v) / m_cell_size;
+		const float dh_dz = glm::mix(get_sample(x, z + 1) - get_sample(x, z), get_sample(x + 1, z + 1) - get_sample(x + 1, z), u) / m_cell_size;
+		return glm::normalize(glm::vec3(-dh_dx, 1.f, -dh_dz));
+	}
+	glm::vec3 Heightfield::get_sample_normal(size_t p_x, size_t p_z) const
+	{
+		const size_t left  = p_x > 0 ? p_x - 1 : p_x;
+		const size_t right = std::min(p_x + 1, m_cells_x);
+		const size_t back  = p_z > 0 ? p_z - 1 : p_z;
+		const size_t front = std::min(p_z + 1, m_cells_z);
+		const float dh_dx = (get_sample(right, p_z) - get_sample(left, p_z)) / (static_cast<float>(right - left) * m_cell_size);
+		const float dh_dz = (get_sample(p_x, front) - get_sample(p_x, back)) / (static_cast<float>(front - back) * m_cell_size);
+		return glm::normalize(glm::vec3(-dh_dx, 1.f, -dh_dz));
+	}
+
+	std::optional<Heightfield::Hit> Heightfield::get_intersection(const Ray& p_ray, float p_max_distance) const
+	{
+		if (empty())
+			return std::nullopt;
+
+		// Clip the ray to the part over the heightfield bounds.
+		float entry = 0.f;
+		if (!Geometry::get_intersection(m_AABB, p_ray, &entry))
+			return std::nullopt;
+
+		float exit = p_max_distance;
+		for (int i = 0; i < 3; i++)
+		{
+			if (p_ray.m_direction[i] != 0.f)
+				exit = std::min(exit, ((p_ray.m_direction[i] > 0.f ? m_AABB.m_max[i] : m_AABB.m_min[i]) - p_ray.m_start[i]) / p_ray.m_direction[i]);
+		}
+		entry = std::max(entry, 0.f);
+		if (entry > exit)
+			return std::nullopt;
+
+		// Walk the cells along the XZ projection of the ray from entry to exit.
+		const auto start = p_ray.m_start + p_ray.m_direction * entry;
+		auto [x, z] = get_cell(start.x, start.z);
+
+		auto axis_setup = [&](int p_axis, size_t p_cell, int& p_step, float& p_next_boundary, float& p_delta)
+		{
+			const float direction = p_ray.m_direction[p_axis];
+			if (direction == 0.f)
+			{
+				p_step          = 0;
+				p_next_boundary = Max_distance;
+				p_delta         = Max_distance;
+				return;
+			}
+			p_step = direction > 0.f ? 1 : -1;
+			const float boundary = (static_cast<float>(p_cell) + (direction > 0.f ? 1.f : 0.f)) * m_cell_size;
+			p_next_boundary = (boundary - p_ray.m_start[p_axis]) / direction;
+			p_delta         = m_cell_size / std::abs(direction);
+		};
+		int step_x = 0, step_z = 0;
+		float next_x = 0.f, next_z = 0.f, delta_x = 0.f, delta_z = 0.f;
+		axis_setup(0, x, step_x, next_x, delta_x);
+		axis_setup(2, z, step_z, next_z, delta_z);
+
+		float cell_entry = entry;
+		while (cell_entry <= exit)
+		{
+			const float cell_exit = std::min({next_x, next_z, exit});
+
+			// Skip cells where the ray passes entirely above or below the four samples.
+			const float ray_y_1    = p_ray.m_start.y + p_ray.m_direction.y * cell_entry;
+			const float ray_y_2    = p_ray.m_start.y + p_ray.m_direction.y * cell_exit;
+			const auto cell_height = std::minmax({get_sample(x, z), get_sample(x + 1, z), get_sample(x, z + 1), get_sample(x + 1, z + 1)});
+			if (std::max(ray_y_1, ray_y_2) >= cell_height.first && std::min(ray_y_1, ray_y_2) <= cell_height.second)
+			{
+				std::optional<Hit> closest_hit;
+				for (const auto& triangle : get_triangles(x, z))
+				{
+					float distance_along_ray = 0.f;
+					if (auto point = Geometry::get_intersection(p_ray, triangle, &distance_along_ray))
+					{
+						if (distance_along_ray <= p_max_distance && (!closest_hit || distance_along_ray < closest_hit->distance_along_ray))
+						{
+							auto normal = triangle.normal();
+							closest_hit = Hit{*point, normal.y < 0.f ? -normal : normal, distance_along_ray};
+						}
+					}
+				}
+				// The triangles of a cell lie within its column so a hit here is nearer than any in later cells.
+				if (closest_hit)
+					return closest_hit;
+			}
+
+			// Step into the neighbouring cell across the nearest boundary.
+			if (next_x < next_z)
+			{
+				if ((step_x < 0 && x == 0) || (step_x > 0 && x + 1 == m_cells_x))
+					break;
+				x          = static_cast<size_t>(static_cast<long long>(x) + step_x);
+				cell_entry = next_x;
+				next_x    += delta_x;
+			}
+			else
+			{
+				if (step_z == 0 || (step_z < 0 && z == 0) || (step_z > 0 && z + 1 == m_cells_z))
+					break;
+				z          = static_cast<size_t>(static_cast<long long>(z) + step_z);
+				cell_entry = next_z;
+				next_z    += delta_z;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	std::optional<Heightfield::Contact> Heightfield::get_contact(const AABB& p_AABB) const
+	{
+		if (empty() || !Geometry::intersecting(m_AABB, p_AABB))
+			return std::nullopt;
+
+		std::optional<Contact> deepest;
+		auto test_point = [&](float p_x, float p_z)
+		{
+			if (auto height = get_height(p_x, p_z))
+			{
+				const float depth = *height - p_AABB.m_min.y;
+				if (depth > 0.f && (!deepest || depth > deepest->penetration_depth))
+					deepest = Contact{glm::vec3(p_x, *height, p_z), glm::vec3(0.f), depth};
+			}
+		};
+
+		const auto [first_x, first_z] = get_cell(p_AABB.m_min.x, p_AABB.m_min.z);
+		const auto [last_x, last_z]   = get_cell(p_AABB.m_max.x, p_AABB.m_max.z);
+		for (size_t z = first_z; z <= last_z + 1; z++)
+		{
+			for (size_t x = first_x; x <= last_x + 1; x++)
+			{
+				const float sample_x = static_cast<float>(x) * m_cell_size;
+				const float sample_z = static_cast<float>(z) * m_cell_size;
+				if (sample_x >= p_AABB.m_min.x && sample_x <= p_AABB.m_max.x && sample_z >= p_AABB.m_min.z && sample_z <= p_AABB.m_max.z)
+					test_point(sample_x, sample_z);
+			}
+		}
+		test_point(p_AABB.m_min.x, p_AABB.m_min.z);
+		test_point(p_AABB.m_max.x, p_AABB.m_min.z);
+		test_point(p_AABB.m_min.x, p_AABB.m_max.z);
+		test_point(p_AABB.m_max.x, p_AABB.m_max.z);
+		test_point((p_AABB.m_min.x + p_AABB.m_max.x) / 2.f, (p_AABB.m_min.z + p_AABB.m_max.z) / 2.f);
+
+		if (deepest)
+		{// Convert the vertical depth into the depth along the surface normal.
+			deepest->normal             = *get_normal(deepest->position.x, deepest->position.z);
+			deepest->penetration_depth *= deepest->normal.y;
+		}
+		return deepest;
+	}
+
+	std::optional<Heightfield::Contact> Heightfield::get_contact(const Sphere& p_sphere) const
+	{
+		const auto sphere_AABB = AABB(p_sphere.m_center - glm::vec3(p_sphere.m_radius), p_sphere.m_center + glm::vec3(p_sphere.m_radius));
+		if (empty() || !Geometry::intersecting(m_AABB, sphere_AABB))
+			return std::nullopt;
+
+		// A sphere center below the surface is resolved vertically out of the ground.
+		if (auto height = get_height(p_sphere.m_center.x, p_sphere.m_center.z); height && p_sphere.m_center.y < *height)
+		{
+			const auto normal = *get_normal(p_sphere.m_center.x, p_sphere.m_center.z);
+			return Contact{glm::vec3(p_sphere.m_center.x, *height, p_sphere.m_center.z), normal, (*height - p_sphere.m_center.y) * normal.y + p_sphere.m_radius};
+		}
+
+		// Otherwise the deepest point is the closest point on the triangles under the sphere.
+		std::optional<Contact> deepest;
+		const auto [first_x, first_z] = get_cell(sphere_AABB.m_min.x, sphere_AABB.m_min.z);
+		const auto [last_x, last_z]   = get_cell(sphere_AABB.m_max.x, sphere_AABB.m_max.z);
+		for (size_t z = first_z; z <= last_z; z++)
+		{
+			for (size_t x = first_x; x <= last_x; x++)
+			{
+				for (const auto& triangle : get_triangles(x, z))
+				{
+					const auto point    = closest_point(triangle, p_sphere.m_center);
+					const auto offset   = p_sphere.m_center - point;
+					const float distance = glm::length(offset);
+					const float depth    = p_sphere.m_radius - distance;
+					if (depth > 0.f && (!deepest || depth > deepest->penetration_depth))
+					{
+						const auto normal = distance > 0.f ? offset / distance : glm::vec3(0.f, 1.f, 0.f);
+						deepest = Contact{point, normal, depth};
+					}
+				}
+			}
+		}
+		return deepest;
+	}
+} // namespace Geometry
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "AABB.hpp"
+#include "Triangle.hpp"
+
+#include "glm/vec3.hpp"
+
+#include <array>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Geometry
+{
+	class Ray;
+	class Sphere;
+
+	// A regular grid of height samples in the XZ plane spaced by cell size, starting at the origin of its space.
+	// Each cell is split into two triangles along the diagonal from (x+1, z) to (x, z+1), matching Component::Terrain meshes.
+	// Queries are in the space of the samples. Translate world space shapes by the inverse of the owner's position before querying.
+	class Heightfield
+	{
+	public:
+		static constexpr float Max_distance = std::numeric_limits<float>::max();
+
+		struct Hit
+		{
+			glm::vec3 point;          // Point of intersection on the surface.
+			glm::vec3 normal;         // Upward facing normal of the triangle hit.
+			float distance_along_ray; // Distance along the ray in multiples of the ray direction.
+		};
+		struct Contact
+		{
+			glm::vec3 position;      // The deepest point of contact on the surface.
+			glm::vec3 normal;        // Upward facing surface normal, the direction to move the shape to separate it from the surface.
+			float penetration_depth; // Displacement along normal separating the shape from the surface.
+		};
+
+		Heightfield() noexcept;
+		//@param p_cells_x,p_cells_z The number of cells along X and Z. There are (p_cells_x + 1) * (p_cells_z + 1) samples.
+		//@param p_cell_size The distance between neighbouring samples.
+		//@param p_heights The samples, row-major with X varying fastest: sample (x, z) is at index z * (p_cells_x + 1) + x.
+		Heightfield(size_t p_cells_x, size_t p_cells_z, float p_cell_size, std::vector<float>&& p_heights);
+
+		bool empty()                     const { return m_heights.empty(); }
+		size_t cells_x()                 const { return m_cells_x; }
+		size_t cells_z()                 const { return m_cells_z; }
+		float cell_size()                const { return m_cell_size; }
+		std::span<const float> heights() const { return m_heights; }
+		const AABB& get_AABB()           const { return m_AABB; }
+		float get_sample(size_t p_x, size_t p_z) const { return m_heights[p_z * (m_cells_x + 1) + p_x]; }
+
+		// Bilinearly interpolated height at p_x, p_z. nullopt if the point is outside the heightfield.
+		std::optional<float> get_height(float p_x, float p_z) const;
+		// Normal of the bilinearly interpolated surface at p_x, p_z. nullopt if the point is outside the heightfield.
+		std::optional<glm::vec3> get_normal(float p_x, float p_z) const;
+		// Normal at sample p_x, p_z from the central difference of its neighbouring samples, one-sided on the edges.
+		// Depends only on the samples around it, so meshes sharing the sample agree on its normal.
+		glm::vec3 get_sample_normal(size_t p_x, size_t p_z) const;
+
+		// Find the first surface triangle p_ray hits walking the cells under the ray front to back (3D DDA).
+		// Only the two triangles of the cells the ray passes over are tested, cells the ray passes entirely above or below are skipped.
+		//@param p_max_distance Hits beyond this distance along p_ray are ignored.
+		std::optional<Hit> get_intersection(const Ray& p_ray, float p_max_distance = Max_distance) const;
+		// Find the deepest penetration of p_AABB below the bilinear surface.
+		// The surface is sampled at the grid points under p_AABB and its corners and center, exact for flat and convex ground.
+		std::optional<Contact> get_contact(const AABB& p_AABB) const;
+		// Find the deepest penetration of p_sphere into the surface triangles under it.
+		std::optional<Contact> get_contact(const Sphere& p_sphere) const;
+
+	private:
+		size_t m_cells_x;
+		size_t m_cells_z;
+		float m_cell_size;
+		std::vector<float> m_heights;
+		AABB m_AABB; // Bounds of every sample.
+
+		// The two surface triangles of cell p_x, p_z.
+		std::array<Triangle, 2> get_triangles(size_t p_x, size_t p_z) const;
+		// The cell containing p_x, p_z, clamping points on the far edges into the last cell.
+		std::pair<size_t, size_t> get_cell(float p_x, float p_z) const;
+		bool contains(float p_x, float p_z) const;
+	};
+} // namespace Geometry
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "HeightfieldChunks.hpp"
+#include "Heightfield.hpp"
+#include "Intersect.hpp"
+
+#include "Utility/Logger.hpp"
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Geometry
+{
+	HeightfieldChunks::HeightfieldChunks(const Heightfield& p_heightfield, size_t p_chunk_cells)
+		: m_chunks_x{0}
+		, m_chunks_z{0}
+		, m_chunks{}
+	{
+		ASSERT_THROW(p_chunk_cells > 0, "[HEIGHTFIELD] Chunks must hold at least one cell.");
+		if (p_heightfield.empty())
+			return;
+
+		m_chunks_x = (p_heightfield.cells_x() + p_chunk_cells - 1) / p_chunk_cells;
+		m_chunks_z = (p_heightfield.cells_z() + p_chunk_cells - 1) / p_chunk_cells;
+		m_chunks.reserve(m_chunks_x * m_chunks_z);
+
+		for (size_t chunk_z = 0; chunk_z < m_chunks_z; chunk_z++)
+		{
+			for (size_t chunk_x = 0; chunk_x < m_chunks_x; chunk_x++)
+			{
+				Chunk chunk;
+				chunk.first_x     = chunk_x * p_chunk_cells;
+				chunk.first_z     = chunk_z * p_chunk_cells;
+				chunk.cells_x     = std::min(p_chunk_cells, p_heightfield.cells_x() - chunk.first_x);
+				chunk.cells_z     = std::min(p_chunk_cells, p_heightfield.cells_z() - chunk.first_z);
+				chunk.lod         = 0;
+				chunk.stitch_mask = 0;
+
+				chunk.max_lod = 0;
+				while (chunk.max_lod + 1 < Lod_count && chunk.cells_x % (size_t(2) << chunk.max_lod) == 0 && chunk.cells_z % (size_t(2) << chunk.max_lod) == 0)
+					chunk.max_lod++;
+
+				float min_height = std::numeric_limits<float>::max();
+				float max_height = std::numeric_limits<float>::lowest();
+				for (size_t z = chunk.first_z; z <= chunk.first_z + chunk.cells_z; z++)
+				{
+					for (size_t x = chunk.first_x; x <= chunk.first_x + chunk.cells_x; x++)
+					{
+						min_height = std::min(min_height, p_heightfield.get_sample(x, z));
+						max_height = std::max(max_height, p_heightfield.get_sample(x, z));
+					}
+				}
+				const float cell_size = p_heightfield.cell_size();
+				chunk.bounds = AABB(glm::vec3(static_cast<float>(chunk.first_x) * cell_size, min_height, static_cast<float>(chunk.first_z) * cell_size),
+				                    glm::vec3(static_cast<float>(chunk.first_x + chunk.cells_x) * cell_size, max_height, static_cast<float>(chunk.first_z + chunk.cells_z) * cell_size));
+				m_chunks.push_back(chunk);
+			}
+		}
+	}
+
+	void HeightfieldChunks::update(const glm::vec3& p_view_position, float p_lod_distance)
+	{
+		for (auto& chunk : m_chunks)
+		{
+			const float distance = std::sqrt(distance_squared(chunk.bounds, p_view_position));
+			const size_t lod     = distance <= p_lod_distance ? 0 : static_cast<size_t>(std::ceil(std::log2(distance / p_lod_distance)));
+			chunk.lod = std::min(lod, chunk.max_lod);
+		}
+
+		// Lowering a LOD can leave it more than one finer than its other neighbours, repeat until every neighbour is within one.
+		// LODs only decrease so this ends, and stays within max_lod.
+		auto neighbour = [&](size_t p_chunk_x, size_t p_chunk_z, Side p_side) -> const Chunk*
+		{
+			switch (p_side)
+			{
+				case Side::NegativeX: return p_chunk_x > 0              ? &m_chunks[p_chunk_z * m_chunks_x + p_chunk_x - 1] : nullptr;
+				case Side::PositiveX: return p_chunk_x + 1 < m_chunks_x ? &m_chunks[p_chunk_z * m_chunks_x + p_chunk_x + 1] : nullptr;
+				case Side::NegativeZ: return p_chunk_z > 0              ? &m_chunks[(p_chunk_z - 1) * m_chunks_x + p_chunk_x] : nullptr;
+				case Side::PositiveZ: return p_chunk_z + 1 < m_chunks_z ? &m_chunks[(p_chunk_z + 1) * m_chunks_x + p_chunk_x] : nullptr;
+				default: return nullptr;
+			}
+		};
+		constexpr Side sides[] = {Side::NegativeX, Side::PositiveX, Side::NegativeZ, Side::PositiveZ};
+
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+			for (size_t chunk_z = 0; chunk_z < m_chunks_z; chunk_z++)
+			{
+				for (size_t chunk_x = 0; chunk_x < m_chunks_x; chunk_x++)
+				{
+					auto& chunk = m_chunks[chunk_z * m_chunks_x + chunk_x];
+					for (auto side : sides)
+					{
+						if (const auto* other = neighbour(chunk_x, chunk_z, side); other && chunk.lod > other->lod + 1)
+						{
+							chunk.lod = other->lod + 1;
+							changed   = true;
+						}
+					}
+				}
+			}
+		}
+
+		for (size_t chunk_z = 0; chunk_z < m_chunks_z; chunk_z++)
+		{
+			for (size_t chunk_x = 0; chunk_x < m_chunks_x; chunk_x++)
+			{
+				auto& chunk = m_chunks[chunk_z * m_chunks_x + chunk_x];
+				chunk.stitch_mask = 0;
+				for (auto side : sides)
+				{
+					if (const auto* other = neighbour(chunk_x, chunk_z, side); other && other->lod == chunk.lod + 1)
+						chunk.stitch_mask |= uint8_t(1) << static_cast<uint8_t>(side);
+				}
+			}
+		}
+	}
+
+	std::vector<unsigned int> HeightfieldChunks::get_indices(const Chunk& p_chunk) const
+	{
+		const size_t cells_x    = p_chunk.cells_x / p_chunk.step();
+		const size_t cells_z    = p_chunk.cells_z / p_chunk.step();
+		const size_t vertices_x = cells_x + 1;
+		auto stitched = [&](Side p_side) { return (p_chunk.stitch_mask & (uint8_t(1) << static_cast<uint8_t>(p_side))) != 0; };
+		const bool stitch_negative_x = stitched(Side::NegativeX);
+		const bool stitch_positive_x = stitched(Side::PositiveX);
+		const bool stitch_negative_z = stitched(Side::NegativeZ);
+		const bool stitch_positive_z = stitched(Side::PositiveZ);
+
+		// The index of vertex (i, j) after collapsing the odd vertices of stitched borders onto the previous vertex along the border.
+		// The coarser neighbour has no vertex there, so its border edges span two of ours which this reproduces.
+		auto index = [&](size_t p_i, size_t p_j) -> unsigned int
+		{
+			if ((p_i == 0 && stitch_negative_x) || (p_i == cells_x && stitch_positive_x))
+				p_j &= ~size_t(1);
+			if ((p_j == 0 && stitch_negative_z) || (p_j == cells_z && stitch_positive_z))
+				p_i &= ~size_t(1);
+			return static_cast<unsigned int>(p_j * vertices_x + p_i);
+		};
+
+		std::vector<unsigned int> indices;
+		indices.reserve(cells_x * cells_z * 6);
+		auto add_triangle = [&](unsigned int p_a, unsigned int p_b, unsigned int p_c)
+		{
+			// Triangles with a collapsed edge have no area. The cell on a corner stitched on both sides also keeps a vertical triangle,
+			// it closes the gap between the interior vertex and the diagonal the corner cell collapses to.
+			if (p_a != p_b && p_b != p_c && p_a != p_c)
+			{
+				indices.push_back(p_a);
+				indices.push_back(p_b);
+				indices.push_back(p_c);
+			}
+		};
+
+		// Each cell is split along the diagonal from (i + 1, j) to (i, j + 1) matching Heightfield.
+		for (size_t j = 0; j < cells_z; j++)
+		{
+			for (size_t i = 0; i < cells_x; i++)
+			{
+				add_triangle(index(i, j), index(i, j + 1), index(i + 1, j));
+				add_triangle(index(i + 1, j), index(i, j + 1), index(i + 1, j + 1));
+			}
+		}
+		return indices;
+	}
+} // namespace Geometry
\ No newline at end of file
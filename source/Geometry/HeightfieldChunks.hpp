@@ -0,0 +1,74 @@
+#pragma once
+
+#include "AABB.hpp"
+
+#include "glm/vec3.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Geometry
+{
+	class Heightfield;
+
+	// Splits the cells of a Heightfield into square chunks, each meshed at one of Lod_count levels of detail (LOD).
+	// A chunk at LOD l places a vertex on every 2^l'th sample, LODs are chosen by the distance from the view to the chunk.
+	// Neighbouring chunks are kept within one LOD of each other. The finer side of a seam collapses its border vertices missing from the
+	// coarser side onto their neighbours along the border, so both sides share the same border edges and no cracks open between them.
+	// Chunks on the far edges hold the remaining cells when the heightfield is not a multiple of the chunk size.
+	class HeightfieldChunks
+	{
+	public:
+		static constexpr size_t Chunk_cells = 32;
+		static constexpr size_t Lod_count   = 4;
+
+		// The sides of a chunk, the bit (1 << side) of Chunk::stitch_mask is set when the border on that side is stitched.
+		enum class Side : uint8_t
+		{
+			NegativeX,
+			PositiveX,
+			NegativeZ,
+			PositiveZ
+		};
+
+		struct Chunk
+		{
+			size_t first_x;      // The first cell of the chunk along X.
+			size_t first_z;      // The first cell of the chunk along Z.
+			size_t cells_x;
+			size_t cells_z;
+			AABB bounds;         // Bounds of the chunk's samples in the space of the heightfield.
+			size_t max_lod;      // The coarsest LOD the chunk's cell counts divide into.
+			size_t lod;          // The LOD chosen by the last update.
+			uint8_t stitch_mask; // Bit per Side set where the neighbour is a LOD coarser.
+
+			size_t step()       const { return size_t(1) << lod; } // Cells between neighbouring vertices.
+			size_t vertices_x() const { return cells_x / step() + 1; }
+			size_t vertices_z() const { return cells_z / step() + 1; }
+		};
+
+		HeightfieldChunks() = default;
+		//@param p_chunk_cells The cells along each side of a chunk. A multiple of 2^(Lod_count - 1) lets full chunks use every LOD.
+		explicit HeightfieldChunks(const Heightfield& p_heightfield, size_t p_chunk_cells = Chunk_cells);
+
+		bool empty()                     const { return m_chunks.empty(); }
+		size_t chunks_x()                const { return m_chunks_x; }
+		size_t chunks_z()                const { return m_chunks_z; }
+		std::span<const Chunk> chunks()  const { return m_chunks; }
+
+		// Choose the LOD of every chunk for a view at p_view_position in the space of the heightfield.
+		// Chunks within p_lod_distance of the view are LOD 0, each LOD after covers twice the distance of the previous.
+		// LODs are then lowered until neighbours differ by at most one and the stitch masks set to match.
+		void update(const glm::vec3& p_view_position, float p_lod_distance);
+
+		// Triangle indices of p_chunk at its LOD and stitch mask, wound counter-clockwise seen from above.
+		// Vertices are indexed row-major with X varying fastest, vertex (i, j) is sample (first_x + i * step, first_z + j * step).
+		std::vector<unsigned int> get_indices(const Chunk& p_chunk) const;
+
+	private:
+		size_t m_chunks_x = 0;
+		size_t m_chunks_z = 0;
+		std::vector<Chunk> m_chunks; // Row-major with X varying fastest.
+	};
+} // namespace Geometry
\ No newline at end of file
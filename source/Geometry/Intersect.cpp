@@ -3,6 +3,7 @@
 #include "Geometry/AABB.hpp"
 #include "Geometry/Cone.hpp"
 #include "Geometry/Cylinder.hpp"
+#include "Geometry/Frustrum.hpp"
 #include "Geometry/Plane.hpp"
 #include "Geometry/Ray.hpp"
 #include "Geometry/Sphere.hpp"
@@ -12,8 +13,14 @@
 #include "Utility/Logger.hpp"
 
 #include <glm/glm.hpp>
+#include <algorithm>
 #include <limits>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define Z_INTERSECT_SSE
+	#include <emmintrin.h>
+#endif
+
 // This intersections source file is composed of header definitions as well as cpp-static-functions that are used as helpers for them.
 namespace Geometry
 {
@@ -271,11 +278,234 @@ namespace Geometry
 	{
 		return std::sqrt(distance_squared(line, point));
 	}
+	float distance_squared(const AABB& AABB, const glm::vec3& point)
+	{
+		// Sum the squared distance the point lies outside the AABB along each axis.
+		// Real-Time Collision Detection (Christer Ericson) - 5.1.3.1 Distance of Point to AABB pg 131
+		float distance_sq = 0.f;
+		for (int i = 0; i < 3; i++)
+		{
+			const float excess = std::max({AABB.m_min[i] - point[i], point[i] - AABB.m_max[i], 0.f});
+			distance_sq += excess * excess;
+		}
+		return distance_sq;
+	}
+	float distance_squared(const Triangle& triangle, const glm::vec3& point)
+	{
+		const glm::vec3 offset = point - closest_point(triangle, point);
+		return glm::dot(offset, offset);
+	}
 	float distance(const Plane& plane, const glm::vec3& point)
 	{
 		return glm::dot(plane.m_normal, point) - plane.m_distance;
 	}
 
+// ==============================================================================================================================
+// BATCH DISTANCE FUNCTIONS
+// ==============================================================================================================================
+#ifdef Z_INTERSECT_SSE
+	// Four vec3s, one per SSE lane. The helpers below perform the glm::vec3 operations of the scalar functions in the same order so
+	// every lane produces the same result as the scalar function given the same inputs.
+	struct Vec3x4
+	{
+		__m128 x;
+		__m128 y;
+		__m128 z;
+	};
+	static Vec3x4 broadcast(const glm::vec3& p_vec)
+	{
+		return {_mm_set1_ps(p_vec.x), _mm_set1_ps(p_vec.y), _mm_set1_ps(p_vec.z)};
+	}
+	// Gather the vec3 p_get(lane) of each lane.
+	template <typename Get>
+	static Vec3x4 gather(const Get& p_get)
+	{
+		const glm::vec3& lane_0 = p_get(0);
+		const glm::vec3& lane_1 = p_get(1);
+		const glm::vec3& lane_2 = p_get(2);
+		const glm::vec3& lane_3 = p_get(3);
+		return {_mm_setr_ps(lane_0.x, lane_1.x, lane_2.x, lane_3.x), _mm_setr_ps(lane_0.y, lane_1.y, lane_2.y, lane_3.y), _mm_setr_ps(lane_0.z, lane_1.z, lane_2.z, lane_3.z)};
+	}
+	static Vec3x4 add(const Vec3x4& p_a, const Vec3x4& p_b) { return {_mm_add_ps(p_a.x, p_b.x), _mm_add_ps(p_a.y, p_b.y), _mm_add_ps(p_a.z, p_b.z)}; }
+	static Vec3x4 sub(const Vec3x4& p_a, const Vec3x4& p_b) { return {_mm_sub_ps(p_a.x, p_b.x), _mm_sub_ps(p_a.y, p_b.y), _mm_sub_ps(p_a.z, p_b.z)}; }
+	static Vec3x4 mul(const Vec3x4& p_a, __m128 p_scalar)   { return {_mm_mul_ps(p_a.x, p_scalar), _mm_mul_ps(p_a.y, p_scalar), _mm_mul_ps(p_a.z, p_scalar)}; }
+	static __m128 dot(const Vec3x4& p_a, const Vec3x4& p_b) { return _mm_add_ps(_mm_add_ps(_mm_mul_ps(p_a.x, p_b.x), _mm_mul_ps(p_a.y, p_b.y)), _mm_mul_ps(p_a.z, p_b.z)); }
+	// Per lane, p_true where p_mask is set and p_false otherwise.
+	static __m128 select(__m128 p_mask, __m128 p_true, __m128 p_false) { return _mm_or_ps(_mm_and_ps(p_mask, p_true), _mm_andnot_ps(p_mask, p_false)); }
+	static Vec3x4 select(__m128 p_mask, const Vec3x4& p_true, const Vec3x4& p_false)
+	{
+		return {select(p_mask, p_true.x, p_false.x), select(p_mask, p_true.y, p_false.y), select(p_mask, p_true.z, p_false.z)};
+	}
+
+	// distance_squared(LineSegment, point) per lane.
+	static __m128 distance_squared(const Vec3x4& p_start, const Vec3x4& p_end, const Vec3x4& p_point)
+	{
+		const Vec3x4 AB       = sub(p_end, p_start);
+		const Vec3x4 AP       = sub(p_point, p_start);
+		const __m128 dot_AP_AB = dot(AP, AB);
+		const __m128 f         = dot(AB, AB);
+		const Vec3x4 BP       = sub(p_point, p_end);
+		const __m128 dot_AP_AP = dot(AP, AP);
+
+		// Every case is computed and the first applicable of the scalar branches selected.
+		__m128 distance_sq = _mm_sub_ps(dot_AP_AP, _mm_div_ps(_mm_mul_ps(dot_AP_AB, dot_AP_AB), f));
+		distance_sq        = select(_mm_cmpge_ps(dot_AP_AB, f), dot(BP, BP), distance_sq);
+		return select(_mm_cmple_ps(dot_AP_AB, _mm_setzero_ps()), dot_AP_AP, distance_sq);
+	}
+	// distance_squared(AABB, point) per lane.
+	static __m128 distance_squared_AABB(const Vec3x4& p_min, const Vec3x4& p_max, const Vec3x4& p_point)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 excess_x = _mm_max_ps(_mm_max_ps(_mm_sub_ps(p_min.x, p_point.x), _mm_sub_ps(p_point.x, p_max.x)), zero);
+		const __m128 excess_y = _mm_max_ps(_mm_max_ps(_mm_sub_ps(p_min.y, p_point.y), _mm_sub_ps(p_point.y, p_max.y)), zero);
+		const __m128 excess_z = _mm_max_ps(_mm_max_ps(_mm_sub_ps(p_min.z, p_point.z), _mm_sub_ps(p_point.z, p_max.z)), zero);
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(excess_x, excess_x), _mm_mul_ps(excess_y, excess_y)), _mm_mul_ps(excess_z, excess_z));
+	}
+	// distance_squared(Triangle, point) per lane, following the Voronoi region tests of closest_point(Triangle, point).
+	static __m128 distance_squared(const Vec3x4& p_a, const Vec3x4& p_b, const Vec3x4& p_c, const Vec3x4& p_point)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const Vec3x4 ab   = sub(p_b, p_a);
+		const Vec3x4 ac   = sub(p_c, p_a);
+		const Vec3x4 ap   = sub(p_point, p_a);
+		const __m128 d1   = dot(ab, ap);
+		const __m128 d2   = dot(ac, ap);
+		const Vec3x4 bp   = sub(p_point, p_b);
+		const __m128 d3   = dot(ab, bp);
+		const __m128 d4   = dot(ac, bp);
+		const Vec3x4 cp   = sub(p_point, p_c);
+		const __m128 d5   = dot(ab, cp);
+		const __m128 d6   = dot(ac, cp);
+		const __m128 vc   = _mm_sub_ps(_mm_mul_ps(d1, d4), _mm_mul_ps(d3, d2));
+		const __m128 vb   = _mm_sub_ps(_mm_mul_ps(d5, d2), _mm_mul_ps(d1, d6));
+		const __m128 va   = _mm_sub_ps(_mm_mul_ps(d3, d6), _mm_mul_ps(d5, d4));
+
+		// Every region is computed and selected in reverse order of the scalar tests so the first region the scalar function returns wins.
+		// Lanes outside a region may divide by zero, those results are discarded by the select.
+		const __m128 denom = _mm_div_ps(_mm_set1_ps(1.f), _mm_add_ps(_mm_add_ps(va, vb), vc));
+		Vec3x4 closest     = add(add(p_a, mul(ab, _mm_mul_ps(vb, denom))), mul(ac, _mm_mul_ps(vc, denom)));
+
+		const __m128 d4_d3 = _mm_sub_ps(d4, d3);
+		const __m128 d5_d6 = _mm_sub_ps(d5, d6);
+		const __m128 in_BC = _mm_and_ps(_mm_cmple_ps(va, zero), _mm_and_ps(_mm_cmpge_ps(d4_d3, zero), _mm_cmpge_ps(d5_d6, zero)));
+		closest = select(in_BC, add(p_b, mul(sub(p_c, p_b), _mm_div_ps(d4_d3, _mm_add_ps(d4_d3, d5_d6)))), closest);
+
+		const __m128 in_AC = _mm_and_ps(_mm_cmple_ps(vb, zero), _mm_and_ps(_mm_cmpge_ps(d2, zero), _mm_cmple_ps(d6, zero)));
+		closest = select(in_AC, add(p_a, mul(ac, _mm_div_ps(d2, _mm_sub_ps(d2, d6)))), closest);
+
+		const __m128 in_C = _mm_and_ps(_mm_cmpge_ps(d6, zero), _mm_cmple_ps(d5, d6));
+		closest = select(in_C, p_c, closest);
+
+		const __m128 in_AB = _mm_and_ps(_mm_cmple_ps(vc, zero), _mm_and_ps(_mm_cmpge_ps(d1, zero), _mm_cmple_ps(d3, zero)));
+		closest = select(in_AB, add(p_a, mul(ab, _mm_div_ps(d1, _mm_sub_ps(d1, d3)))), closest);
+
+		const __m128 in_B = _mm_and_ps(_mm_cmpge_ps(d3, zero), _mm_cmple_ps(d4, d3));
+		closest = select(in_B, p_b, closest);
+
+		const __m128 in_A = _mm_and_ps(_mm_cmple_ps(d1, zero), _mm_cmple_ps(d2, zero));
+		closest = select(in_A, p_a, closest);
+
+		const Vec3x4 offset = sub(p_point, closest);
+		return dot(offset, offset);
+	}
+#endif
+
+	void distance_squared(std::span<const LineSegment> lines, const glm::vec3& point, std::span<float> out_distances)
+	{
+		ASSERT_THROW(out_distances.size() == lines.size(), "[INTERSECT] Batched distance expects an output per line segment.");
+
+		size_t i = 0;
+#ifdef Z_INTERSECT_SSE
+		const auto point_x4 = broadcast(point);
+		for (; i + 4 <= lines.size(); i += 4)
+		{
+			const auto start = gather([&](size_t p_lane) -> const glm::vec3& { return lines[i + p_lane].m_start; });
+			const auto end   = gather([&](size_t p_lane) -> const glm::vec3& { return lines[i + p_lane].m_end; });
+			_mm_storeu_ps(&out_distances[i], distance_squared(start, end, point_x4));
+		}
+#endif
+		for (; i < lines.size(); i++)
+			out_distances[i] = distance_squared(lines[i], point);
+	}
+	void distance_squared(std::span<const AABB> AABBs, const glm::vec3& point, std::span<float> out_distances)
+	{
+		ASSERT_THROW(out_distances.size() == AABBs.size(), "[INTERSECT] Batched distance expects an output per AABB.");
+
+		size_t i = 0;
+#ifdef Z_INTERSECT_SSE
+		const auto point_x4 = broadcast(point);
+		for (; i + 4 <= AABBs.size(); i += 4)
+		{
+			const auto min = gather([&](size_t p_lane) -> const glm::vec3& { return AABBs[i + p_lane].m_min; });
+			const auto max = gather([&](size_t p_lane) -> const glm::vec3& { return AABBs[i + p_lane].m_max; });
+			_mm_storeu_ps(&out_distances[i], distance_squared_AABB(min, max, point_x4));
+		}
+#endif
+		for (; i < AABBs.size(); i++)
+			out_distances[i] = distance_squared(AABBs[i], point);
+	}
+	void distance_squared(std::span<const Triangle> triangles, const glm::vec3& point, std::span<float> out_distances)
+	{
+		ASSERT_THROW(out_distances.size() == triangles.size(), "[INTERSECT] Batched distance expects an output per triangle.");
+
+		size_t i = 0;
+#ifdef Z_INTERSECT_SSE
+		const auto point_x4 = broadcast(point);
+		for (; i + 4 <= triangles.size(); i += 4)
+		{
+			const auto a = gather([&](size_t p_lane) -> const glm::vec3& { return triangles[i + p_lane].m_point_1; });
+			const auto b = gather([&](size_t p_lane) -> const glm::vec3& { return triangles[i + p_lane].m_point_2; });
+			const auto c = gather([&](size_t p_lane) -> const glm::vec3& { return triangles[i + p_lane].m_point_3; });
+			_mm_storeu_ps(&out_distances[i], distance_squared(a, b, c, point_x4));
+		}
+#endif
+		for (; i < triangles.size(); i++)
+			out_distances[i] = distance_squared(triangles[i], point);
+	}
+	void distance_squared(const LineSegment& line, std::span<const glm::vec3> points, std::span<float> out_distances)
+	{
+		ASSERT_THROW(out_distances.size() == points.size(), "[INTERSECT] Batched distance expects an output per point.");
+
+		size_t i = 0;
+#ifdef Z_INTERSECT_SSE
+		const auto start = broadcast(line.m_start);
+		const auto end   = broadcast(line.m_end);
+		for (; i + 4 <= points.size(); i += 4)
+			_mm_storeu_ps(&out_distances[i], distance_squared(start, end, gather([&](size_t p_lane) -> const glm::vec3& { return points[i + p_lane]; })));
+#endif
+		for (; i < points.size(); i++)
+			out_distances[i] = distance_squared(line, points[i]);
+	}
+	void distance_squared(const AABB& AABB, std::span<const glm::vec3> points, std::span<float> out_distances)
+	{
+		ASSERT_THROW(out_distances.size() == points.size(), "[INTERSECT] Batched distance expects an output per point.");
+
+		size_t i = 0;
+#ifdef Z_INTERSECT_SSE
+		const auto min = broadcast(AABB.m_min);
+		const auto max = broadcast(AABB.m_max);
+		for (; i + 4 <= points.size(); i += 4)
+			_mm_storeu_ps(&out_distances[i], distance_squared_AABB(min, max, gather([&](size_t p_lane) -> const glm::vec3& { return points[i + p_lane]; })));
+#endif
+		for (; i < points.size(); i++)
+			out_distances[i] = distance_squared(AABB, points[i]);
+	}
+	void distance_squared(const Triangle& triangle, std::span<const glm::vec3> points, std::span<float> out_distances)
+	{
+		ASSERT_THROW(out_distances.size() == points.size(), "[INTERSECT] Batched distance expects an output per point.");
+
+		size_t i = 0;
+#ifdef Z_INTERSECT_SSE
+		const auto a = broadcast(triangle.m_point_1);
+		const auto b = broadcast(triangle.m_point_2);
+		const auto c = broadcast(triangle.m_point_3);
+		for (; i + 4 <= points.size(); i += 4)
+			_mm_storeu_ps(&out_distances[i], distance_squared(a, b, c, gather([&](size_t p_lane) -> const glm::vec3& { return points[i + p_lane]; })));
+#endif
+		for (; i < points.size(); i++)
+			out_distances[i] = distance_squared(triangle, points[i]);
+	}
+
 // ==============================================================================================================================
 // END POINT_INSIDE FUNCTIONS
 // ==============================================================================================================================
@@ -391,6 +621,38 @@ namespace Geometry
 		else
 			return std::nullopt;
 	}
+	std::optional<glm::vec3> get_intersection(const Ray& ray, const Triangle& triangle, float* distance_along_ray)
+	{
+		// Möller-Trumbore: solve ray.m_start + t * ray.m_direction = (1 - u - v) * p1 + u * p2 + v * p3 for t, u and v using Cramer's rule.
+		const glm::vec3 edge_1 = triangle.m_point_2 - triangle.m_point_1;
+		const glm::vec3 edge_2 = triangle.m_point_3 - triangle.m_point_1;
+		const glm::vec3 p      = glm::cross(ray.m_direction, edge_2);
+		const float determinant = glm::dot(edge_1, p);
+
+		// A determinant near zero means the ray is parallel to the triangle plane.
+		if (std::abs(determinant) < Epsilon)
+			return std::nullopt;
+
+		const float inverse_determinant = 1.f / determinant;
+		const glm::vec3 s = ray.m_start - triangle.m_point_1;
+		const float u     = glm::dot(s, p) * inverse_determinant;
+		if (u < 0.f || u > 1.f)
+			return std::nullopt;
+
+		const glm::vec3 q = glm::cross(s, edge_1);
+		const float v     = glm::dot(ray.m_direction, q) * inverse_determinant;
+		if (v < 0.f || u + v > 1.f)
+			return std::nullopt;
+
+		const float t = glm::dot(edge_2, q) * inverse_determinant;
+		if (t < 0.f)
+			return std::nullopt;
+
+		if (distance_along_ray)
+			*distance_along_ray = t;
+
+		return ray.m_start + (ray.m_direction * t);
+	}
 	std::optional<Line> get_intersection(const Plane& plane_1, const Plane& plane_2)
 	{
 		// Compute direction of intersection line
@@ -492,6 +754,23 @@ namespace Geometry
 		else
 			return true;
 	}
+	bool intersecting(const AABB& AABB, const Sphere& sphere)
+	{
+		// Reference: Real-Time Collision Detection (Christer Ericson) 5.2.5 Testing Sphere Against AABB
+		const auto offset = glm::clamp(sphere.m_center, AABB.m_min, AABB.m_max) - sphere.m_center;
+		return glm::dot(offset, offset) <= sphere.m_radius * sphere.m_radius;
+	}
+	bool intersecting(const Frustrum& frustrum, const AABB& AABB)
+	{
+		// The AABB is outside if its corner furthest along a plane normal (the positive vertex) is behind that plane.
+		for (const auto& plane : frustrum.inside_plane_equations())
+		{
+			const auto positive_vertex = glm::vec3(plane.x >= 0.f ? AABB.m_max.x : AABB.m_min.x, plane.y >= 0.f ? AABB.m_max.y : AABB.m_min.y, plane.z >= 0.f ? AABB.m_max.z : AABB.m_min.z);
+			if (glm::dot(glm::vec3(plane), positive_vertex) + plane.w < 0.f)
+				return false;
+		}
+		return true;
+	}
 	bool intersecting(const AABB& AABB, const Ray& ray)
 	{
 		// Adapted from: Real-Time Collision Detection (Christer Ericson) - 5.3.3 Intersecting Ray or Segment Against Box pg 180
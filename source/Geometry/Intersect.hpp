@@ -7,6 +7,7 @@
 
 #include "glm/vec3.hpp"
 #include <optional>
+#include <span>
 
 namespace Geometry
 {
@@ -14,6 +15,7 @@ namespace Geometry
 	class Cone;
 	class Cuboid;
 	class Cylinder;
+	class Frustrum;
 	class Plane;
 	class Quad;
 	class Ray;
@@ -73,6 +75,16 @@ namespace Geometry
 	//@param point The point to find the distance from
 	//@return The distance from point to line
 	float distance(const LineSegment& line, const glm::vec3& point);
+	// Get the distance from the point to the AABB squared, zero if the point is inside
+	//@param AABB The AABB to find the distance to
+	//@param point The point to find the distance from
+	//@return The distance from point to AABB squared
+	float distance_squared(const AABB& AABB, const glm::vec3& point);
+	// Get the distance from the point to the closest point on the triangle squared
+	//@param triangle The triangle to find the distance to
+	//@param point The point to find the distance from
+	//@return The distance from point to triangle squared
+	float distance_squared(const Triangle& triangle, const glm::vec3& point);
 	// Get the distance from the point to the plane.
 	// The distance is signed as the plane has a normal direction. If the point is on the opposite side of the plane to the normal, the distance will be negative.
 	//@param plane The plane to find the distance to
@@ -80,12 +92,27 @@ namespace Geometry
 	//@return The signed distance from point to plane
 	float distance(const Plane& plane, const glm::vec3& point);
 
+//==============================================================================================================================
+// Batch distance functions: distance_squared from one point to many shapes or from many points to one shape.
+// Each out_distances element matches the single shape distance_squared above to within float rounding.
+// Four distances are computed at once in SSE lanes when available, otherwise one at a time. Take the std::sqrt of an element for the distance.
+//==============================================================================================================================
+	void distance_squared(std::span<const LineSegment> lines,  const glm::vec3& point, std::span<float> out_distances);
+	void distance_squared(std::span<const AABB> AABBs,         const glm::vec3& point, std::span<float> out_distances);
+	void distance_squared(std::span<const Triangle> triangles, const glm::vec3& point, std::span<float> out_distances);
+	void distance_squared(const LineSegment& line,  std::span<const glm::vec3> points, std::span<float> out_distances);
+	void distance_squared(const AABB& AABB,         std::span<const glm::vec3> points, std::span<float> out_distances);
+	void distance_squared(const Triangle& triangle, std::span<const glm::vec3> points, std::span<float> out_distances);
+
 //==============================================================================================================================
 // get_intersection functions: Return the point of intersection between two shapes from the perspective of shape A.
 //==============================================================================================================================
 	std::optional<glm::vec3> get_intersection(const Ray& ray, const Plane& plane);
 	std::optional<glm::vec3> get_intersection(const AABB& AABB, const Ray& ray, float* distance_along_ray = nullptr);
 	std::optional<glm::vec3> get_intersection(const Line& line, const Triangle& triangle);
+	// Double-sided ray triangle intersection. Only intersections at or ahead of the ray start are returned.
+	//@param distance_along_ray Optional out param set to the distance along ray in multiples of the ray direction.
+	std::optional<glm::vec3> get_intersection(const Ray& ray, const Triangle& triangle, float* distance_along_ray = nullptr);
 	//@returns If the planes are parallel, std::nullopt is returned. If there is an intersection, the Line of intersection is returned.
 	std::optional<Line> get_intersection(const Plane& plane_1, const Plane& plane_2);
 	std::optional<glm::vec3> get_intersection(const Plane& plane, const Sphere& sphere);
@@ -103,6 +130,9 @@ namespace Geometry
 //==============================================================================================================================
 	bool intersecting(const AABB& AABB_1,         const AABB& AABB_2);
 	bool intersecting(const AABB& AABB,           const Ray& ray);
+	bool intersecting(const AABB& AABB,           const Sphere& sphere);
+	// Conservative, AABBs outside the frustrum near its edges where no single plane separates them are reported as intersecting.
+	bool intersecting(const Frustrum& frustrum,   const AABB& AABB);
 	bool intersecting(const Line& line,           const Triangle& triangle);
 	bool intersecting(const Plane& plane_1,       const Plane& plane_2);
 	bool intersecting(const Plane& plane,         const Sphere& sphere);
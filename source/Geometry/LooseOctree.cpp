@@ -0,0 +1,203 @@
+#include "LooseOctree.hpp"
+
+#include "Utility/Logger.hpp"
+
+#include "glm/glm.hpp"
+
+#include <cmath>
+
+namespace Geometry
+{
+	// Is p_point within the cube cell at p_center with p_half_size.
+	static bool in_cell(const glm::vec3& p_point, const glm::vec3& p_center, float p_half_size)
+	{
+		const auto offset = glm::abs(p_point - p_center);
+		return offset.x <= p_half_size && offset.y <= p_half_size && offset.z <= p_half_size;
+	}
+
+	LooseOctree::LooseOctree(const AABB& p_bounds, size_t p_max_depth)
+		: m_max_depth{p_max_depth}
+		, m_nodes{}
+		, m_free_nodes{}
+		, m_items{}
+		, m_first_free_item{Invalid_item}
+		, m_item_count{0}
+	{
+		ASSERT_THROW(m_max_depth <= Max_depth, "[OCTREE] Max depth exceeds LooseOctree::Max_depth.");
+
+		const auto size = p_bounds.get_size();
+		const float half_size = std::max({size.x, size.y, size.z, std::numeric_limits<float>::epsilon()}) / 2.f;
+		const auto center = p_bounds.get_center();
+		m_nodes.push_back(Node{AABB(center - glm::vec3(half_size * 2.f), center + glm::vec3(half_size * 2.f)), center, half_size, 0, Invalid_node, {}, Invalid_item, 0});
+		m_nodes[0].children.fill(Invalid_node);
+	}
+
+	LooseOctree::ItemID LooseOctree::insert(const AABB& p_AABB)
+	{
+		ItemID item = m_first_free_item;
+		if (item != Invalid_item)
+			m_first_free_item = m_items[item].next;
+		else
+		{
+			ASSERT_THROW(m_items.size() < Invalid_item, "[OCTREE] Too many items, item IDs are stored as uint32_t.");
+			item = static_cast<ItemID>(m_items.size());
+			m_items.push_back({});
+		}
+
+		m_items[item].bounds = p_AABB;
+		link(item, find_node(p_AABB));
+		m_item_count++;
+		return item;
+	}
+	void LooseOctree::move(ItemID p_item, const AABB& p_AABB)
+	{
+		ASSERT_THROW(contains(p_item), "[OCTREE] Moving an item not in the octree.");
+
+		auto& item = m_items[p_item];
+		item.bounds = p_AABB;
+
+		// Most moves are small enough the item stays in the same node.
+		const auto& node = m_nodes[item.node];
+		if (in_cell(p_AABB.get_center(), node.center, node.half_size) && fitting_depth(p_AABB) == node.depth)
+			return;
+
+		const auto old_node = item.node;
+		unlink(p_item);
+		link(p_item, find_node(p_AABB));
+		prune(old_node);
+	}
+	void LooseOctree::remove(ItemID p_item)
+	{
+		ASSERT_THROW(contains(p_item), "[OCTREE] Removing an item not in the octree.");
+
+		const auto node = m_items[p_item].node;
+		unlink(p_item);
+		prune(node);
+
+		m_items[p_item].node = Invalid_node;
+		m_items[p_item].next = m_first_free_item;
+		m_first_free_item    = p_item;
+		m_item_count--;
+	}
+	void LooseOctree::clear()
+	{
+		m_nodes.resize(1);
+		m_nodes[0].children.fill(Invalid_node);
+		m_nodes[0].first_item = Invalid_item;
+		m_nodes[0].item_count = 0;
+		m_free_nodes.clear();
+		m_items.clear();
+		m_first_free_item = Invalid_item;
+		m_item_count      = 0;
+	}
+
+	LooseOctree::Statistics LooseOctree::get_statistics() const
+	{
+		Statistics statistics;
+		for_each_node([&](const NodeStatistics& p_node)
+		{
+			statistics.node_count++;
+			statistics.item_count += p_node.item_count;
+			statistics.empty_node_count += p_node.item_count == 0;
+			statistics.max_node_item_count = std::max(statistics.max_node_item_count, p_node.item_count);
+			statistics.max_depth           = std::max(statistics.max_depth, p_node.depth);
+			statistics.nodes_per_depth[p_node.depth]++;
+			statistics.items_per_depth[p_node.depth] += p_node.item_count;
+		});
+		return statistics;
+	}
+
+	size_t LooseOctree::fitting_depth(const AABB& p_AABB) const
+	{
+		// An item fits in the loose bounds of a node whose cell contains its center if its half size is at most the cell half size.
+		const auto size = p_AABB.get_size();
+		const float half_size = std::max({size.x, size.y, size.z}) / 2.f;
+		if (half_size <= 0.f)
+			return m_max_depth;
+
+		const float depth = std::floor(std::log2(m_nodes[0].half_size / half_size));
+		size_t fitting = depth <= 0.f ? 0 : std::min(static_cast<size_t>(depth), m_max_depth);
+		// Guard against log2 rounding up to a node slightly too small for the item.
+		while (fitting > 0 && std::ldexp(m_nodes[0].half_size, -static_cast<int>(fitting)) < half_size)
+			fitting--;
+		return fitting;
+	}
+	uint32_t LooseOctree::find_node(const AABB& p_AABB)
+	{
+		const auto center = p_AABB.get_center();
+		if (!in_cell(center, m_nodes[0].center, m_nodes[0].half_size))
+			return 0; // Outside the root cell.
+
+		const size_t depth = fitting_depth(p_AABB);
+		uint32_t node = 0;
+		for (size_t d = 0; d < depth; d++)
+		{
+			const auto& node_center = m_nodes[node].center;
+			const int octant = (center.x >= node_center.x ? 1 : 0) | (center.y >= node_center.y ? 2 : 0) | (center.z >= node_center.z ? 4 : 0);
+			if (m_nodes[node].children[octant] == Invalid_node)
+			{
+				const auto child = add_node(node, octant);
+				m_nodes[node].children[octant] = child;
+			}
+			node = m_nodes[node].children[octant];
+		}
+		return node;
+	}
+	uint32_t LooseOctree::add_node(uint32_t p_parent, int p_octant)
+	{
+		const auto& parent = m_nodes[p_parent];
+		const float half_size = parent.half_size / 2.f;
+		const auto center = parent.center + glm::vec3(p_octant & 1 ? half_size : -half_size, p_octant & 2 ? half_size : -half_size, p_octant & 4 ? half_size : -half_size);
+		auto node = Node{AABB(center - glm::vec3(half_size * 2.f), center + glm::vec3(half_size * 2.f)), center, half_size, parent.depth + 1, p_parent, {}, Invalid_item, 0};
+		node.children.fill(Invalid_node);
+
+		if (!m_free_nodes.empty())
+		{
+			const auto index = m_free_nodes.back();
+			m_free_nodes.pop_back();
+			m_nodes[index] = node;
+			return index;
+		}
+		ASSERT_THROW(m_nodes.size() < Invalid_node, "[OCTREE] Too many nodes, node indices are stored as uint32_t.");
+		m_nodes.push_back(node);
+		return static_cast<uint32_t>(m_nodes.size() - 1);
+	}
+	void LooseOctree::link(ItemID p_item, uint32_t p_node)
+	{
+		auto& item = m_items[p_item];
+		auto& node = m_nodes[p_node];
+		item.node     = p_node;
+		item.previous = Invalid_item;
+		item.next     = node.first_item;
+		if (node.first_item != Invalid_item)
+			m_items[node.first_item].previous = p_item;
+		node.first_item = p_item;
+		node.item_count++;
+	}
+	void LooseOctree::unlink(ItemID p_item)
+	{
+		auto& item = m_items[p_item];
+		auto& node = m_nodes[item.node];
+		if (item.previous != Invalid_item)
+			m_items[item.previous].next = item.next;
+		else
+			node.first_item = item.next;
+		if (item.next != Invalid_item)
+			m_items[item.next].previous = item.previous;
+		node.item_count--;
+	}
+	void LooseOctree::prune(uint32_t p_node)
+	{
+		while (p_node != 0)
+		{
+			auto& node = m_nodes[p_node];
+			if (node.item_count > 0 || std::any_of(node.children.begin(), node.children.end(), [](uint32_t p_child) { return p_child != Invalid_node; }))
+				return;
+
+			auto& siblings = m_nodes[node.parent].children;
+			*std::find(siblings.begin(), siblings.end(), p_node) = Invalid_node;
+			m_free_nodes.push_back(p_node);
+			p_node = node.parent;
+		}
+	}
+} // namespace Geometry
\ No newline at end of file
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "AABB.hpp"
+#include "Frustrum.hpp"
+#include "Intersect.hpp"
+#include "Ray.hpp"
+#include "Sphere.hpp"
+
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Geometry
+{
+	// Loose octree over a set of items represented by their AABB, for scenes that need partitioning along all three axes.
+	// Each node covers a cube cell of its parent but accepts items whose AABB fits in the cell grown to twice its size (its loose bounds).
+	// An item is stored in the single node at the depth matching its size whose cell contains its center, so insert, move and remove never
+	// split an item across nodes and only touch the nodes on one root to leaf path.
+	// Items outside the root cell are kept in the root, which queries always test, so any AABB can be inserted.
+	// Items are referred to by the ItemID returned by insert, IDs of removed items are reused.
+	class LooseOctree
+	{
+	public:
+		using ItemID = uint32_t;
+		static constexpr ItemID Invalid_item   = std::numeric_limits<uint32_t>::max();
+		static constexpr size_t Max_depth      = 16;
+		static constexpr float Max_distance    = std::numeric_limits<float>::max();
+
+		// Occupancy of a single node, see for_each_node.
+		struct NodeStatistics
+		{
+			AABB bounds;       // The cell of the node.
+			AABB loose_bounds; // The cell grown to twice its size, every item in the node is within these unless the node is the root.
+			size_t depth;
+			size_t item_count;
+			size_t child_count;
+		};
+		// Occupancy of the whole tree, see get_statistics.
+		struct Statistics
+		{
+			size_t node_count          = 0;
+			size_t item_count          = 0;
+			size_t empty_node_count    = 0; // Nodes holding no items themselves, only kept as parents.
+			size_t max_node_item_count = 0;
+			size_t max_depth           = 0;
+			std::array<size_t, Max_depth + 1> nodes_per_depth = {};
+			std::array<size_t, Max_depth + 1> items_per_depth = {};
+		};
+
+		//@param p_bounds The region to partition, grown to a cube around its center. Items outside are kept in the root.
+		//@param p_max_depth The deepest nodes are created, items smaller than a node at this depth are stored at it. At most Max_depth.
+		explicit LooseOctree(const AABB& p_bounds, size_t p_max_depth = 8);
+
+		// Add an item with p_AABB, returning the ID to refer to it by.
+		ItemID insert(const AABB& p_AABB);
+		// Update the AABB of p_item. Stays in its node if it still belongs there, otherwise moves to the node it now belongs to.
+		void move(ItemID p_item, const AABB& p_AABB);
+		void remove(ItemID p_item);
+		void clear();
+
+		bool empty()                          const { return m_item_count == 0; }
+		size_t size()                         const { return m_item_count; }
+		bool contains(ItemID p_item)          const { return p_item < m_items.size() && m_items[p_item].node != Invalid_node; }
+		const AABB& get_AABB(ItemID p_item)   const { return m_items[p_item].bounds; }
+
+		// Call p_visitor with every node's occupancy, parents before children.
+		template <typename Visitor>
+		void for_each_node(Visitor&& p_visitor) const
+		{
+			std::array<uint32_t, Stack_size> stack;
+			size_t stack_size = 0;
+			stack[stack_size++] = 0;
+			while (stack_size > 0)
+			{
+				const auto& node = m_nodes[stack[--stack_size]];
+				size_t child_count = 0;
+				for (auto child : node.children)
+				{
+					if (child != Invalid_node)
+					{
+						stack[stack_size++] = child;
+						child_count++;
+					}
+				}
+				p_visitor(NodeStatistics{AABB(node.center - glm::vec3(node.half_size), node.center + glm::vec3(node.half_size)), node.loose_bounds, node.depth, node.item_count, child_count});
+			}
+		}
+		Statistics get_statistics() const;
+
+		// Call p_visitor with the ID of every item whose AABB intersects p_AABB.
+		template <typename Visitor>
+		void query(const AABB& p_AABB, Visitor&& p_visitor) const
+		{
+			find_items([&](const AABB& p_bounds) { return intersecting(p_bounds, p_AABB); }, p_visitor);
+		}
+		// Call p_visitor with the ID of every item whose AABB intersects p_sphere.
+		template <typename Visitor>
+		void query(const Sphere& p_sphere, Visitor&& p_visitor) const
+		{
+			find_items([&](const AABB& p_bounds) { return intersecting(p_bounds, p_sphere); }, p_visitor);
+		}
+		// Call p_visitor with the ID of every item whose AABB intersects p_frustrum, see intersecting(Frustrum, AABB).
+		// Nodes entirely inside the frustrum have every item under them visited without testing them.
+		template <typename Visitor>
+		void query(const Frustrum& p_frustrum, Visitor&& p_visitor) const
+		{
+			const auto planes = p_frustrum.inside_plane_equations();
+			// 0 if outside, 1 if intersecting, 2 if inside.
+			auto classify = [&planes](const AABB& p_bounds)
+			{
+				int result = 2;
+				for (const auto& plane : planes)
+				{
+					const auto normal = glm::vec3(plane);
+					const auto positive_vertex = glm::vec3(plane.x >= 0.f ? p_bounds.m_max.x : p_bounds.m_min.x, plane.y >= 0.f ? p_bounds.m_max.y : p_bounds.m_min.y, plane.z >= 0.f ? p_bounds.m_max.z : p_bounds.m_min.z);
+					const auto negative_vertex = glm::vec3(plane.x >= 0.f ? p_bounds.m_min.x : p_bounds.m_max.x, plane.y >= 0.f ? p_bounds.m_min.y : p_bounds.m_max.y, plane.z >= 0.f ? p_bounds.m_min.z : p_bounds.m_max.z);
+					if (glm::dot(normal, positive_vertex) + plane.w < 0.f)
+						return 0;
+					if (glm::dot(normal, negative_vertex) + plane.w < 0.f)
+						result = 1;
+				}
+				return result;
+			};
+
+			std::array<std::pair<uint32_t, bool>, Stack_size> stack; // Node index and if it is entirely inside the frustrum.
+			size_t stack_size = 0;
+			stack[stack_size++] = {0, false};
+			while (stack_size > 0)
+			{
+				const auto [node_index, inside] = stack[--stack_size];
+				const auto& node = m_nodes[node_index];
+				for (auto item = node.first_item; item != Invalid_item; item = m_items[item].next)
+				{
+					if (inside || classify(m_items[item].bounds) != 0)
+						p_visitor(item);
+				}
+				for (auto child : node.children)
+				{
+					if (child == Invalid_node)
+						continue;
+
+					if (inside)
+						stack[stack_size++] = {child, true};
+					else if (const int containment = classify(m_nodes[child].loose_bounds); containment != 0)
+						stack[stack_size++] = {child, containment == 2};
+				}
+			}
+		}
+		// Visit the items whose AABB p_ray intersects, nearest node first.
+		// As with BVH::traverse distances are the entry distance along p_ray and can be negative for AABBs around or behind the ray start.
+		//@param p_visitor Called with (item ID, entry distance) returning the distance to keep searching up to.
+		// Returning the distance of an accepted hit skips every node entered beyond it, returning the distance passed in visits every hit.
+		//@param p_max_distance Nodes and items entered beyond this distance along p_ray are skipped.
+		template <typename Visitor>
+		void traverse(const Ray& p_ray, Visitor&& p_visitor, float p_max_distance = Max_distance) const
+		{
+			std::array<std::pair<uint32_t, float>, Stack_size> stack; // Node index and the distance p_ray enters it.
+			size_t stack_size = 0;
+			stack[stack_size++] = {0, -Max_distance}; // The root is always visited for the items outside its bounds.
+			while (stack_size > 0)
+			{
+				const auto [node_index, node_entry] = stack[--stack_size];
+				if (node_entry > p_max_distance)
+					continue; // p_max_distance has shrunk since the node was pushed.
+
+				const auto& node = m_nodes[node_index];
+				float entry = 0.f;
+				for (auto item = node.first_item; item != Invalid_item; item = m_items[item].next)
+				{
+					if (get_intersection(m_items[item].bounds, p_ray, &entry) && entry <= p_max_distance)
+						p_max_distance = p_visitor(item, entry);
+				}
+
+				// Push the children furthest first so the nearest is visited first.
+				std::array<std::pair<uint32_t, float>, 8> children;
+				size_t child_count = 0;
+				for (auto child : node.children)
+				{
+					if (child != Invalid_node && get_intersection(m_nodes[child].loose_bounds, p_ray, &entry) && entry <= p_max_distance)
+						children[child_count++] = {child, entry};
+				}
+				std::sort(children.begin(), children.begin() + child_count, [](const auto& p_left, const auto& p_right) { return p_left.second > p_right.second; });
+				for (size_t i = 0; i < child_count; i++)
+					stack[stack_size++] = children[i];
+			}
+		}
+
+	private:
+		static constexpr uint32_t Invalid_node = std::numeric_limits<uint32_t>::max();
+		// Every node popped pushes at most 8 children, 7 more than it removes, bounding the traversal stacks by the depth.
+		static constexpr size_t Stack_size = Max_depth * 7 + 1;
+
+		struct Node
+		{
+			AABB loose_bounds;
+			glm::vec3 center;
+			float half_size;
+			size_t depth;
+			uint32_t parent;
+			std::array<uint32_t, 8> children; // Indexed by octant, bit 0 set for +X, bit 1 for +Y and bit 2 for +Z. Invalid_node if absent.
+			ItemID first_item;                 // Head of the list of items in this node linked by Item::next.
+			size_t item_count;
+		};
+		struct Item
+		{
+			AABB bounds;
+			uint32_t node; // The node holding the item, Invalid_node if the ID is free.
+			ItemID previous;
+			ItemID next;   // The next item in the node, or the next free ID if the ID is free.
+		};
+
+		size_t m_max_depth;
+		std::vector<Node> m_nodes;         // The root is always m_nodes[0].
+		std::vector<uint32_t> m_free_nodes;
+		std::vector<Item> m_items;
+		ItemID m_first_free_item;          // Head of the free IDs in m_items linked by Item::next.
+		size_t m_item_count;
+
+		// The node p_AABB belongs in, creating the nodes on the path to it.
+		uint32_t find_node(const AABB& p_AABB);
+		// The depth of the deepest node p_AABB fits in the loose bounds of.
+		size_t fitting_depth(const AABB& p_AABB) const;
+		uint32_t add_node(uint32_t p_parent, int p_octant);
+		void link(ItemID p_item, uint32_t p_node);
+		void unlink(ItemID p_item);
+		// Remove p_node and its ancestors while they hold no items or children. The root is never removed.
+		void prune(uint32_t p_node);
+
+		// Call p_visitor with every item whose AABB passes p_overlaps, skipping children whose loose bounds fail it.
+		template <typename Overlaps, typename Visitor>
+		void find_items(Overlaps&& p_overlaps, Visitor& p_visitor) const
+		{
+			std::array<uint32_t, Stack_size> stack;
+			size_t stack_size = 0;
+			stack[stack_size++] = 0; // The root is always visited for the items outside its bounds.
+			while (stack_size > 0)
+			{
+				const auto& node = m_nodes[stack[--stack_size]];
+				for (auto item = node.first_item; item != Invalid_item; item = m_items[item].next)
+				{
+					if (p_overlaps(m_items[item].bounds))
+						p_visitor(item);
+				}
+				for (auto child : node.children)
+				{
+					if (child != Invalid_node && p_overlaps(m_nodes[child].loose_bounds))
+						stack[stack_size++] = child;
+				}
+			}
+		}
+	};
+} // namespace Geometry
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <array>
 #include <concepts>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
 #include <vector>
@@ -22,41 +23,95 @@ namespace Geometry
 	// Quad tree data structure for 2D space partitioning.
 	// Each node has a T, a 2D axis-aligned bounding box (AABB) and can have 0 or 4 child nodes.
 	// The tree is stored in a vector and uses lazy deletion on node removal, leaving holes in the vector.
+	// Freed slots are tracked by their empty optional and reused from a free list, so checking and reusing a slot is constant time.
+	// Spatial queries (range, radius and nearest) find leaf nodes, which partition the root bounds, writing into caller buffers without allocating.
 	//@tparam T The type of data stored in each node alongside the AABB. If T has on_subdivide and on_merge methods, they will be called when the parent node is subdivided or merged.
 	template <typename T>
 	requires std::is_object_v<T>
 	class QuadTree
 	{
-		bool is_free(size_t index) const { return std::find(free_indices.begin(), free_indices.end(), index) != free_indices.end(); }
+		bool is_free(size_t index) const { return !nodes[index].has_value(); }
 		// Add a node to the tree. If there are no free indices, a new node is added to the end of the nodes vector.
 		// Otherwise, the node at a free index is replaced with the new node.
 		// add_node invalidates any iterators or pointers to Node objects.
 		// @returns The index of the new node.
 		template <typename U>
 		requires std::is_constructible_v<T, U&&>
-		size_t add_node(const AABB2D& bounds, U&& data, size_t depth)
+		size_t add_node(const AABB2D& bounds, U&& data, size_t depth, std::optional<size_t> parent_index)
 		{
 			if (free_indices.empty())
 			{
-				nodes.emplace_back(std::in_place, bounds, std::forward<U>(data), depth);
+				nodes.emplace_back(std::in_place, bounds, std::forward<U>(data), depth, parent_index);
 				return nodes.size() - 1;
 			}
 			else
 			{
-				nodes[free_indices.back()].emplace(bounds, std::forward<U>(data), depth);
+				nodes[free_indices.back()].emplace(bounds, std::forward<U>(data), depth, parent_index);
 				size_t index = free_indices.back();
 				free_indices.pop_back();
 				return index;
 			}
 		}
+		// Push the leaves under the root whose bounds pass overlaps into out_indices depth-first.
+		//@returns The number of leaves found, including any past the end of out_indices which are not written.
+		template <typename Overlaps>
+		size_t find_leaves(Overlaps&& overlaps, std::span<size_t> out_indices) const
+		{
+			if (empty() || !overlaps(nodes[0]->bounds))
+				return 0;
+
+			// Every internal node popped pushes at most 4 children, 3 more than it removes, so the stack is bounded by the tree depth.
+			std::array<size_t, Max_depth * 3 + 1> stack;
+			size_t stack_size = 0;
+			size_t found      = 0;
+			stack[stack_size++] = 0;
+
+			while (stack_size > 0)
+			{
+				const size_t index = stack[--stack_size];
+				const Node& node   = *nodes[index];
+				if (node.leaf())
+				{
+					if (found < out_indices.size())
+						out_indices[found] = index;
+					found++;
+					continue;
+				}
+
+				for (size_t i = 4; i-- > 0;)
+				{
+					const size_t child = (*node.children_indices)[i];
+					if (overlaps(nodes[child]->bounds))
+						stack[stack_size++] = child;
+				}
+			}
+			return found;
+		}
+		static float distance_squared(const AABB2D& bounds, const glm::vec2& point)
+		{
+			const auto offset = bounds.closest_point(point) - point;
+			return offset.x * offset.x + offset.y * offset.y;
+		}
+
 	public:
+		// The deepest a node can be subdivided to. Bounds the fixed size stacks used by the spatial queries.
+		static constexpr size_t Max_depth = 64;
+
+		// A leaf found by nearest and its squared distance from the query point, 0 if the leaf contains the point.
+		struct Neighbour
+		{
+			size_t index;
+			float distance_squared;
+		};
+
 		// A node in the quad tree.
 		// Node references are invalidated when the tree is modified.
 		struct Node
 		{
 			template <typename U>
 			requires std::is_constructible_v<T, U&&>
-			Node(const AABB2D& bounds, U&& data, size_t depth) : bounds{bounds}, data{std::forward<U>(data)}, children_indices{std::nullopt}, depth{depth} {}
+			Node(const AABB2D& bounds, U&& data, size_t depth, std::optional<size_t> parent_index = std::nullopt)
+				: bounds{bounds}, data{std::forward<U>(data)}, children_indices{std::nullopt}, parent_index{parent_index}, depth{depth} {}
 
 			bool leaf()           const { return !children_indices.has_value(); }
 			size_t top_left()     const { return (*children_indices)[0]; }
@@ -72,6 +127,7 @@ namespace Geometry
 			AABB2D bounds;
 			T data;
 			std::optional<std::array<size_t, 4>> children_indices; // top-left, top-right, bottom-right, bottom-left
+			std::optional<size_t> parent_index;                    // nullopt for the root node.
 			size_t depth;
 		};
 
@@ -90,14 +146,19 @@ namespace Geometry
 		}
 		// Reserve space for the specified number of nodes.
 		void reserve(size_t size) { nodes.reserve(size); }
-		//@returns The index of the node in the nodes vector.
+		//@returns The index of the node in the nodes vector. Constant time, the node is found among the children of its parent.
 		size_t node_index(const Node& node) const
 		{
-			// Search the nodes vector for the node.
-			auto it = std::find_if(nodes.begin(), nodes.end(), [&](const auto& optional_node) { return &(*optional_node) == &node; });
-			ASSERT_THROW(it != nodes.end(), "Node not found in tree.");
+			if (!node.parent_index.has_value())
+			{
+				ASSERT_THROW(!nodes.empty() && nodes[0].has_value() && &*nodes[0] == &node, "Node not found in tree.");
+				return 0; // The root is always the first node added.
+			}
 
-			return it - nodes.begin();
+			const auto& siblings = *nodes[*node.parent_index]->children_indices;
+			auto it = std::find_if(siblings.begin(), siblings.end(), [&](size_t index) { return &*nodes[index] == &node; });
+			ASSERT_THROW(it != siblings.end(), "Node not found in tree.");
+			return *it;
 		}
 		// Add a root node to the tree. Throws if a root node already exists.
 		//@param bounds The bounds of the root node.
@@ -107,7 +168,7 @@ namespace Geometry
 		size_t add_root_node(const AABB2D& bounds, U&& data)
 		{
 			if (!empty()) throw std::runtime_error("Root node already exists.");
-			return add_node(bounds, std::forward<U>(data), 0);
+			return add_node(bounds, std::forward<U>(data), 0, std::nullopt);
 		}
 		Node& root_node()
 		{
@@ -130,6 +191,8 @@ namespace Geometry
 		{
 			if (node.children_indices.has_value())
 				throw std::runtime_error("Node already subdivided");
+			if (node.depth >= Max_depth)
+				throw std::runtime_error("Node at maximum depth");
 
 			const auto& bounds = node.bounds;
 			const auto center  = bounds.center();
@@ -147,7 +210,7 @@ namespace Geometry
 
 			std::array<size_t, 4> indices;
 			size_t i = 0;
-			((indices[i] = add_node(child_bounds[i], std::forward<Args>(child_data), new_depth), ++i), ...);
+			((indices[i] = add_node(child_bounds[i], std::forward<Args>(child_data), new_depth, index), ++i), ...);
 
 			Node& parent_node_after = *nodes[index];
 			parent_node_after.children_indices = indices;
@@ -158,20 +221,26 @@ namespace Geometry
 
 			return indices[0]; // Return top-left child index
 		}
-		// Merge the children of this node into the node. Deletes the children nodes
+		// Merge the children of this node into the node. Deletes the children nodes and any of their descendants.
 		// Does not invalidate any iterators or pointers to the nodes
 		void merge(Node& node)
 		{
 			if (node.leaf())
 				throw std::runtime_error("Cannot merge a leaf node.");
 
-			auto& children = *node.children_indices;
-
-			// Delete the children and store their indices in the free_indices vector
-			for (size_t i = 0; i < 4; ++i)
+			// Delete the descendants and store their indices in the free_indices vector.
+			// Grandchildren are deleted too, leaving them would leave nodes with a freed parent_index.
+			std::vector<size_t> stack(node.children_indices->begin(), node.children_indices->end());
+			while (!stack.empty())
 			{
-				free_indices.push_back(children[i]);
-				nodes[children[i]].reset();
+				size_t index = stack.back();
+				stack.pop_back();
+
+				if (!nodes[index]->leaf())
+					stack.insert(stack.end(), nodes[index]->children_indices->begin(), nodes[index]->children_indices->end());
+
+				free_indices.push_back(index);
+				nodes[index].reset();
 			}
 
 			node.children_indices.reset();
@@ -230,17 +299,33 @@ namespace Geometry
 		template <typename Func>
 		void breadth_first_traversal(Func&& func) { breadth_first_traversal(root_node(), func); }
 		// Breadth-first traversal starting from the specified node.
+		// The queue is a ring buffer doubling in size when full, each node is pushed and popped once.
 		template <typename Func>
 		requires std::invocable<Func, Node&>
 		void breadth_first_traversal(Node& start_node, Func&& func)
 		{
-			std::vector<size_t> queue;
-			queue.push_back(node_index(start_node));
+			std::vector<size_t> queue(16); // Size kept a power of two to wrap with a mask.
+			size_t head  = 0;
+			size_t count = 0;
+			auto push = [&](size_t index)
+			{
+				if (count == queue.size())
+				{// Unwrap into a buffer twice the size.
+					std::vector<size_t> larger(queue.size() * 2);
+					for (size_t i = 0; i < count; ++i)
+						larger[i] = queue[(head + i) & (queue.size() - 1)];
+					queue = std::move(larger);
+					head  = 0;
+				}
+				queue[(head + count++) & (queue.size() - 1)] = index;
+			};
+			push(node_index(start_node));
 
-			while (!queue.empty())
+			while (count > 0)
 			{
-				size_t index = queue.front();
-				queue.erase(queue.begin());
+				size_t index = queue[head];
+				head = (head + 1) & (queue.size() - 1);
+				--count;
 
 				if (is_free(index))
 					continue;
@@ -250,8 +335,66 @@ namespace Geometry
 
 				if (!node.leaf())
 					for (size_t i = 0; i < 4; ++i)
-						queue.push_back((*node.children_indices)[i]);
+						push((*node.children_indices)[i]);
+			}
+		}
+
+		// Find the leaf nodes whose bounds overlap range, touching bounds included.
+		//@param out_indices Filled with the indices of the leaves found in depth-first order, up to its size.
+		//@returns The number of leaves found. If this exceeds the size of out_indices the remainder were not written, query again with a larger buffer.
+		size_t query(const AABB2D& range, std::span<size_t> out_indices) const
+		{
+			return find_leaves([&](const AABB2D& bounds) { return bounds.intersects(range); }, out_indices);
+		}
+		// Find the leaf nodes whose bounds overlap the circle at center with radius.
+		//@param out_indices Filled with the indices of the leaves found in depth-first order, up to its size.
+		//@returns The number of leaves found. If this exceeds the size of out_indices the remainder were not written, query again with a larger buffer.
+		size_t query(const glm::vec2& center, float radius, std::span<size_t> out_indices) const
+		{
+			return find_leaves([&](const AABB2D& bounds) { return distance_squared(bounds, center) <= radius * radius; }, out_indices);
+		}
+		// Find the out_nearest.size() leaf nodes with bounds nearest to point.
+		// Searches nearest child first and skips any node further than the furthest neighbour found so far once out_nearest is full.
+		//@param out_nearest Filled with the nearest leaves sorted by ascending distance.
+		//@returns The number of neighbours written, less than the size of out_nearest only if the tree has fewer leaves.
+		size_t nearest(const glm::vec2& point, std::span<Neighbour> out_nearest) const
+		{
+			if (empty() || out_nearest.empty())
+				return 0;
+
+			std::array<Neighbour, Max_depth * 3 + 1> stack;
+			size_t stack_size = 0;
+			size_t found      = 0;
+			stack[stack_size++] = {0, distance_squared(nodes[0]->bounds, point)};
+
+			while (stack_size > 0)
+			{
+				const auto candidate = stack[--stack_size];
+				if (found == out_nearest.size() && candidate.distance_squared >= out_nearest.back().distance_squared)
+					continue; // Nothing under this node can be nearer than the neighbours found.
+
+				const Node& node = *nodes[candidate.index];
+				if (node.leaf())
+				{// Insertion sort into the neighbours, dropping the furthest when full.
+					size_t i = found < out_nearest.size() ? found++ : found - 1;
+					for (; i > 0 && out_nearest[i - 1].distance_squared > candidate.distance_squared; i--)
+						out_nearest[i] = out_nearest[i - 1];
+					out_nearest[i] = candidate;
+					continue;
+				}
+
+				std::array<Neighbour, 4> children;
+				for (size_t i = 0; i < 4; ++i)
+				{
+					const size_t child = (*node.children_indices)[i];
+					children[i] = {child, distance_squared(nodes[child]->bounds, point)};
+				}
+				// Push the furthest first so the nearest child is searched first.
+				std::sort(children.begin(), children.end(), [](const Neighbour& a, const Neighbour& b) { return a.distance_squared > b.distance_squared; });
+				for (const auto& child : children)
+					stack[stack_size++] = child;
 			}
+			return found;
 		}
 
 		struct QuadTreeIterator
@@ -295,18 +438,18 @@ namespace Geometry
 
 		Node& operator[](size_t index)
 		{
-			ASSERT(!is_free(index), "Cannot access a freed index.");
 			ASSERT(index < nodes.size(), "Index out of bounds.");
+			ASSERT(!is_free(index), "Cannot access a freed index.");
 			return *nodes[index];
 		}
 		const Node& operator[](size_t index) const
 		{
-			ASSERT(!is_free(index), "Cannot access a freed index.");
 			ASSERT(index < nodes.size(), "Index out of bounds.");
+			ASSERT(!is_free(index), "Cannot access a freed index.");
 			return *nodes[index];
 		}
 	private:
 		std::vector<std::optional<Node>> nodes; // Stores all the freed and active nodes.
-		std::vector<size_t> free_indices;       // Indices into nodes vector that are free.
+		std::vector<size_t> free_indices;       // Indices into nodes vector that are free, reused last in first out by add_node.
 	};
 }// namespace Geometry
\ No newline at end of file
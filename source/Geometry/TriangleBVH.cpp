@@ -0,0 +1,147 @@
+#include "TriangleBVH.hpp"
+#include "Intersect.hpp"
+#include "Ray.hpp"
+
+#include "glm/glm.hpp"
+
+#include <array>
+#include <limits>
+
+namespace Geometry
+{
+	// The bounds of each of p_triangles for the BVH build.
+	static std::vector<AABB> get_bounds(const std::vector<Triangle>& p_triangles)
+	{
+		std::vector<AABB> bounds;
+		bounds.reserve(p_triangles.size());
+		for (const auto& triangle : p_triangles)
+		{
+			auto triangle_bounds = AABB(triangle.m_point_1, triangle.m_point_1);
+			triangle_bounds.unite(triangle.m_point_2);
+			triangle_bounds.unite(triangle.m_point_3);
+			bounds.push_back(triangle_bounds);
+		}
+		return bounds;
+	}
+
+	// The AABB of p_AABB transformed by the affine p_transform.
+	// Grown by a few ULPs of its extent so rounding never leaves a transformed point of p_AABB outside, keeping the BVH pruning conservative.
+	static AABB transform(const AABB& p_AABB, const glm::mat4& p_transform)
+	{
+		const auto center = glm::vec3(p_transform * glm::vec4(p_AABB.get_center(), 1.f));
+		const auto half   = p_AABB.get_size() * 0.5f;
+		auto transformed_half = glm::vec3(0.f);
+		for (int j = 0; j < 3; j++)
+			transformed_half += glm::abs(glm::vec3(p_transform[j])) * half[j];
+
+		transformed_half += (glm::abs(center) + transformed_half) * (std::numeric_limits<float>::epsilon() * 4.f);
+		return AABB(center - transformed_half, center + transformed_half);
+	}
+	static Triangle transform(const Triangle& p_triangle, const glm::mat4& p_transform)
+	{
+		return Triangle(glm::vec3(p_transform * glm::vec4(p_triangle.m_point_1, 1.f)),
+		                glm::vec3(p_transform * glm::vec4(p_triangle.m_point_2, 1.f)),
+		                glm::vec3(p_transform * glm::vec4(p_triangle.m_point_3, 1.f)));
+	}
+
+	TriangleBVH::TriangleBVH(std::vector<Triangle>&& p_triangles)
+		: m_triangles{std::move(p_triangles)}
+		, m_BVH{get_bounds(m_triangles)}
+	{}
+
+	std::optional<TriangleBVH::Hit> TriangleBVH::get_intersection(const Ray& p_ray, float p_max_distance) const
+	{
+		std::optional<Hit> closest_hit;
+		m_BVH.traverse(p_ray, [&](size_t p_triangle, float)
+		{
+			float distance_along_ray = 0.f;
+			if (auto point = Geometry::get_intersection(p_ray, m_triangles[p_triangle], &distance_along_ray))
+			{
+				if (distance_along_ray <= p_max_distance)
+				{
+					p_max_distance = distance_along_ray;
+					closest_hit    = Hit{*point, distance_along_ray, p_triangle};
+				}
+			}
+			return p_max_distance;
+		}, p_max_distance);
+
+		return closest_hit;
+	}
+
+	bool TriangleBVH::intersecting(const Ray& p_ray, float p_max_distance) const
+	{
+		bool hit = false;
+		m_BVH.traverse(p_ray, [&](size_t p_triangle, float)
+		{
+			float distance_along_ray = 0.f;
+			if (Geometry::get_intersection(p_ray, m_triangles[p_triangle], &distance_along_ray) && distance_along_ray <= p_max_distance)
+			{
+				hit = true;
+				return -BVH::Max_distance; // Nothing is nearer, ends the traversal.
+			}
+			return p_max_distance;
+		}, p_max_distance);
+
+		return hit;
+	}
+
+	template <typename OnHit>
+	void TriangleBVH::find_intersections(const TriangleBVH& p_other, const glm::mat4& p_other_to_this, OnHit&& p_on_hit) const
+	{
+		const bool identity = p_other_to_this == glm::mat4(1.f);
+		std::array<TrianglePair, Batch_size> batch;
+		size_t batch_size = 0;
+		bool searching    = true;
+
+		// Test the gathered pairs, returning false once p_on_hit ends the search.
+		auto test_batch = [&]()
+		{
+			const size_t count = batch_size;
+			batch_size = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				const auto& other_triangle = p_other.m_triangles[batch[i].other_triangle];
+				const bool hit = identity ? Geometry::intersecting(m_triangles[batch[i].triangle], other_triangle)
+				                          : Geometry::intersecting(m_triangles[batch[i].triangle], transform(other_triangle, p_other_to_this));
+				if (hit && !p_on_hit(batch[i]))
+					return false;
+			}
+			return true;
+		};
+
+		m_BVH.traverse(p_other.m_BVH,
+			[&](const AABB& p_bounds, const AABB& p_other_bounds) { return Geometry::intersecting(p_bounds, identity ? p_other_bounds : transform(p_other_bounds, p_other_to_this)); },
+			[&](size_t p_triangle, size_t p_other_triangle)
+			{
+				batch[batch_size++] = TrianglePair{p_triangle, p_other_triangle};
+				if (batch_size == Batch_size)
+					searching = test_batch();
+				return searching;
+			});
+
+		if (searching)
+			test_batch();
+	}
+
+	std::optional<TriangleBVH::TrianglePair> TriangleBVH::get_intersection(const TriangleBVH& p_other, const glm::mat4& p_other_to_this) const
+	{
+		std::optional<TrianglePair> first_hit;
+		find_intersections(p_other, p_other_to_this, [&](const TrianglePair& p_pair)
+		{
+			first_hit = p_pair;
+			return false;
+		});
+		return first_hit;
+	}
+	std::vector<TriangleBVH::TrianglePair> TriangleBVH::get_intersections(const TriangleBVH& p_other, const glm::mat4& p_other_to_this) const
+	{
+		std::vector<TrianglePair> hits;
+		find_intersections(p_other, p_other_to_this, [&](const TrianglePair& p_pair)
+		{
+			hits.push_back(p_pair);
+			return true;
+		});
+		return hits;
+	}
+} // namespace Geometry
\ No newline at end of file
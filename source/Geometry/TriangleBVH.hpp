@@ -0,0 +1,68 @@
+#pragma once
+
+#include "BVH.hpp"
+#include "Triangle.hpp"
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace Geometry
+{
+	class Ray;
+
+	// A set of triangles partitioned by a BVH for ray queries that scale logarithmically with the triangle count.
+	// Queries are in the space the triangles are defined in, e.g. the model space of a mesh.
+	// Transform world space rays into that space by the inverse model matrix without normalising the direction,
+	// distances along the ray are then equal in both spaces and hits of different meshes can be compared directly.
+	class TriangleBVH
+	{
+	public:
+		struct Hit
+		{
+			glm::vec3 point;         // Point of intersection on the triangle.
+			float distance_along_ray; // Distance along the ray in multiples of the ray direction.
+			size_t triangle;          // Index of the triangle hit in triangles().
+		};
+		// A pair of intersecting triangles between two TriangleBVHs.
+		struct TrianglePair
+		{
+			size_t triangle;       // Index in triangles() of this.
+			size_t other_triangle; // Index in triangles() of the other TriangleBVH.
+		};
+
+		explicit TriangleBVH(std::vector<Triangle>&& p_triangles);
+
+		const std::vector<Triangle>& triangles() const { return m_triangles; }
+		const BVH& bvh()                         const { return m_BVH; }
+		// The bytes of the triangles and their BVH.
+		size_t memory_size()                     const { return m_triangles.size() * sizeof(Triangle) + m_BVH.memory_size(); }
+
+		// Find the closest triangle p_ray hits.
+		//@param p_max_distance Triangles hit beyond this distance along p_ray are ignored.
+		std::optional<Hit> get_intersection(const Ray& p_ray, float p_max_distance = BVH::Max_distance) const;
+		// Does p_ray hit any triangle before p_max_distance. Stops at the first triangle hit found which is cheaper than get_intersection.
+		bool intersecting(const Ray& p_ray, float p_max_distance = BVH::Max_distance) const;
+
+		// Find a pair of intersecting triangles between this and p_other, nullopt if the meshes do not overlap.
+		// Pairs are found descending both BVHs together so only triangles with overlapping AABBs are tested with intersecting(Triangle, Triangle).
+		// These are gathered and tested in batches of Batch_size, the first hit of the first batch holding one is returned.
+		//@param p_other_to_this Transforms the triangles of p_other into the space of this, e.g. inverse(model of this) * model of p_other.
+		std::optional<TrianglePair> get_intersection(const TriangleBVH& p_other, const glm::mat4& p_other_to_this = glm::mat4(1.f)) const;
+		// Find every pair of intersecting triangles between this and p_other, see get_intersection(TriangleBVH).
+		std::vector<TrianglePair> get_intersections(const TriangleBVH& p_other, const glm::mat4& p_other_to_this = glm::mat4(1.f)) const;
+
+	private:
+		static constexpr size_t Batch_size = 64;
+
+		std::vector<Triangle> m_triangles;
+		BVH m_BVH;
+
+		// Gather the candidate pairs of triangles with overlapping AABBs in batches, calling p_on_hit with each intersecting pair.
+		// Ends when p_on_hit returns false.
+		template <typename OnHit>
+		void find_intersections(const TriangleBVH& p_other, const glm::mat4& p_other_to_this, OnHit&& p_on_hit) const;
+	};
+} // namespace Geometry
\ No newline at end of file
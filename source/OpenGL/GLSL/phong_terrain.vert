@@ -1,10 +1,11 @@
 #version 460 core
 
-layout (location = 0) in vec3 VertexPosition;
-layout (location = 1) in vec3 VertexNormal;
-layout (location = 3) in vec2 VertexTexCoord;
+layout (location = 0) in float VertexHeight; // Quantised height normalised to [0, 1] over chunk_height.
+layout (location = 1) in vec2 VertexNormal;  // Octahedral encoded normal, see Data::TerrainVertex.
 
 uniform mat4 model;
+uniform vec4 chunk_grid;   // xy: grid position of the chunk's first vertex, z: cells between neighbouring vertices, w: vertices per row.
+uniform vec2 chunk_height; // x: height of a VertexHeight of 0, y: height between a VertexHeight of 0 and 1.
 
 layout(shared) uniform ViewProperties
 {
@@ -20,11 +21,26 @@ out VS_OUT {
 	vec2 tex_coord;
 } vs_out;
 
+// Inverse of the encoding in Data::TerrainVertex, the lower half of the octahedron is folded out over the corners.
+vec3 decode_octahedral(vec2 p_encoded)
+{
+	vec3 normal = vec3(p_encoded.x, 1.0 - abs(p_encoded.x) - abs(p_encoded.y), p_encoded.y);
+	float fold  = max(-normal.y, 0.0);
+	normal.x   += normal.x >= 0.0 ? -fold : fold;
+	normal.z   += normal.z >= 0.0 ? -fold : fold;
+	return normalize(normal);
+}
+
 void main()
 {
-	vs_out.position        = vec3(model * vec4(VertexPosition, 1.0));
+	// Vertices are row-major over the chunk with X varying fastest, the grid position is implied by the index.
+	int columns         = int(chunk_grid.w);
+	vec2 grid           = chunk_grid.xy + vec2(gl_VertexID % columns, gl_VertexID / columns) * chunk_grid.z;
+	vec3 local_position = vec3(grid.x, chunk_height.x + VertexHeight * chunk_height.y, grid.y);
+
+	vs_out.position        = vec3(model * vec4(local_position, 1.0));
 	vs_out.camera_position = viewProperties.camera_position;
-	vs_out.tex_coord       = VertexTexCoord;
-	vs_out.normal          = mat3(transpose(inverse(model))) * VertexNormal;
-	gl_Position            = viewProperties.projection * viewProperties.view * model * vec4(VertexPosition, 1.0);
+	vs_out.tex_coord       = grid;
+	vs_out.normal          = mat3(transpose(inverse(model))) * decode_octahedral(VertexNormal);
+	gl_Position            = viewProperties.projection * viewProperties.view * model * vec4(local_position, 1.0);
 }
\ No newline at end of file
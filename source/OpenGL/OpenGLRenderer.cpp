@@ -6,8 +6,10 @@
 #include "Component/FirstPersonCamera.hpp"
 #include "Component/Lights.hpp"
 #include "Component/Terrain.hpp"
+#include "Component/TerrainStream.hpp"
 #include "Component/Transform.hpp"
 #include "ECS/Storage.hpp"
+#include "Geometry/Frustrum.hpp"
 #include "System/AssetManager.hpp"
 #include "System/SceneSystem.hpp"
 
@@ -50,6 +52,23 @@ namespace OpenGL
 		, m_screen_quad{make_screen_quad_mesh()}
 		, m_post_processing_options{}
 		, m_draw_shadows{false}
+		, m_frustrum_culling{true}
+		, m_cull_entities{}
+		, m_cull_local_AABBs{}
+		, m_cull_positions{}
+		, m_cull_orientations{}
+		, m_cull_scales{}
+		, m_cull_world_AABBs{}
+		, m_cull_plane_cache{}
+		, m_cull_visible{}
+		, m_culled_count{0}
+		, m_terrain_chunk_AABBs{}
+		, m_terrain_plane_cache{}
+		, m_terrain_visible{}
+		, m_terrain_visible_chunks{}
+		, m_terrain_stream_meshes{}
+		, m_terrain_chunk_count{0}
+		, m_terrain_culled_chunk_count{0}
 		, m_draw_grid{true}
 	{
 		#ifdef Z_DEBUG // Ensure the uniform block layout matches the Component::ViewInformation struct layout for direct memory copy.
@@ -114,16 +133,51 @@ namespace OpenGL
 		const auto& point_light_buffer       = m_phong_renderer.get_point_lights_buffer();
 		const auto& spot_light_buffer        = m_phong_renderer.get_spot_lights_buffer();
 
-		entities.foreach([&](ECS::Entity& p_entity, Component::Transform& p_transform, Component::Mesh& mesh_comp)
+		{// Cull the mesh entities outside the view frustrum before building their draw calls.
+			m_cull_entities.clear();
+			m_cull_local_AABBs.clear();
+			m_cull_positions.clear();
+			m_cull_orientations.clear();
+			m_cull_scales.clear();
+			entities.foreach([&](ECS::Entity& p_entity, Component::Transform& p_transform, Component::Mesh& mesh_comp)
+			{
+				if (mesh_comp.m_mesh)
+				{
+					m_cull_entities.push_back({p_entity, &p_transform, &mesh_comp});
+					m_cull_local_AABBs.push_back(mesh_comp.m_mesh->AABB);
+					m_cull_positions.push_back(p_transform.m_position);
+					m_cull_orientations.push_back(p_transform.m_orientation);
+					m_cull_scales.push_back(p_transform.m_scale);
+				}
+			});
+
+			m_cull_visible.assign(m_cull_entities.size(), 1);
+			m_cull_plane_cache.resize(m_cull_entities.size(), 0);
+			m_culled_count = 0;
+			if (m_frustrum_culling)
+			{
+				m_cull_world_AABBs.resize(m_cull_entities.size());
+				Geometry::AABB::transform(m_cull_local_AABBs, m_cull_positions, m_cull_orientations, m_cull_scales, m_cull_world_AABBs);
+
+				const auto& view_info = m_scene_system.get_current_scene_view_info();
+				const auto frustrum   = Geometry::Frustrum(view_info.m_projection * view_info.m_view);
+				m_culled_count = m_cull_entities.size() - frustrum.cull(m_cull_world_AABBs, m_cull_plane_cache, m_cull_visible);
+			}
+		}
+
+		for (size_t i = 0; i < m_cull_entities.size(); i++)
 		{
-			if (mesh_comp.m_mesh)
+			if (m_cull_visible[i])
 			{
+				auto& entity    = m_cull_entities[i].entity;
+				auto& transform = *m_cull_entities[i].transform;
+				auto& mesh_comp = *m_cull_entities[i].mesh;
 				Shader* mesh_shader = nullptr;
 				DrawCall dc;
 
-				if (entities.has_components<Component::Texture>(p_entity))
+				if (entities.has_components<Component::Texture>(entity))
 				{
-					auto& texComponent = entities.get_component<Component::Texture>(p_entity);
+					auto& texComponent = entities.get_component<Component::Texture>(entity);
 					dc.set_SSBO("DirectionalLightsBuffer", directional_light_buffer);
 					dc.set_SSBO("PointLightsBuffer",       point_light_buffer);
 					dc.set_SSBO("SpotLightsBuffer",        spot_light_buffer);
@@ -171,14 +225,42 @@ namespace OpenGL
 				}
 
 				dc.set_UBO("ViewProperties", m_view_properties_buffer);
-				dc.set_uniform("model", p_transform.get_model());
+				dc.set_uniform("model", transform.get_model());
 				dc.submit(*mesh_shader, mesh_comp.m_mesh->get_VAO(), m_screen_framebuffer);
 			}
-		});
+		}
+
+		{// Draw terrain chunks in the view frustrum, each at the LOD chosen for its distance to the view.
+			const auto& view_info = m_scene_system.get_current_scene_view_info();
+			const auto frustrum   = Geometry::Frustrum(view_info.m_projection * view_info.m_view);
+			m_terrain_chunk_count        = 0;
+			m_terrain_culled_chunk_count = 0;
+
+			// Terrain vertices only hold a height and normal, the chunk's uniforms place them on the grid.
+			auto submit_terrain_chunk = [&](DrawCall p_draw_call, const Data::TerrainMesh& p_mesh)
+			{
+				p_draw_call.set_uniform("chunk_grid",   glm::vec4(p_mesh.first_sample, p_mesh.step, static_cast<float>(p_mesh.columns)));
+				p_draw_call.set_uniform("chunk_height", glm::vec2(p_mesh.min_height, p_mesh.height_range));
+				p_draw_call.submit(m_terrain_shader, p_mesh.get_VAO(), m_screen_framebuffer);
+			};
 
-		{// Draw terrain
 			entities.foreach([&](Component::Terrain& p_terrain)
 			{
+				p_terrain.update_chunks(glm::vec3(view_info.m_view_position));
+				const auto chunks = p_terrain.m_chunks.chunks();
+
+				m_terrain_chunk_AABBs.clear();
+				for (const auto& chunk : chunks)
+					m_terrain_chunk_AABBs.emplace_back(chunk.bounds.m_min + p_terrain.m_position, chunk.bounds.m_max + p_terrain.m_position);
+				m_terrain_visible.assign(chunks.size(), 1);
+				m_terrain_plane_cache.resize(m_terrain_chunk_count + chunks.size(), 0);
+				if (m_frustrum_culling)
+				{
+					const auto plane_cache = std::span<uint8_t>(m_terrain_plane_cache).subspan(m_terrain_chunk_count, chunks.size());
+					m_terrain_culled_chunk_count += chunks.size() - frustrum.cull(m_terrain_chunk_AABBs, plane_cache, m_terrain_visible);
+				}
+				m_terrain_chunk_count += chunks.size();
+
 				DrawCall dc;
 				dc.set_SSBO("DirectionalLightsBuffer", directional_light_buffer);
 				dc.set_SSBO("PointLightsBuffer",       point_light_buffer);
@@ -195,7 +277,61 @@ namespace OpenGL
 				dc.set_texture("rock",  p_terrain.m_rock_tex->m_GL_texture);
 				dc.set_texture("snow",  p_terrain.m_snow_tex->m_GL_texture);
 
-				dc.submit(m_terrain_shader, p_terrain.m_mesh.get_VAO(), m_screen_framebuffer);
+				m_terrain_visible_chunks.clear();
+				for (size_t i = 0; i < chunks.size(); i++)
+				{
+					if (m_terrain_visible[i])
+						m_terrain_visible_chunks.push_back(i);
+				}
+				p_terrain.build_chunk_meshes(m_terrain_visible_chunks);
+
+				for (auto chunk : m_terrain_visible_chunks)
+					submit_terrain_chunk(dc, p_terrain.get_chunk_mesh(chunk));
+			});
+
+			entities.foreach([&](Component::TerrainStream& p_stream)
+			{// Only uploads chunks the stream generated in the background, the rest of streaming never blocks the draw.
+				p_stream.update(glm::vec3(view_info.m_view_position));
+				const size_t chunk_count = p_stream.chunks().size();
+
+				m_terrain_chunk_AABBs.clear();
+				m_terrain_stream_meshes.clear();
+				for (const auto& [coord, chunk] : p_stream.chunks())
+				{
+					m_terrain_chunk_AABBs.emplace_back(chunk.bounds.m_min + p_stream.m_position, chunk.bounds.m_max + p_stream.m_position);
+					m_terrain_stream_meshes.push_back(&chunk.mesh);
+				}
+				m_terrain_visible.assign(chunk_count, 1);
+				m_terrain_plane_cache.resize(m_terrain_chunk_count + chunk_count, 0);
+				if (m_frustrum_culling)
+				{
+					const auto plane_cache = std::span<uint8_t>(m_terrain_plane_cache).subspan(m_terrain_chunk_count, chunk_count);
+					m_terrain_culled_chunk_count += chunk_count - frustrum.cull(m_terrain_chunk_AABBs, plane_cache, m_terrain_visible);
+				}
+				m_terrain_chunk_count += chunk_count;
+
+				DrawCall dc;
+				dc.set_SSBO("DirectionalLightsBuffer", directional_light_buffer);
+				dc.set_SSBO("PointLightsBuffer",       point_light_buffer);
+				dc.set_SSBO("SpotLightsBuffer",        spot_light_buffer);
+				dc.set_UBO("ViewProperties",           m_view_properties_buffer);
+
+				dc.set_uniform("model",                glm::translate(glm::identity<glm::mat4>(), p_stream.m_position));
+				dc.set_uniform("shininess",            1000000.f); // Force terrain to not be shiny.
+				dc.set_uniform("min_height", -p_stream.m_amplitude);
+				dc.set_uniform("max_height",  p_stream.m_amplitude);
+
+				// Textures can be cleared in the editor, draw those with the missing texture rather than dereferencing an empty ref.
+				auto texture_or_missing = [this](const TextureRef& p_texture) -> const OpenGL::Texture& { return p_texture ? p_texture->m_GL_texture : m_missing_texture->m_GL_texture; };
+				dc.set_texture("grass", texture_or_missing(p_stream.m_grass_tex));
+				dc.set_texture("rock",  texture_or_missing(p_stream.m_rock_tex));
+				dc.set_texture("snow",  texture_or_missing(p_stream.m_snow_tex));
+
+				for (size_t i = 0; i < chunk_count; i++)
+				{
+					if (m_terrain_visible[i])
+						submit_terrain_chunk(dc, *m_terrain_stream_meshes[i]);
+				}
 			});
 		}
 
@@ -207,6 +343,11 @@ namespace OpenGL
 	{
 		ImGui::Checkbox("Draw shadows", &m_draw_shadows);
 		ImGui::Checkbox("Draw grid",    &m_draw_grid);
+		ImGui::Checkbox("Frustrum culling", &m_frustrum_culling);
+		ImGui::SameLine();
+		ImGui::Text("Culled %zu/%zu meshes", m_culled_count, m_cull_entities.size());
+		ImGui::SameLine();
+		ImGui::Text("%zu/%zu terrain chunks", m_terrain_culled_chunk_count, m_terrain_chunk_count);
 
 		if (ImGui::Button("Reload Shaders"))
 			reload_shaders();
@@ -232,6 +373,7 @@ namespace OpenGL
 	{
 		m_draw_shadows            = true;
 		m_draw_grid               = true;
+		m_frustrum_culling        = true;
 		m_post_processing_options = {};
 	}
 	void OpenGLRenderer::reload_shaders()
@@ -9,10 +9,23 @@
 
 #include "Component/Mesh.hpp"
 #include "Component/Texture.hpp"
+#include "ECS/Entity.hpp"
+#include "Geometry/AABB.hpp"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/quaternion.hpp"
 
+#include <vector>
+
+namespace Component
+{
+	struct Transform;
+}
+namespace Data
+{
+	class TerrainMesh;
+}
 namespace System
 {
 	class AssetManager;
@@ -60,6 +73,33 @@ namespace OpenGL
 		Data::Mesh m_screen_quad;
 		PostProcessingOptions m_post_processing_options;
 		bool m_draw_shadows;
+		bool m_frustrum_culling;
+
+		// The mesh entities gathered by draw with their mesh AABB and Transform, culled against the view frustrum before any draw calls are built.
+		// The plane cache is indexed in gather order which is stable while no mesh entities are added or removed, see Geometry::Frustrum::cull.
+		struct MeshEntity
+		{
+			ECS::Entity entity;
+			Component::Transform* transform;
+			Component::Mesh* mesh;
+		};
+		std::vector<MeshEntity> m_cull_entities;
+		std::vector<Geometry::AABB> m_cull_local_AABBs;
+		std::vector<glm::vec3> m_cull_positions;
+		std::vector<glm::quat> m_cull_orientations;
+		std::vector<glm::vec3> m_cull_scales;
+		std::vector<Geometry::AABB> m_cull_world_AABBs;
+		std::vector<uint8_t> m_cull_plane_cache;
+		std::vector<uint8_t> m_cull_visible;
+		size_t m_culled_count; // Mesh entities skipped by the last draw for being outside the view frustrum.
+		// Bounds of the terrain chunks in world space, culled before drawing. The plane cache spans the chunks of every terrain in gather order.
+		std::vector<Geometry::AABB> m_terrain_chunk_AABBs;
+		std::vector<uint8_t> m_terrain_plane_cache;
+		std::vector<uint8_t> m_terrain_visible;
+		std::vector<size_t> m_terrain_visible_chunks;
+		std::vector<const Data::TerrainMesh*> m_terrain_stream_meshes; // Meshes of the resident chunks of a TerrainStream parallel to m_terrain_chunk_AABBs.
+		size_t m_terrain_chunk_count;        // Terrain chunks gathered by the last draw.
+		size_t m_terrain_culled_chunk_count; // Terrain chunks skipped by the last draw for being outside the view frustrum.
 
 	public:
 		bool m_draw_grid;
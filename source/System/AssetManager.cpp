@@ -5,6 +5,7 @@
 #include "Utility/MeshBuilder.hpp"
 #include "Utility/File.hpp"
 #include "Utility/Config.hpp"
+#include "Utility/Utility.hpp"
 
 #include "glm/vec3.hpp"
 
@@ -13,6 +14,7 @@
 namespace System
 {
 	enum class ShapeType : uint8_t { Cone, Cuboid, Cylinder, Plane, Sphere, Quad };
+	// The built-in shapes retain their triangles so raycasts against them hit exactly.
 	static Data::Mesh make_mesh(ShapeType p_shape_type)
 	{
 		switch (p_shape_type)
@@ -21,31 +23,31 @@ namespace System
 			{
 				auto mb = Utility::MeshBuilder<Data::Vertex, OpenGL::PrimitiveMode::Triangles, true>{};
 				mb.add_cone(glm::vec3(0.f, -1.f, 0.f), glm::vec3(0.f, 1.f, 0.f), 1.f, 16);
-				return mb.get_mesh();
+				return mb.get_mesh(true);
 			}
 			case ShapeType::Cuboid:
 			{
 				auto mb = Utility::MeshBuilder<Data::Vertex, OpenGL::PrimitiveMode::Triangles, true>{};
 				mb.add_cuboid(Geometry::Cuboid(glm::vec3(0.f)));
-				return mb.get_mesh();
+				return mb.get_mesh(true);
 			}
 			case ShapeType::Cylinder:
 			{
 				auto mb = Utility::MeshBuilder<Data::Vertex, OpenGL::PrimitiveMode::Triangles, true>{};
 				mb.add_cylinder(glm::vec3(0.f, -1.f, 0.f), glm::vec3(0.f, 1.f, 0.f), 1.f, 16);
-				return mb.get_mesh();
+				return mb.get_mesh(true);
 			}
 			case ShapeType::Sphere:
 			{
 				auto mb = Utility::MeshBuilder<Data::Vertex, OpenGL::PrimitiveMode::Triangles, true>{};
 				mb.add_icosphere(glm::vec3(0.f, 0.f, 0.f), 1.f, 4);
-				return mb.get_mesh();
+				return mb.get_mesh(true);
 			}
 			case ShapeType::Quad:
 			{
 				auto mb = Utility::MeshBuilder<Data::Vertex, OpenGL::PrimitiveMode::Triangles, true>{};
 				mb.add_quad(glm::vec3(-1.f, 0.f, -1.f), glm::vec3(1.f, 0.f, -1.f), glm::vec3(-1.f, 0.f, 1.f), glm::vec3(1.f, 0.f, 1.f));
-				return mb.get_mesh();
+				return mb.get_mesh(true);
 			}
 			default:
 				throw std::runtime_error("Invalid shape type");
@@ -92,16 +94,32 @@ namespace System
 			if (entry.is_regular_file() && entry.path().has_extension() && entry.path().extension() == ".obj")
 				m_available_models.push_back(entry.path());
 		});
+
+		// Keep released assets resident so switching back to a scene doesn't load them again.
+		m_texture_manager.set_cache_budget(Texture_cache_budget);
+		m_mesh_manager.set_cache_budget(Mesh_cache_budget);
 	}
 
 	MeshRef AssetManager::insert(Data::Mesh&& p_mesh_data)
 	{
 		return m_mesh_manager.insert(std::move(p_mesh_data));
 	}
+	MeshRef AssetManager::get_mesh(const std::string_view p_name, const std::function<Data::Mesh()>& p_build_mesh)
+	{
+		return m_mesh_manager.get_or_create_with(std::hash<std::string_view>{}(p_name), [&p_name](const Data::Mesh& p_mesh)
+		{
+			return p_mesh.name == p_name;
+		}, [&]()
+		{
+			auto mesh = p_build_mesh();
+			mesh.name = p_name;
+			return mesh;
+		});
+	}
 
 	TextureRef AssetManager::get_texture(const std::filesystem::path& p_file_path)
 	{
-		return m_texture_manager.get_or_create([&p_file_path](const Data::Texture& p_texture)
+		return m_texture_manager.get_or_create(std::filesystem::hash_value(p_file_path), [&p_file_path](const Data::Texture& p_texture)
 		{
 			return p_texture.filepath() == p_file_path;
 		}, p_file_path);
@@ -110,7 +128,29 @@ namespace System
 	{
 		return get_texture(Config::Texture_Directory / p_file_name);
 	}
+	void AssetManager::destroy_released()
+	{
+		m_texture_manager.destroy_released();
+		m_mesh_manager.destroy_released();
+	}
+
+	template <typename Manager>
+	static void draw_cache_UI(const char* p_label, Manager& p_manager)
+	{
+		const auto stats      = p_manager.cache_stats();
+		auto formatted_used   = Utility::format_number(static_cast<float>(stats.bytes) / (1024.f * 1024.f), 1);
+		auto formatted_budget = Utility::format_number(static_cast<float>(stats.budget) / (1024.f * 1024.f), 1);
 
+		ImGui::PushID(p_label);
+		ImGui::SeparatorText(p_label);
+		ImGui::Text("Cached: %zu of %zu resident", stats.count, p_manager.size());
+		ImGui::Text_Manual("Memory: %s/%sMB", formatted_used.c_str(), formatted_budget.c_str());
+		ImGui::Text("Hits: %zu Misses: %zu Evictions: %zu", stats.hits, stats.misses, stats.evictions);
+		int budget_MB = static_cast<int>(stats.budget / (1024 * 1024));
+		if (ImGui::Slider("Budget", budget_MB, 0, 2048, "%dMB"))
+			p_manager.set_cache_budget(static_cast<size_t>(budget_MB) * 1024 * 1024);
+		ImGui::PopID();
+	}
 	void AssetManager::draw_UI(bool* p_open)
 	{
 		const float button_size_factor = 0.1f;
@@ -180,6 +220,11 @@ namespace System
 				ImGui::EndGroup();
 			}
 		}
+		if (ImGui::CollapsingHeader("Cache"))
+		{
+			draw_cache_UI("Textures", m_texture_manager);
+			draw_cache_UI("Meshes", m_mesh_manager);
+		}
 		ImGui::End();
 	}
 
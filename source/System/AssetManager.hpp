@@ -5,6 +5,8 @@
 #include "Utility/ResourceManager.hpp"
 
 #include <filesystem>
+#include <functional>
+#include <string_view>
 #include <vector>
 
 namespace System
@@ -18,6 +20,10 @@ namespace System
 
 	class AssetManager
 	{
+		// Bytes of released textures and meshes kept resident for reuse.
+		static constexpr size_t Texture_cache_budget = 256 * 1024 * 1024;
+		static constexpr size_t Mesh_cache_budget    = 64 * 1024 * 1024;
+
 		TextureManager m_texture_manager;
 		MeshManager m_mesh_manager;
 
@@ -32,6 +38,12 @@ namespace System
 		//@param p_mesh_data The mesh data to insert by move.
 		//@returns A reference to the inserted mesh.
 		[[nodiscard]] MeshRef insert(Data::Mesh&& p_mesh_data);
+		// Get a mesh by name. The mesh is built by p_build_mesh if it has not been built before or was evicted from the cache since.
+		// Prefer this over insert for meshes built again each time they're used, e.g. by a scene, so released ones can be reused.
+		//@param p_name The name identifying the mesh, e.g. the path of the model it's loaded from.
+		//@param p_build_mesh Returns the mesh to insert, only called if no mesh with p_name is resident.
+		//@returns A reference to the mesh.
+		[[nodiscard]] MeshRef get_mesh(const std::string_view p_name, const std::function<Data::Mesh()>& p_build_mesh);
 
 		// Get a texture by file path. The texture is loaded if it has not been loaded before.
 		// @param p_file_path The path to the file to load.
@@ -42,6 +54,8 @@ namespace System
 		// @returns A reference to the texture.
 		[[nodiscard]] TextureRef get_texture(const std::string_view p_file_name);
 		[[nodiscard]] TextureRef get_texture(const char* p_file_name) { return get_texture(std::string_view(p_file_name)); }
+		// Destroy the textures and meshes released on other threads. Call on the main thread between frames, when no GPU work uses them.
+		void destroy_released();
 
 		void draw_UI(bool* p_open = nullptr);
 		//@param p_label The label to display for the selector.
@@ -3,17 +3,36 @@
 
 #include "Component/Collider.hpp"
 #include "Component/Mesh.hpp"
+#include "Component/RigidBody.hpp"
 #include "Component/Transform.hpp"
 #include "Component/Terrain.hpp"
 
+#include "Geometry/GJK.hpp"
 #include "Geometry/Point.hpp"
 #include "Geometry/Ray.hpp"
 #include "Geometry/Triangle.hpp"
 
+#include <algorithm>
+#include <limits>
+
 namespace System
 {
 	CollisionSystem::CollisionSystem(SceneSystem& p_scene_system) noexcept
 		: m_scene_system{p_scene_system}
+		, m_ray_BVH{}
+		, m_ray_targets{}
+		, m_ray_bounds{}
+		, m_ray_BVH_built_cost{0.f}
+		, m_ray_BVH_scene{nullptr}
+		, m_ray_BVH_mutex{}
+		, m_batch_colliders{}
+		, m_batch_local_AABBs{}
+		, m_batch_positions{}
+		, m_batch_orientations{}
+		, m_batch_scales{}
+		, m_batch_world_AABBs{}
+		, m_pair_caches{}
+		, m_pair_caches_mutex{}
 	{}
 
 	void CollisionSystem::update()
@@ -23,84 +42,385 @@ namespace System
 			p_collider.m_collided = false;
 		});
 
-		m_scene_system.get_current_scene_entities().foreach([&](Component::Transform& transform, Component::Collider& collider, Component::Mesh& mesh)
+		m_batch_colliders.clear();
+		m_batch_local_AABBs.clear();
+		m_batch_positions.clear();
+		m_batch_orientations.clear();
+		m_batch_scales.clear();
+
+		auto& scene = m_scene_system.get_current_scene_entities();
+		scene.foreach([&](ECS::Entity& p_entity, Component::Transform& transform, Component::Collider& collider, Component::Mesh& mesh)
 		{
-			collider.m_world_AABB = Geometry::AABB::transform(mesh.m_mesh->AABB, transform.m_position, glm::mat4_cast(transform.m_orientation), transform.m_scale);
+			if (is_asleep(p_entity))
+				return; // Sleeping bodies have not moved since their AABB was last updated.
+
+			m_batch_colliders.push_back(&collider);
+			m_batch_local_AABBs.push_back(mesh.m_mesh->AABB);
+			m_batch_positions.push_back(transform.m_position);
+			m_batch_orientations.push_back(transform.m_orientation);
+			m_batch_scales.push_back(transform.m_scale);
 		});
+
+		m_batch_world_AABBs.resize(m_batch_colliders.size());
+		Geometry::AABB::transform(m_batch_local_AABBs, m_batch_positions, m_batch_orientations, m_batch_scales, m_batch_world_AABBs);
+		for (size_t i = 0; i < m_batch_colliders.size(); i++)
+			m_batch_colliders[i]->m_world_AABB = m_batch_world_AABBs[i];
+
+		{// Pairs no longer overlapping won't be queried until they come back into contact, their cache would be stale by then.
+			std::lock_guard lock(m_pair_caches_mutex);
+			std::erase_if(m_pair_caches, [&scene](const auto& p_pair_cache)
+			{
+				const auto& [entity_1, entity_2] = p_pair_cache.first;
+				return !scene.has_components<Component::Collider>(entity_1) || !scene.has_components<Component::Collider>(entity_2)
+				    || !Geometry::intersecting(scene.get_component<Component::Collider>(entity_1).m_world_AABB, scene.get_component<Component::Collider>(entity_2).m_world_AABB);
+			});
+		}
+
+		std::lock_guard lock(m_ray_BVH_mutex);
+		update_ray_BVH();
+	}
+
+	void CollisionSystem::ensure_ray_BVH() const
+	{
+		auto& scene = m_scene_system.get_current_scene_entities();
+		if (m_ray_BVH_scene.load(std::memory_order_acquire) == &scene)
+			return;
+
+		std::lock_guard lock(m_ray_BVH_mutex);
+		if (m_ray_BVH_scene.load(std::memory_order_relaxed) != &scene) // Another query may have built it while this one waited.
+			update_ray_BVH();
 	}
 
-	std::optional<ContactPoint> CollisionSystem::get_collision(const ECS::Entity& p_entity, const ECS::Entity* p_collided_entity) const
+	void CollisionSystem::update_ray_BVH() const
 	{
 		auto& scene = m_scene_system.get_current_scene_entities();
-		if (scene.has_components<Component::Collider, Component::Mesh, Component::Transform>(p_entity))
+		m_ray_bounds.clear();
+
+		// Refitting keeps the items of the tree, it can only be reused while the targets are the same and in the same order.
+		bool targets_changed = m_ray_BVH_scene.load(std::memory_order_relaxed) != &scene;
+		size_t target_count  = 0;
+		auto add_target = [&](const ECS::Entity& p_entity, bool p_is_terrain, const Geometry::AABB& p_bounds)
+		{
+			if (target_count == m_ray_targets.size() || m_ray_targets[target_count].entity != p_entity || m_ray_targets[target_count].is_terrain != p_is_terrain)
+			{
+				targets_changed = true;
+				m_ray_targets.erase(m_ray_targets.begin() + target_count, m_ray_targets.end());
+				m_ray_targets.push_back({p_entity, p_is_terrain});
+			}
+			target_count++;
+			m_ray_bounds.push_back(p_bounds);
+		};
+		scene.foreach([&](ECS::Entity& p_entity, Component::Collider& p_collider)
+		{
+			add_target(p_entity, false, p_collider.m_world_AABB);
+		});
+		scene.foreach([&](ECS::Entity& p_entity, Component::Terrain& p_terrain)
+		{
+			add_target(p_entity, true, Geometry::AABB::transform(p_terrain.m_heightfield.get_AABB(), p_terrain.m_position, glm::identity<glm::mat4>(), glm::vec3(1.f)));
+		});
+		if (target_count != m_ray_targets.size())
+		{
+			targets_changed = true;
+			m_ray_targets.erase(m_ray_targets.begin() + target_count, m_ray_targets.end());
+		}
+
+		if (!targets_changed)
 		{
-			auto& collider  = scene.get_component<Component::Collider>(p_entity);
-			auto& mesh      = scene.get_component<Component::Mesh>(p_entity);
-			auto& transform = scene.get_component<Component::Transform>(p_entity);
+			bool bounds_changed = false;
+			for (size_t i = 0; i < m_ray_bounds.size() && !bounds_changed; i++)
+				bounds_changed = m_ray_bounds[i].m_min != m_ray_BVH.item_bounds(i).m_min || m_ray_bounds[i].m_max != m_ray_BVH.item_bounds(i).m_max;
+			if (!bounds_changed)
+				return; // Every body is asleep or static.
 
-			const auto rotation_matrix = glm::mat4_cast(transform.m_orientation);
-			collider.m_world_AABB      = Geometry::AABB::transform(mesh.m_mesh->AABB, transform.m_position, rotation_matrix, transform.m_scale);
-			collider.m_collided        = false;
+			m_ray_BVH.refit(m_ray_bounds);
+			if (m_ray_BVH.SAH_cost() <= m_ray_BVH_built_cost * Max_refit_cost_growth)
+				return;
+		}
+
+		m_ray_BVH            = Geometry::BVH(m_ray_bounds);
+		m_ray_BVH_built_cost = m_ray_BVH.SAH_cost();
+		m_ray_BVH_scene.store(&scene, std::memory_order_release);
+	}
 
-			scene.foreach([&](const ECS::Entity& p_entity_other, Component::Transform& p_transform_other, Component::Mesh& p_mesh_other, Component::Collider& p_collider_other)
-			{(void)p_mesh_other;
-				if (&collider != &p_collider_other)
+	bool CollisionSystem::is_valid(const RayTarget& p_target) const
+	{
+		auto& scene = m_scene_system.get_current_scene_entities();
+		return p_target.is_terrain ? scene.has_components<Component::Terrain>(p_target.entity) : scene.has_components<Component::Collider>(p_target.entity);
+	}
+
+	std::optional<ContactPoint> CollisionSystem::get_collision(const ECS::Entity& p_entity, ECS::Entity* p_collided_entity) const
+	{
+		auto& scene = m_scene_system.get_current_scene_entities();
+		if (!scene.has_components<Component::Collider, Component::Mesh, Component::Transform>(p_entity))
+			return std::nullopt;
+
+		auto& collider        = scene.get_component<Component::Collider>(p_entity);
+		const auto& mesh      = scene.get_component<Component::Mesh>(p_entity);
+		const auto& transform = scene.get_component<Component::Transform>(p_entity);
+		collider.m_collided   = false;
+		if (!mesh.m_mesh)
+			return std::nullopt;
+
+		// Broad phase: every other Collider whose AABB overlaps is paired with p_entity for the batched GJK narrow phase.
+		// The orientation of p_entity is inverted once for all its pairs. The entity with the lower ID is always hull_1 of a pair,
+		// so both entities of a pair query it alike and share its PairCache in m_pair_caches.
+		const auto& hull               = mesh.m_mesh->get_convex_hull();
+		const auto model               = transform.get_model();
+		const auto inverse_orientation = glm::inverse(transform.m_orientation);
+		std::vector<GJK::HullPair> pairs;
+		std::vector<ECS::Entity> pair_entities;
+		std::vector<PairKey> pair_keys;
+		scene.foreach([&](const ECS::Entity& p_entity_other, Component::Transform& p_transform_other, Component::Mesh& p_mesh_other, Component::Collider& p_collider_other)
+		{
+			if (&collider == &p_collider_other || !p_mesh_other.m_mesh || !Geometry::intersecting(collider.m_world_AABB, p_collider_other.m_world_AABB))
+				return;
+
+			const auto& hull_other               = p_mesh_other.m_mesh->get_convex_hull();
+			const auto model_other               = p_transform_other.get_model();
+			const auto inverse_orientation_other = glm::inverse(p_transform_other.m_orientation);
+			if (p_entity.ID < p_entity_other.ID)
+			{
+				pairs.push_back({&hull, model, inverse_orientation, &hull_other, model_other, inverse_orientation_other});
+				pair_keys.push_back({p_entity.ID, p_entity_other.ID});
+			}
+			else
+			{
+				pairs.push_back({&hull_other, model_other, inverse_orientation_other, &hull, model, inverse_orientation});
+				pair_keys.push_back({p_entity_other.ID, p_entity.ID});
+			}
+			pair_entities.push_back(p_entity_other);
+		});
+		if (pairs.empty())
+			return std::nullopt;
+
+		// Start from the separating axis and support vertices of the last query of each pair, written back once this query is done.
+		// Copied in and out under the lock as the two entities of a pair can be queried from different threads.
+		std::vector<GJK::PairCache> caches(pairs.size());
+		{
+			std::lock_guard lock(m_pair_caches_mutex);
+			for (size_t i = 0; i < pairs.size(); i++)
+				caches[i] = m_pair_caches[pair_keys[i]];
+		}
+		std::vector<size_t> intersecting;
+		std::vector<GJK::Simplex> simplices;
+		GJK::intersecting(pairs, caches, intersecting, simplices);
+
+		std::vector<GJK::CollisionPoint> collision_points;
+		if (!intersecting.empty())
+			GJK::EPA(pairs, intersecting, simplices, caches, collision_points);
+		{
+			std::lock_guard lock(m_pair_caches_mutex);
+			for (size_t i = 0; i < pairs.size(); i++)
+				m_pair_caches[pair_keys[i]] = caches[i];
+		}
+		if (intersecting.empty())
+			return std::nullopt;
+
+		// Respond to the deepest contact. EPA's normal points from hull_1 into hull_2, the response normal points out of the other into p_entity.
+		size_t deepest = 0;
+		for (size_t i = 1; i < collision_points.size(); i++)
+		{
+			if (collision_points[i].penetration_depth > collision_points[deepest].penetration_depth)
+				deepest = i;
+		}
+		collider.m_collided = true;
+		if (p_collided_entity)
+			*p_collided_entity = pair_entities[intersecting[deepest]];
+
+		const auto& collision_point = collision_points[deepest];
+		if (pair_keys[intersecting[deepest]].first == p_entity.ID)
+			return ContactPoint{glm::vec3(model * glm::vec4(collision_point.A, 1.f)), -collision_point.normal, collision_point.penetration_depth};
+		else
+			return ContactPoint{glm::vec3(model * glm::vec4(collision_point.B, 1.f)), collision_point.normal, collision_point.penetration_depth};
+	}
+
+	std::optional<TimeOfImpact> CollisionSystem::get_time_of_impact(const ECS::Entity& p_entity, const glm::vec3& p_displacement) const
+	{
+		auto& scene = m_scene_system.get_current_scene_entities();
+		if (!scene.has_components<Component::Collider>(p_entity))
+			return std::nullopt;
+
+		// Sweeping an AABB against another is equivalent to casting a ray from its center against the other grown by its half extents.
+		// Using the displacement as the ray direction makes the distance along the ray the fraction of the displacement travelled.
+		const auto& collider    = scene.get_component<Component::Collider>(p_entity);
+		const auto half_extents = collider.m_world_AABB.get_size() / 2.f;
+		const auto swept_AABB   = Geometry::AABB::unite(collider.m_world_AABB, Geometry::AABB(collider.m_world_AABB.m_min + p_displacement, collider.m_world_AABB.m_max + p_displacement));
+		const auto ray          = Geometry::Ray(collider.m_world_AABB.get_center(), p_displacement);
+
+		std::optional<TimeOfImpact> time_of_impact;
+		scene.foreach([&](const ECS::Entity& p_entity_other, Component::Collider& p_collider_other)
+		{
+			if (p_entity_other.ID == p_entity.ID || !Geometry::intersecting(swept_AABB, p_collider_other.m_world_AABB))
+				return;
+
+			const auto grown_AABB = Geometry::AABB(p_collider_other.m_world_AABB.m_min - half_extents, p_collider_other.m_world_AABB.m_max + half_extents);
+			float fraction = 0.f;
+			if (auto hit = Geometry::get_intersection(grown_AABB, ray, &fraction); hit && fraction <= 1.f)
+			{
+				// A Collider resting on the other starts the sweep touching it, its center already inside the grown AABB which the ray entered behind it.
+				// Treat these as hit at the start of the sweep so the motion into the face is still cut and the Collider doesn't sink through.
+				if (fraction < 0.f)
 				{
-					const auto rotation_matrix_other = glm::mat4_cast(p_transform_other.m_orientation);
-					p_collider_other.m_world_AABB    = Geometry::AABB::transform(mesh.m_mesh->AABB, p_transform_other.m_position, rotation_matrix_other, p_transform_other.m_scale);
+					for (int axis = 0; axis < 3; axis++)
+					{
+						if (ray.m_start[axis] < grown_AABB.m_min[axis] || ray.m_start[axis] > grown_AABB.m_max[axis])
+							return;
+					}
+					fraction = 0.f;
+					hit      = ray.m_start;
+				}
 
-					if (Geometry::intersecting(collider.m_world_AABB, p_collider_other.m_world_AABB)) // Broad phase AABB check
+				if (!time_of_impact || fraction < time_of_impact->fraction)
+				{// The face entered is the one the hit lies closest to.
+					const auto to_min = *hit - grown_AABB.m_min;
+					const auto to_max = grown_AABB.m_max - *hit;
+					glm::vec3 normal  = glm::vec3(0.f);
+					float closest     = std::numeric_limits<float>::max();
+					for (int axis = 0; axis < 3; axis++)
 					{
-						p_collided_entity = &p_entity_other;
-						collider.m_collided = true;
-						return;
+						for (const float side : {-1.f, 1.f})
+						{
+							const float distance = side < 0.f ? to_min[axis] : to_max[axis];
+							if (distance < closest)
+							{
+								closest      = distance;
+								normal       = glm::vec3(0.f);
+								normal[axis] = side;
+							}
+						}
 					}
+					time_of_impact = TimeOfImpact{fraction, normal};
 				}
-			});
+			}
+		});
+
+		return time_of_impact;
+	}
+
+	std::optional<ContactPoint> CollisionSystem::get_terrain_collision(const ECS::Entity& p_entity, ECS::Entity* p_terrain_entity) const
+	{
+		auto& scene = m_scene_system.get_current_scene_entities();
+		if (!scene.has_components<Component::Collider>(p_entity))
+			return std::nullopt;
+
+		const auto& AABB = scene.get_component<Component::Collider>(p_entity).m_world_AABB;
+		std::optional<ContactPoint> deepest;
+		scene.foreach([&](const ECS::Entity& p_entity_terrain, Component::Terrain& p_terrain)
+		{
+			// Heightfields are relative to the terrain position.
+			const auto local_AABB = Geometry::AABB(AABB.m_min - p_terrain.m_position, AABB.m_max - p_terrain.m_position);
+			if (auto contact = p_terrain.m_heightfield.get_contact(local_AABB))
+			{
+				if (!deepest || contact->penetration_depth > deepest->penetration_depth)
+				{
+					deepest = ContactPoint{contact->position + p_terrain.m_position, contact->normal, contact->penetration_depth};
+					if (p_terrain_entity)
+						*p_terrain_entity = p_entity_terrain;
+				}
+			}
+		});
+
+		return deepest;
+	}
+
+	bool CollisionSystem::is_asleep(const ECS::Entity& p_entity) const
+	{
+		auto& scene = m_scene_system.get_current_scene_entities();
+		return scene.has_components<Component::RigidBody>(p_entity) && scene.get_component<Component::RigidBody>(p_entity).m_asleep;
+	}
+
+	std::optional<float> CollisionSystem::get_exact_distance(const ECS::Entity& p_entity, const Geometry::Ray& p_ray, float p_AABB_distance, float p_max_distance) const
+	{
+		auto& scene = m_scene_system.get_current_scene_entities();
+		if (scene.has_components<Component::Terrain>(p_entity))
+		{
+			const auto& terrain = scene.get_component<Component::Terrain>(p_entity);
+			if (auto hit = terrain.m_heightfield.get_intersection(Geometry::Ray(p_ray.m_start - terrain.m_position, p_ray.m_direction), p_max_distance))
+				return hit->distance_along_ray;
+
+			return std::nullopt;
 		}
+		if (!scene.has_components<Component::Mesh, Component::Transform>(p_entity))
+			return p_AABB_distance;
+
+		const auto& mesh = scene.get_component<Component::Mesh>(p_entity);
+		if (!mesh.m_mesh || !mesh.m_mesh->triangle_BVH)
+			return p_AABB_distance;
+
+		// Transforming the direction without normalising keeps distances along the ray equal in model and world space.
+		const auto inverse_model = glm::inverse(scene.get_component<Component::Transform>(p_entity).get_model());
+		const auto model_ray     = Geometry::Ray(glm::vec3(inverse_model * glm::vec4(p_ray.m_start, 1.f)), glm::vec3(inverse_model * glm::vec4(p_ray.m_direction, 0.f)));
+		if (auto hit = mesh.m_mesh->triangle_BVH->get_intersection(model_ray, p_max_distance))
+			return hit->distance_along_ray;
 
 		return std::nullopt;
 	}
 
 	bool CollisionSystem::castRay(const Geometry::Ray& p_ray, glm::vec3& out_first_intersection) const
 	{
-		std::optional<float> min_intersection_along_ray;
-
-		m_scene_system.get_current_scene_entities().foreach([&](Component::Collider& p_collider)
+		ensure_ray_BVH();
+		auto& scene = m_scene_system.get_current_scene_entities();
+		std::optional<size_t> first_target;
+		float min_length_along_ray = Geometry::BVH::Max_distance;
+		m_ray_BVH.traverse(p_ray, [&](size_t p_target, float p_length_along_ray)
 		{
-			float length_along_ray = 0.f;
-			if (auto intersection = Geometry::get_intersection(p_collider.m_world_AABB, p_ray, &length_along_ray))
+			if (!is_valid(m_ray_targets[p_target]))
+				return min_length_along_ray;
+
+			// The BVH visits nearest first, nodes entered beyond this hit are skipped.
+			if (auto length_along_ray = get_exact_distance(m_ray_targets[p_target].entity, p_ray, p_length_along_ray, min_length_along_ray))
 			{
-				p_collider.m_collided = true;
+				first_target         = p_target;
+				min_length_along_ray = *length_along_ray;
+			}
+			return min_length_along_ray;
+		});
+
+		if (!first_target)
+			return false;
+
+		if (!m_ray_targets[*first_target].is_terrain)
+			scene.get_component<Component::Collider>(m_ray_targets[*first_target].entity).m_collided = true;
+		out_first_intersection = p_ray.m_start + (p_ray.m_direction * min_length_along_ray);
+		return true;
+	}
 
-				if (!min_intersection_along_ray.has_value() || length_along_ray < min_intersection_along_ray)
+	void CollisionSystem::castRays(std::span<const Geometry::Ray> p_rays, std::span<std::optional<glm::vec3>> out_first_intersections) const
+	{
+		ASSERT_THROW(p_rays.size() == out_first_intersections.size(), "[COLLISION] castRays expects an output per ray.");
+		std::fill(out_first_intersections.begin(), out_first_intersections.end(), std::nullopt);
+
+		ensure_ray_BVH();
+		std::vector<float> min_lengths_along_ray(p_rays.size(), Geometry::BVH::Max_distance);
+		m_ray_BVH.traverse(p_rays, min_lengths_along_ray, [&](size_t p_ray_index, size_t p_target, float p_length_along_ray)
+		{
+			if (is_valid(m_ray_targets[p_target]))
+			{
+				const auto& ray = p_rays[p_ray_index];
+				if (auto length_along_ray = get_exact_distance(m_ray_targets[p_target].entity, ray, p_length_along_ray, min_lengths_along_ray[p_ray_index]))
 				{
-					min_intersection_along_ray = length_along_ray;
-					out_first_intersection     = *intersection;
+					out_first_intersections[p_ray_index] = ray.m_start + (ray.m_direction * *length_along_ray);
+					return *length_along_ray;
 				}
 			}
+			return min_lengths_along_ray[p_ray_index];
 		});
-
-		return min_intersection_along_ray.has_value();
 	}
 
 	std::vector<std::pair<ECS::Entity, float>> CollisionSystem::get_entities_along_ray(const Geometry::Ray& p_ray) const
 	{
+		ensure_ray_BVH();
 		std::vector<std::pair<ECS::Entity, float>> entities_and_distance;
-
-		m_scene_system.get_current_scene_entities().foreach([&](ECS::Entity& p_entity, Component::Collider& p_collider)
+		m_ray_BVH.traverse(p_ray, [&](size_t p_target, float p_length_along_ray)
 		{
-			float length_along_ray = 0.f;
-			if (auto intersection = Geometry::get_intersection(p_collider.m_world_AABB, p_ray, &length_along_ray))
-				entities_and_distance.push_back({p_entity, length_along_ray});
-		});
-		m_scene_system.get_current_scene_entities().foreach([&](ECS::Entity& p_entity, Component::Terrain& p_terrain)
-		{
-			auto terrain_mesh_AABB = p_terrain.m_mesh.AABB;
-			terrain_mesh_AABB      = Geometry::AABB::transform(terrain_mesh_AABB, p_terrain.m_position, glm::identity<glm::mat4>(), glm::vec3(1.f));
-			float length_along_ray = 0.f;
-			if (auto intersection = Geometry::get_intersection(terrain_mesh_AABB, p_ray, &length_along_ray))
-				entities_and_distance.push_back({p_entity, length_along_ray});
+			const auto& target = m_ray_targets[p_target];
+			if (!is_valid(target))
+				return Geometry::BVH::Max_distance;
+
+			if (auto length_along_ray = get_exact_distance(target.entity, p_ray, p_length_along_ray, Geometry::BVH::Max_distance))
+				entities_and_distance.push_back({target.entity, *length_along_ray});
+
+			return Geometry::BVH::Max_distance;
 		});
 
 		return entities_and_distance;
@@ -1,11 +1,18 @@
 #pragma once
 
 #include "ECS/Storage.hpp"
+#include "Geometry/BVH.hpp"
+#include "Geometry/GJK.hpp"
 #include "Geometry/Intersect.hpp"
 
 #include "glm/fwd.hpp"
+#include "glm/gtc/quaternion.hpp"
 
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <vector>
 #include <utility>
 
@@ -15,8 +22,13 @@ namespace Geometry
 }
 namespace Component
 {
+	class Collider;
 	struct Transform;
 }
+namespace Test
+{
+	class PhysicsTester;
+}
 namespace System
 {
 	class SceneSystem;
@@ -31,20 +43,97 @@ namespace System
 		float penetration_depth = 0.f;            // The depth of overlap. Unsigned displacement required to separate the two shapes along normal.
 	};
 
+	// The first point a Collider swept along a displacement touches another, see CollisionSystem::get_time_of_impact.
+	struct TimeOfImpact
+	{
+		float fraction   = 0.f;             // The fraction [0-1] of the displacement travelled before touching.
+		glm::vec3 normal = glm::vec3(0.f);  // The normal of the face of the other Collider's AABB touched, pointing towards the swept Collider.
+	};
+
 	// An optimisation layer and helper for quickly finding collision information for an Entity in a scene.
 	class CollisionSystem
 	{
+		friend class Test::PhysicsTester; // Checks m_pair_caches persist between queries.
+
 	private:
 		SceneSystem& m_scene_system;
 
+		// An entity in m_ray_BVH, the BVH item index is the index into m_ray_targets.
+		struct RayTarget
+		{
+			ECS::Entity entity;
+			bool is_terrain; // Terrain entities are hit via their Heightfield rather than a Collider.
+		};
+		// Tree of the world AABBs of every Collider and Terrain for ray queries. Kept up to date by update_ray_BVH.
+		// Mutable as ray queries build it themselves when the scene changed since the last update, see ensure_ray_BVH.
+		mutable Geometry::BVH m_ray_BVH;
+		mutable std::vector<RayTarget> m_ray_targets;
+		mutable std::vector<Geometry::AABB> m_ray_bounds;         // The world AABB of each of m_ray_targets gathered by update_ray_BVH, kept to reuse its allocation.
+		mutable float m_ray_BVH_built_cost;                        // The SAH_cost of m_ray_BVH when last rebuilt.
+		// Rebuild m_ray_BVH once refitting has made ray queries this many times costlier than they were after the last rebuild.
+		static constexpr float Max_refit_cost_growth = 1.5f;
+		mutable std::atomic<const ECS::Storage*> m_ray_BVH_scene; // The scene m_ray_BVH was built from, set once the tree is complete.
+		mutable std::mutex m_ray_BVH_mutex;                        // Serialises ray queries building m_ray_BVH for a new scene.
+
+		// The awake Colliders and their mesh AABB and Transform gathered by update to refresh their world AABB in one batched AABB::transform.
+		// Kept between updates to reuse their allocations.
+		std::vector<Component::Collider*> m_batch_colliders;
+		std::vector<Geometry::AABB> m_batch_local_AABBs;
+		std::vector<glm::vec3> m_batch_positions;
+		std::vector<glm::quat> m_batch_orientations;
+		std::vector<glm::vec3> m_batch_scales;
+		std::vector<Geometry::AABB> m_batch_world_AABBs;
+
+		// The GJK state of every pair of Colliders get_collision tested, keyed by their entity IDs lowest first.
+		// Carries the separating axis and support vertices over to the next query of the pair. Pairs are dropped by update once their AABBs stop overlapping.
+		using PairKey = std::pair<EntityID, EntityID>;
+		mutable std::map<PairKey, GJK::PairCache> m_pair_caches;
+		mutable std::mutex m_pair_caches_mutex;
+
+		// Does p_entity own a RigidBody that is asleep. Sleeping bodies are not moving and can skip AABB updates.
+		bool is_asleep(const ECS::Entity& p_entity) const;
+		// Bring m_ray_BVH up to date with the current world AABBs. Nothing is done if no AABB changed and the tree is refitted if only AABBs changed.
+		// It is only rebuilt when Colliders or Terrain are added or removed, or refitting has raised its SAH cost past Max_refit_cost_growth times its cost when built.
+		void update_ray_BVH() const;
+		// Build m_ray_BVH for the current scene if it was built for another, e.g. a query after a scene load or switch before the next update.
+		// Queries from several threads are safe, one builds the tree while the others wait for it.
+		void ensure_ray_BVH() const;
+		// Is p_target still in the current scene with the components it was added to m_ray_BVH for.
+		bool is_valid(const RayTarget& p_target) const;
+		// Refine a hit of p_ray against the world AABB of p_entity to its Terrain heightfield or its mesh triangles if the mesh retains a triangle_BVH.
+		//@param p_AABB_distance The distance along p_ray of the hit against the world AABB, returned as is if there is nothing to refine against.
+		//@param p_max_distance Triangles hit beyond this distance along p_ray are ignored.
+		//@returns The distance along p_ray of the hit, nullopt if p_ray misses the triangles.
+		std::optional<float> get_exact_distance(const ECS::Entity& p_entity, const Geometry::Ray& p_ray, float p_AABB_distance, float p_max_distance) const;
+
 	public:
 		CollisionSystem(SceneSystem& p_scene_system) noexcept;
 		void update();
 
-		std::optional<ContactPoint> get_collision(const ECS::Entity& p_entity, const ECS::Entity* p_collided_entity = nullptr) const;
+		// Find the deepest contact between p_entity and any other Collider. World AABBs are expected to be current, see update and PhysicsSystem::integrate.
+		// The Colliders whose AABB overlaps are tested together by the batched GJK::intersecting and GJK::EPA over their mesh convex hulls.
+		// Only the m_collided flag of p_entity's Collider and, under a lock, the pair caches are written, allowing queries for different entities to run concurrently.
+		//@param p_collided_entity Optional out param set to the entity contacted.
+		std::optional<ContactPoint> get_collision(const ECS::Entity& p_entity, ECS::Entity* p_collided_entity = nullptr) const;
+
+		// Sweep the Collider AABB of p_entity along p_displacement against every other Collider.
+		// Returns where along p_displacement it first touches another Collider and the face touched, nullopt if the path is clear.
+		// Colliders already touching or overlapping at the start of the sweep are hit at fraction 0, the normal is that of the face
+		// of their AABB nearest the start, so bodies resting on a Collider have only their motion into it clipped. Writes nothing.
+		std::optional<TimeOfImpact> get_time_of_impact(const ECS::Entity& p_entity, const glm::vec3& p_displacement) const;
+		// Find the deepest contact between the Collider AABB of p_entity and the heightfield of any Terrain. The normal points out of the terrain.
+		//@param p_terrain_entity Optional out param set to the Terrain entity contacted.
+		std::optional<ContactPoint> get_terrain_collision(const ECS::Entity& p_entity, ECS::Entity* p_terrain_entity = nullptr) const;
+
+		// Ray queries are served by a BVH of the world AABBs as of the last update, costing O(log n) in the number of Colliders.
+		// After a scene load or switch the first query builds the BVH from the scene's current world AABBs rather than waiting for update.
+		// Terrain is hit exactly via its Heightfield and Colliders with a mesh retaining its triangles via Data::Mesh::triangle_BVH, others are hit at their AABB.
 
-		// Does this ray collide with any entities.
+		// Does this ray collide with any entities. Marks the Collider hit first as collided.
 		bool castRay(const Geometry::Ray& p_ray, glm::vec3& out_first_intersection) const;
+		// Closest hit of each ray in p_rays sharing the BVH traversal between them. Faster than castRay per ray for rays travelling close together.
+		//@param out_first_intersections Out: per ray of p_rays, the first intersection point or nullopt if the ray hits nothing.
+		void castRays(std::span<const Geometry::Ray> p_rays, std::span<std::optional<glm::vec3>> out_first_intersections) const;
 		// Returns all the entities colliding with p_ray. These are returned as pairs of Entity and the length along the ray from the Ray origin.
 		std::vector<std::pair<ECS::Entity, float>> get_entities_along_ray(const Geometry::Ray& p_ray) const;
 	};
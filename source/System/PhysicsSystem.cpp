@@ -2,25 +2,45 @@
 #include "CollisionSystem.hpp"
 #include "SceneSystem.hpp"
 
+#include "Component/Collider.hpp"
 #include "Component/FirstPersonCamera.hpp"
+#include "Component/Mesh.hpp"
 #include "Component/RigidBody.hpp"
+#include "Component/Terrain.hpp"
 #include "Component/Transform.hpp"
 #include "ECS/Storage.hpp"
 
 #include "Geometry/Geometry.hpp"
 #include "Utility/Utility.hpp"
 
+#include <algorithm>
+#include <utility>
+
 namespace System
 {
-	PhysicsSystem::PhysicsSystem(SceneSystem& scene_system, CollisionSystem& collision_system)
+	PhysicsSystem::PhysicsSystem(SceneSystem& scene_system, CollisionSystem& collision_system, size_t p_thread_count)
 		: m_update_count{0}
 		, m_restitution{0.8f}
 		, m_apply_collision_response{true}
 		, m_bool_apply_kinematic{true}
+		, m_allow_sleeping{true}
+		, m_sleep_linear_velocity{0.05f}
+		, m_sleep_angular_velocity{0.05f}
+		, m_time_to_sleep{DeltaTime(0.5f)}
+		, m_island_count{0}
+		, m_sleeping_body_count{0}
 		, m_scene_system{scene_system}
 		, m_collision_system{collision_system}
+		, m_thread_pool{p_thread_count}
 		, m_total_simulation_time{DeltaTime::zero()}
 		, m_gravity{glm::vec3(0.f, -9.81f, 0.f)}
+		, m_bodies{}
+		, m_island_parent{}
+		, m_sweep_order{}
+		, m_island_bodies{}
+		, m_island_starts{}
+		, m_island_of_root{}
+		, m_island_fill{}
 	{}
 
 	void PhysicsSystem::integrate(const DeltaTime& p_delta_time)
@@ -32,70 +52,329 @@ namespace System
 			return;
 
 		auto& scene = m_scene_system.get_current_scene_entities();
-		scene.foreach([this, &p_delta_time, &scene](ECS::Entity& entity, Component::RigidBody& rigid_body, Component::Transform& transform)
+		m_bodies.clear();
+		scene.foreach([this, &scene](ECS::Entity& entity, Component::RigidBody& rigid_body, Component::Transform& transform)
+		{
+			auto* collider = scene.has_components<Component::Collider>(entity) ? &scene.get_component<Component::Collider>(entity) : nullptr;
+			auto* mesh     = scene.has_components<Component::Mesh>(entity)     ? &scene.get_component<Component::Mesh>(entity)     : nullptr;
+			m_bodies.push_back({entity, &rigid_body, &transform, collider, mesh, glm::vec3(0.f), std::nullopt, ECS::Entity(0)});
+		});
+
+		wake_moved_bodies();
+		build_islands();
+
+		// Bodies only touch the bodies in their own island so each island can be solved on any thread.
+		// Passes that read other Colliders (sweeps and contacts) never run alongside the pass that moves them, keeping the AABBs read stable.
+		const auto solve_islands = [this](const auto& p_solve_body)
+		{
+			m_thread_pool.parallel_for(m_island_count, [this, &p_solve_body](size_t p_island)
+			{
+				for (size_t i = m_island_starts[p_island]; i < m_island_starts[p_island + 1]; i++)
+				{
+					auto& body = m_bodies[m_island_bodies[i]];
+					if (!body.rigid_body->m_asleep)
+						p_solve_body(body);
+				}
+			});
+		};
+		solve_islands([this, &p_delta_time](Body& p_body) { integrate_velocity(p_body, p_delta_time); });
+		solve_islands([this, &p_delta_time](Body& p_body) { integrate_position(p_body, p_delta_time); });
+		solve_islands([this](Body& p_body) { find_contact(p_body); });
+
+		// Responses read the body collided with which may belong to another island, resolve them in a fixed order on this thread.
+		for (auto& body : m_bodies)
+		{
+			if (body.contact)
+				resolve_contact(body, p_delta_time);
+		}
+
+		update_sleeping(p_delta_time);
+	}
+
+	void PhysicsSystem::integrate_velocity(Body& p_body, const DeltaTime& p_delta_time)
+	{
+		auto& rigid_body = *p_body.rigid_body;
+
+		if (rigid_body.m_apply_gravity)
+			rigid_body.m_force += rigid_body.m_mass * m_gravity; // F = ma
+
+		{ // Linear motion
+			// Change in momentum is equal to the force = dp/dt = F
+			const auto change_in_momentum = rigid_body.m_force * p_delta_time.count(); // dp = F dt
+			rigid_body.m_momentum += change_in_momentum;
+
+			// Convert momentum to velocity by dividing by mass: p = mv
+			rigid_body.m_velocity = rigid_body.m_momentum / rigid_body.m_mass; // v = p/v
+
+			// Integrate velocity to find the change in position: dx/dt = v
+			p_body.displacement = rigid_body.m_velocity * p_delta_time.count(); // dx = v dt
+
+			rigid_body.m_force = glm::vec3(0.f); // Reset back to 0 after applying the force on the body.
+		}
+
+		{ // Angular motion
+			// http://physics.bu.edu/~redner/211-sp06/class-rigid-body/angularmo.html
+			const auto change_in_angular_momentum = rigid_body.m_torque * p_delta_time.count(); // dL = T dt
+			rigid_body.m_angular_momentum += change_in_angular_momentum;
+
+			// Convert angular momentum to angular velocity by dividing by inertia tensor: L = Iω
+			rigid_body.m_angular_velocity = rigid_body.m_angular_momentum / rigid_body.m_inertia_tensor; // ω = L / I
+		}
+
+		// Continuous collision: stop the motion into the Collider the body first touches along the displacement instead of tunneling through it.
+		// Only the motion along the face normal is cut at the time of impact, the rest of the tick continues along the surface so bodies
+		// resting or sliding on a Collider, which touch it at the start of every sweep, keep moving over it rather than freezing in place.
+		if (rigid_body.m_continuous_collision && p_body.collider)
+		{
+			if (auto impact = m_collision_system.get_time_of_impact(p_body.entity, p_body.displacement))
+			{
+				const float normal_displacement = glm::dot(p_body.displacement, impact->normal);
+				if (normal_displacement < 0.f)
+				{
+					p_body.displacement -= impact->normal * (normal_displacement * (1.f - impact->fraction));
+
+					// Bounce off the face, bounces slower than the rest speed are dropped so a body resting on the Collider stays at rest.
+					const float normal_speed = glm::dot(rigid_body.m_velocity, impact->normal);
+					if (normal_speed < 0.f)
+					{
+						const float bounce_speed = -normal_speed * m_restitution < get_rest_speed(p_delta_time) ? 0.f : -normal_speed * m_restitution;
+						rigid_body.m_velocity += impact->normal * (bounce_speed - normal_speed);
+						rigid_body.m_momentum  = rigid_body.m_velocity * rigid_body.m_mass;
+					}
+				}
+			}
+		}
+	}
+
+	void PhysicsSystem::integrate_position(Body& p_body, const DeltaTime& p_delta_time)
+	{
+		auto& rigid_body = *p_body.rigid_body;
+		auto& transform  = *p_body.transform;
+
+		transform.m_position += p_body.displacement;
+
+		{ // Angular motion
+			// To integrate the new quat orientation we convert the angular velocity into quaternion form - spin.
+			// Spin represents a time derivative of orientation. https://www.cs.cmu.edu/~baraff/sigcourse/notesd1.pdf
+			const glm::quat spin = 0.5f * glm::quat(0.f, (rigid_body.m_angular_velocity * p_delta_time.count())) * transform.m_orientation;
+
+			// Integrate spin to find the new orientation
+			transform.m_orientation += spin;
+			transform.m_orientation = glm::normalize(transform.m_orientation);
+		}
+
+		if (p_body.collider && p_body.mesh)
+			p_body.collider->m_world_AABB = Geometry::AABB::transform(p_body.mesh->m_mesh->AABB, transform.m_position, glm::mat4_cast(transform.m_orientation), transform.m_scale);
+	}
+
+	void PhysicsSystem::find_contact(Body& p_body)
+	{
+		// Terrain is checked first, a body resting on it stays pushed out while it also touches a Collider.
+		p_body.collided_entity = ECS::Entity(0);
+		p_body.contact         = p_body.collider ? m_collision_system.get_terrain_collision(p_body.entity, &p_body.collided_entity) : std::nullopt;
+		if (!p_body.contact)
+			p_body.contact = m_collision_system.get_collision(p_body.entity, &p_body.collided_entity);
+	}
+
+	void PhysicsSystem::resolve_contact(Body& p_body, const DeltaTime& p_delta_time)
+	{
+		if (!m_apply_collision_response)
+			return;
+
+		auto& scene      = m_scene_system.get_current_scene_entities();
+		auto& rigid_body = *p_body.rigid_body;
+		auto& transform  = *p_body.transform;
+		auto& collision  = p_body.contact;
+
+		// A collision has occurred at the new position, the response depends on the collided entity having a rigibBody to apply a response to.
+		// We already know the collided Entity has a Transform component from CollisionSystem::getCollision so we dont have to check it here.
+		// The collision data returned is original-Entity-centric, its normal points out of the collided entity into p_body.
+		if (scene.has_components<Component::RigidBody>(p_body.collided_entity))
 		{
-			if (rigid_body.m_apply_gravity)
-				rigid_body.m_force += rigid_body.m_mass * m_gravity; // F = ma
+			auto& rigid_body_2 = scene.get_component<Component::RigidBody>(p_body.collided_entity);
+			auto& transform_2  = scene.get_component<Component::Transform>(p_body.collided_entity);
 
-			{ // Linear motion
-				// Change in momentum is equal to the force = dp/dt = F
-				const auto change_in_momentum = rigid_body.m_force * p_delta_time.count(); // dp = F dt
-				rigid_body.m_momentum += change_in_momentum;
+			// angular_impulse expects the normal from body 1 into body 2, the reverse of the contact normal.
+			const auto impulse = Geometry::angular_impulse(collision->position, -collision->normal, m_restitution,
+			                                               transform.m_position, rigid_body.m_velocity, rigid_body.m_angular_velocity, rigid_body.m_mass, rigid_body.m_inertia_tensor,
+			                                               transform_2.m_position, rigid_body_2.m_velocity, rigid_body_2.m_angular_velocity, rigid_body_2.m_mass, rigid_body_2.m_inertia_tensor);
 
-				// Convert momentum to velocity by dividing by mass: p = mv
-				rigid_body.m_velocity = rigid_body.m_momentum / rigid_body.m_mass; // v = p/v
+			// Both bodies find the contact, whichever resolves it first leaves them separating so the other finds no impulse to apply.
+			if (glm::dot(impulse, collision->normal) >= 0.f)
+				return;
 
-				// Integrate velocity to find new position: dx/dt = v
-				const auto change_in_position = rigid_body.m_velocity * p_delta_time.count(); // dx = v dt
-				transform.m_position += change_in_position;
+			// The impulse changes the momenta, integrate_velocity derives the velocities from them every tick.
+			auto apply_impulse = [&collision](Component::RigidBody& p_rigid_body, const Component::Transform& p_transform, const glm::vec3& p_impulse)
+			{
+				p_rigid_body.m_momentum         += p_impulse;
+				p_rigid_body.m_angular_momentum += glm::cross(collision->position - p_transform.m_position, p_impulse);
+				p_rigid_body.m_velocity          = p_rigid_body.m_momentum / p_rigid_body.m_mass;
+				p_rigid_body.m_angular_velocity  = p_rigid_body.m_angular_momentum / p_rigid_body.m_inertia_tensor;
+			};
+			apply_impulse(rigid_body, transform, -impulse);
+			apply_impulse(rigid_body_2, transform_2, impulse);
+			if (rigid_body_2.m_asleep)
+				rigid_body_2.wake();
+		}
+		else if (scene.has_components<Component::Terrain>(p_body.collided_entity))
+		{// Terrain is static, push the body out along the surface normal and remove the velocity into the surface.
+			transform.m_position += collision->normal * collision->penetration_depth;
+			if (p_body.collider && p_body.mesh)
+				p_body.collider->m_world_AABB = Geometry::AABB::transform(p_body.mesh->m_mesh->AABB, transform.m_position, glm::mat4_cast(transform.m_orientation), transform.m_scale);
 
-				rigid_body.m_force = glm::vec3(0.f); // Reset back to 0 after applying the force on the body.
+			const float normal_speed = glm::dot(rigid_body.m_velocity, collision->normal);
+			if (normal_speed < 0.f)
+			{
+				// Bounces slower than the rest speed are dropped. A body resting on the terrain hits it every tick at the speed gravity added,
+				// dropping the bounce leaves it still so it falls asleep rather than hopping in place.
+				const float bounce_speed = -normal_speed * m_restitution < get_rest_speed(p_delta_time) ? 0.f : -normal_speed * m_restitution;
+				rigid_body.m_velocity += collision->normal * (bounce_speed - normal_speed);
+				rigid_body.m_momentum  = rigid_body.m_velocity * rigid_body.m_mass;
 			}
+		}
+	}
 
-			{ // Angular motion
-				// http://physics.bu.edu/~redner/211-sp06/class-rigid-body/angularmo.html
-				const auto change_in_angular_momentum = rigid_body.m_torque * p_delta_time.count(); // dL = T dt
-				rigid_body.m_angular_momentum += change_in_angular_momentum;
+	void PhysicsSystem::wake_moved_bodies()
+	{
+		for (auto& body : m_bodies)
+		{
+			if (!body.rigid_body->m_asleep || !body.collider || !body.mesh)
+				continue;
 
-				// Convert angular momentum to angular velocity by dividing by inertia tensor: L = Iω
-				rigid_body.m_angular_velocity = rigid_body.m_angular_momentum / rigid_body.m_inertia_tensor; // ω = L / I
+			// The AABB was last set from the transform the body fell asleep at, recomputing it from the same transform gives an identical result.
+			const auto& transform = *body.transform;
+			const auto world_AABB = Geometry::AABB::transform(body.mesh->m_mesh->AABB, transform.m_position, glm::mat4_cast(transform.m_orientation), transform.m_scale);
+			if (world_AABB.m_min != body.collider->m_world_AABB.m_min || world_AABB.m_max != body.collider->m_world_AABB.m_max)
+			{
+				body.collider->m_world_AABB = world_AABB;
+				body.rigid_body->wake();
+			}
+		}
+	}
 
-				// To integrate the new quat orientation we convert the angular velocity into quaternion form - spin.
-				// Spin represents a time derivative of orientation. https://www.cs.cmu.edu/~baraff/sigcourse/notesd1.pdf
-				const glm::quat spin = 0.5f * glm::quat(0.f, (rigid_body.m_angular_velocity * p_delta_time.count())) * transform.m_orientation;
+	void PhysicsSystem::build_islands()
+	{
+		m_island_parent.resize(m_bodies.size());
+		for (size_t i = 0; i < m_bodies.size(); i++)
+			m_island_parent[i] = i;
 
-				// Integrate spin to find the new orientation
-				transform.m_orientation += spin;
-				transform.m_orientation = glm::normalize(transform.m_orientation);
+		{// Broad phase sweep along x merging the islands of every pair of bodies whose AABBs overlap.
+			m_sweep_order.clear();
+			for (size_t i = 0; i < m_bodies.size(); i++)
+			{
+				if (m_bodies[i].collider)
+					m_sweep_order.push_back(i);
 			}
+			std::sort(m_sweep_order.begin(), m_sweep_order.end(), [this](const size_t& p_a, const size_t& p_b)
+				{ return m_bodies[p_a].collider->m_world_AABB.m_min.x < m_bodies[p_b].collider->m_world_AABB.m_min.x; });
 
-			ECS::Entity collided_entity = ECS::Entity(0);
-			if (auto collision = m_collision_system.get_collision(entity, &collided_entity))
+			for (size_t i = 0; i < m_sweep_order.size(); i++)
 			{
-				if (m_apply_collision_response)
+				const auto& AABB = m_bodies[m_sweep_order[i]].collider->m_world_AABB;
+				for (size_t j = i + 1; j < m_sweep_order.size(); j++)
 				{
-					// A collision has occurred at the new position, the response depends on the collided entity having a rigibBody to apply a response to.
-					// We already know the collided Entity has a Transform component from CollisionSystem::getCollision so we dont have to check it here.
-					// The collision data returned is original-Entity-centric this convention is carried over in the response here when calling angular_impulse.
-					if (scene.has_components<Component::RigidBody>(collided_entity))
-					{
-						auto& rigid_body_2 = m_scene_system.get_current_scene_entities().get_component<Component::RigidBody>(collided_entity);
-						auto& transform_2  = m_scene_system.get_current_scene_entities().get_component<Component::Transform>(collided_entity);
+					const auto& AABB_other = m_bodies[m_sweep_order[j]].collider->m_world_AABB;
+					if (AABB_other.m_min.x > AABB.m_max.x)
+						break; // Every remaining AABB starts further along x than this one ends.
 
-						auto impulse = Geometry::angular_impulse(collision->position, collision->normal, m_restitution,
-																transform.m_position, rigid_body.m_velocity, rigid_body.m_angular_velocity, rigid_body.m_mass, rigid_body.m_inertia_tensor,
-																transform_2.m_position, rigid_body_2.m_velocity, rigid_body_2.m_angular_velocity, rigid_body_2.m_mass, rigid_body_2.m_inertia_tensor);
+					if (Geometry::intersecting(AABB, AABB_other))
+						merge_islands(m_sweep_order[i], m_sweep_order[j]);
+				}
+			}
+		}
 
-						const auto r             = collision->position - transform.m_position;
-						const auto inverseTensor = glm::inverse(rigid_body.m_inertia_tensor);
+		{// Counting sort the bodies by island. Islands are ordered by their root index and bodies ascending within them.
+			// Roots are always the lowest body index in an island so the grouping only depends on the scene, never on the sweep.
+			m_island_of_root.assign(m_bodies.size(), 0);
+			m_island_starts.clear();
+			for (size_t i = 0; i < m_bodies.size(); i++)
+			{
+				if (find_island(i) == i)
+				{
+					m_island_of_root[i] = m_island_starts.size();
+					m_island_starts.push_back(0);
+				}
+				m_island_starts[m_island_of_root[find_island(i)]]++;
+			}
+			m_island_count = m_island_starts.size();
 
-						rigid_body.m_velocity        = rigid_body.m_velocity + (impulse / rigid_body.m_mass);
-						rigid_body.m_angular_velocity = rigid_body.m_angular_velocity + (glm::cross(r, impulse) * inverseTensor);
+			size_t offset = 0;
+			for (auto& start : m_island_starts)
+				offset += std::exchange(start, offset);
+			m_island_starts.push_back(offset);
 
-						// #TODO: Apply a response to collision.mEntity
-					}
+			m_island_fill.assign(m_island_starts.begin(), m_island_starts.end() - 1);
+			m_island_bodies.resize(m_bodies.size());
+			for (size_t i = 0; i < m_bodies.size(); i++)
+				m_island_bodies[m_island_fill[m_island_of_root[find_island(i)]]++] = i;
+		}
+	}
+
+	float PhysicsSystem::get_rest_speed(const DeltaTime& p_delta_time) const
+	{
+		return std::max(m_sleep_linear_velocity, glm::length(m_gravity) * p_delta_time.count());
+	}
+
+	void PhysicsSystem::update_sleeping(const DeltaTime& p_delta_time)
+	{
+		// Update the time at rest of the awake bodies, sleeping bodies keep theirs until they are woken.
+		// Sampled after contacts are resolved so bodies resting on a surface have had the speed gravity added this tick removed.
+		const float rest_speed = get_rest_speed(p_delta_time);
+		for (auto& body : m_bodies)
+		{
+			auto& rigid_body = *body.rigid_body;
+			if (rigid_body.m_asleep)
+				continue;
+
+			const bool at_rest = glm::length(rigid_body.m_velocity) < rest_speed
+			                  && glm::length(rigid_body.m_angular_velocity) < m_sleep_angular_velocity;
+			rigid_body.m_time_at_rest = at_rest ? rigid_body.m_time_at_rest + p_delta_time.count() : 0.f;
+		}
+
+		// An island can only sleep if every body in it is ready to sleep.
+		// Any body that is not, because it's moving or recently disturbed, keeps the whole island awake.
+		m_sleeping_body_count = 0;
+		for (size_t island = 0; island < m_island_count; island++)
+		{
+			const auto begin = m_island_bodies.begin() + m_island_starts[island];
+			const auto end   = m_island_bodies.begin() + m_island_starts[island + 1];
+
+			const bool can_sleep = m_allow_sleeping && std::all_of(begin, end, [this](const size_t& p_body_index)
+				{ return m_bodies[p_body_index].rigid_body->m_time_at_rest >= m_time_to_sleep.count(); });
+
+			for (auto it = begin; it != end; it++)
+			{
+				auto& rigid_body = *m_bodies[*it].rigid_body;
+				if (can_sleep)
+				{
+					if (!rigid_body.m_asleep)
+						rigid_body.sleep();
+					m_sleeping_body_count++;
 				}
+				else if (rigid_body.m_asleep)
+					rigid_body.wake();
 			}
-		});
+		}
+	}
+
+	size_t PhysicsSystem::find_island(size_t p_body_index)
+	{
+		// Path halving, every visited node is pointed at its grandparent.
+		while (m_island_parent[p_body_index] != p_body_index)
+		{
+			m_island_parent[p_body_index] = m_island_parent[m_island_parent[p_body_index]];
+			p_body_index                  = m_island_parent[p_body_index];
+		}
+		return p_body_index;
+	}
+	void PhysicsSystem::merge_islands(size_t p_body_index_1, size_t p_body_index_2)
+	{
+		const auto island_1 = find_island(p_body_index_1);
+		const auto island_2 = find_island(p_body_index_2);
+		// Always keep the lower index as the root so islands are identified independent of merge order.
+		if (island_1 < island_2)
+			m_island_parent[island_2] = island_1;
+		else if (island_2 < island_1)
+			m_island_parent[island_1] = island_2;
 	}
 } // namespace System
\ No newline at end of file
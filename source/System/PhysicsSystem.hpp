@@ -1,20 +1,39 @@
 #pragma once
 
+#include "CollisionSystem.hpp"
+
+#include "ECS/Entity.hpp"
+
 #include "glm/vec3.hpp"
 
 #include "Utility/Config.hpp"
+#include "Utility/ThreadPool.hpp"
+
+#include <optional>
+#include <vector>
 
+namespace Component
+{
+	class Collider;
+	class RigidBody;
+	class Mesh;
+	struct Transform;
+}
 namespace System
 {
 	class SceneSystem;
-	class CollisionSystem;
 
 	// A numerical integrator, PhysicsSystem take Transform and RigidBody components and applies kinematic equations.
 	// The system is force based and numerically integrates
+	// Bodies whose Collider AABBs overlap are grouped into islands. An island at rest for m_time_to_sleep is put to sleep and skipped
+	// until any body in it is disturbed, at which point the whole island wakes together.
+	// Islands are independent so they are integrated and collision tested in parallel. Every island only writes to its own bodies and
+	// collision responses are applied afterwards in body order, so results are identical regardless of the number of threads used.
 	class PhysicsSystem
 	{
 	public:
-		PhysicsSystem(SceneSystem& scene_system, CollisionSystem& collision_system);
+		// p_thread_count is the number of threads used to solve islands including the calling thread, 0 uses the hardware concurrency.
+		PhysicsSystem(SceneSystem& scene_system, CollisionSystem& collision_system, size_t p_thread_count = 0);
 		void integrate(const DeltaTime& delta_time);
 
 		size_t m_update_count;
@@ -22,11 +41,65 @@ namespace System
 		bool m_apply_collision_response; // Whether to apply collision response or not.
 		bool m_bool_apply_kinematic;     // Whether to apply kinematic equations or not.
 
+		bool m_allow_sleeping;          // Whether islands at rest are put to sleep.
+		float m_sleep_linear_velocity;  // Linear speed (m/s) below which a body is considered at rest. Raised to the speed gravity adds in a tick, see get_rest_speed.
+		float m_sleep_angular_velocity; // Angular speed (rad/s) below which a body is considered at rest.
+		DeltaTime m_time_to_sleep;      // Time every body in an island must remain at rest before the island is put to sleep.
+		size_t m_island_count;          // Number of islands found by the last integrate.
+		size_t m_sleeping_body_count;   // Number of sleeping RigidBody components after the last integrate.
+
+		size_t thread_count() const { return m_thread_pool.thread_count(); }
+
 	private:
+		// A RigidBody and the components it is simulated with. Pointers are valid for the duration of an integrate call.
+		struct Body
+		{
+			ECS::Entity entity;
+			Component::RigidBody* rigid_body;
+			Component::Transform* transform;
+			Component::Collider* collider;          // nullptr if the entity has no Collider, the body then forms its own island.
+			Component::Mesh* mesh;                  // nullptr if the entity has no Mesh, the Collider AABB is then not updated.
+			glm::vec3 displacement;                 // Change in position this tick, shortened to the time of impact for continuous collision.
+			std::optional<ContactPoint> contact;    // Contact found after integrating this tick, resolved once every island is solved.
+			ECS::Entity collided_entity;
+		};
+
 		SceneSystem& m_scene_system;
 		CollisionSystem& m_collision_system;
+		Utility::ThreadPool m_thread_pool;
 
 		DeltaTime m_total_simulation_time; // Total time simulated using the integrate function.
 		glm::vec3 m_gravity;               // The acceleration due to gravity.
+
+		std::vector<Body> m_bodies;          // Every RigidBody in the current scene, gathered at the start of integrate.
+		std::vector<size_t> m_island_parent; // Union-find parent index per m_bodies element. Roots identify an island.
+		std::vector<size_t> m_sweep_order;   // m_bodies indices with a Collider ordered by AABB min x for the island sweep.
+		std::vector<size_t> m_island_bodies; // m_bodies indices grouped by island, in ascending order within each island.
+		std::vector<size_t> m_island_starts; // Offset into m_island_bodies of each island, with a final end offset.
+		std::vector<size_t> m_island_of_root; // Island index per root m_bodies index, used to counting sort m_island_bodies.
+		std::vector<size_t> m_island_fill;    // Next free offset into m_island_bodies per island while counting sorting.
+
+		// Apply forces to the body's velocities and find its displacement, sweeping it if continuous collision is on. Only writes to p_body.
+		void integrate_velocity(Body& p_body, const DeltaTime& p_delta_time);
+		// Move the body by its displacement and angular velocity and refresh its Collider AABB. Only writes to p_body.
+		void integrate_position(Body& p_body, const DeltaTime& p_delta_time);
+		// Query the CollisionSystem for a contact against p_body at its new position with Terrain, falling back to other Colliders. Only writes to p_body.
+		void find_contact(Body& p_body);
+		// Apply the impulse of a contact found by find_contact to both bodies, or push the body out of Terrain.
+		// Writes the collided body so must run after all islands are solved.
+		void resolve_contact(Body& p_body, const DeltaTime& p_delta_time);
+
+		// Wake the sleeping bodies moved since they were put to sleep, e.g. by the editor, and refresh their Collider AABB.
+		// Sleeping bodies are skipped by CollisionSystem::update so their AABB would otherwise stay where they fell asleep.
+		void wake_moved_bodies();
+		// Group m_bodies into islands of overlapping Colliders, filling m_island_bodies and m_island_starts.
+		void build_islands();
+		// Linear speed below which a body is at rest after a tick of p_delta_time.
+		// A body resting on a surface gains the speed gravity adds every tick before its contact is resolved, so the threshold is never below it.
+		float get_rest_speed(const DeltaTime& p_delta_time) const;
+		// Update the time at rest of each body and sleep or wake each island as a whole.
+		void update_sleeping(const DeltaTime& p_delta_time);
+		size_t find_island(size_t p_body_index);
+		void merge_islands(size_t p_body_index_1, size_t p_body_index_2);
 	};
 } // namespace System
\ No newline at end of file
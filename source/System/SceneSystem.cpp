@@ -274,10 +274,12 @@ namespace System
 	}
 	void SceneSystem::construct_2_sphere_scene(Scene& p_scene)
 	{
-		auto mb = Utility::MeshBuilder<Data::Vertex, OpenGL::PrimitiveMode::Triangles, true>{};
-		mb.add_icosphere(glm::vec3(0.f), 1.f, 1);
-		auto icosphere_mesh = mb.get_mesh();
-		auto icosphere_meshref = m_asset_manager.insert(std::move(icosphere_mesh));
+		auto icosphere_meshref = m_asset_manager.get_mesh("Icosphere 1", []()
+		{
+			auto mb = Utility::MeshBuilder<Data::Vertex, OpenGL::PrimitiveMode::Triangles, true>{};
+			mb.add_icosphere(glm::vec3(0.f), 1.f, 1);
+			return mb.get_mesh();
+		});
 
 		p_scene.m_entities.add_entity(
 			Component::Label{"Directional light 1"},
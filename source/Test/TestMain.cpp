@@ -3,9 +3,12 @@
 #include "Test/Tests/ComponentSerialiseTester.hpp"
 #include "Test/Tests/ECSTester.hpp"
 #include "Test/Tests/GeometryTester.hpp"
+#include "Test/Tests/PerlinNoiseTester.hpp"
+#include "Test/Tests/PhysicsTester.hpp"
 #include "Test/Tests/ResourceManagerTester.hpp"
 #include "Test/Tests/GraphicsTester.hpp"
 #include "Test/Tests/QuadTreeTester.hpp"
+#include "Test/Tests/TerrainTester.hpp"
 
 #include <cstring>
 #include "Utility/Stopwatch.hpp"
@@ -42,8 +45,13 @@ int main(int argc, char* argv[])
 	test_managers.emplace_back(std::make_unique<Test::GeometryTester>());
 	test_managers.emplace_back(std::make_unique<Test::ResourceManagerTester>());
 	test_managers.emplace_back(std::make_unique<Test::QuadTreeTester>());
+	test_managers.emplace_back(std::make_unique<Test::PerlinNoiseTester>());
+	test_managers.emplace_back(std::make_unique<Test::TerrainTester>());
 	if (!skip_graphics_test)
+	{// Both need an OpenGL context.
 		test_managers.emplace_back(std::make_unique<Test::GraphicsTester>());
+		test_managers.emplace_back(std::make_unique<Test::PhysicsTester>());
+	}
 
 	size_t unit_test_overall_pass_count    = 0;
 	size_t unit_test_overall_fail_count    = 0;
@@ -77,5 +85,14 @@ int main(int argc, char* argv[])
 	if (unit_test_overall_fail_count > 0)
 		printf("***************** FAILED TESTS *****************\n%s", unit_tests_failed_messages.c_str());
 
+	if (should_run_perf_tests)
+	{
+		for (auto& tester : test_managers)
+		{
+			printf("\n***************** STARTING %s PERFORMANCE TESTS *****************\n", tester->m_name.c_str());
+			tester->run_performance_tests();
+		}
+	}
+
 	return unit_test_overall_fail_count;
 }
\ No newline at end of file
@@ -1,16 +1,24 @@
 #include "GeometryTester.hpp"
 
 #include "Geometry/AABB.hpp"
+#include "Geometry/BVH.hpp"
 #include "Geometry/Cone.hpp"
+#include "Geometry/ConvexHull.hpp"
 #include "Geometry/Cylinder.hpp"
 #include "Geometry/Sphere.hpp"
 #include "Geometry/Frustrum.hpp"
+#include "Geometry/GJK.hpp"
+#include "Geometry/Heightfield.hpp"
+#include "Geometry/HeightfieldChunks.hpp"
 #include "Geometry/Intersect.hpp"
 #include "Geometry/Line.hpp"
+#include "Geometry/LooseOctree.hpp"
 #include "Geometry/LineSegment.hpp"
 #include "Geometry/Ray.hpp"
 #include "Geometry/Triangle.hpp"
+#include "Geometry/TriangleBVH.hpp"
 
+#include "Utility/Stopwatch.hpp"
 #include "Utility/Utility.hpp"
 
 #include "glm/glm.hpp"
@@ -18,6 +26,8 @@
 #include "glm/gtc/matrix_transform.hpp"
 
 #include <array>
+#include <map>
+#include <random>
 
 DISABLE_WARNING_PUSH
 DISABLE_WARNING_HIDES_PREVIOUS_DECLERATION // Required to allow shadowing for the SCOPE_SECTION macro
@@ -31,9 +41,313 @@ namespace Test
 		run_frustrum_tests();
 		run_sphere_tests();
 		run_point_tests();
+		run_distance_tests();
+		run_convex_hull_tests();
+		run_GJK_batch_tests();
+		run_BVH_tests();
+		run_heightfield_tests();
+		run_octree_tests();
 	}
+
+	// Make p_count AABBs of size [0.1-2] scattered within p_spread of the origin and p_count rays starting within p_spread in random directions.
+	// Uses a fixed seed so runs are repeatable.
+	static std::pair<std::vector<Geometry::AABB>, std::vector<Geometry::Ray>> make_boxes_and_rays(size_t p_count, float p_spread)
+	{
+		std::mt19937 gen(7);
+		std::uniform_real_distribution<float> position_dis(-p_spread, p_spread);
+		std::uniform_real_distribution<float> size_dis(0.1f, 2.f);
+		std::uniform_real_distribution<float> direction_dis(-1.f, 1.f);
+
+		std::vector<Geometry::AABB> boxes;
+		std::vector<Geometry::Ray> rays;
+		for (size_t i = 0; i < p_count; i++)
+		{
+			const auto min = glm::vec3(position_dis(gen), position_dis(gen), position_dis(gen));
+			boxes.push_back(Geometry::AABB(min, min + glm::vec3(size_dis(gen), size_dis(gen), size_dis(gen))));
+			rays.push_back(Geometry::Ray(glm::vec3(position_dis(gen), position_dis(gen), position_dis(gen)), glm::vec3(direction_dis(gen), direction_dis(gen), direction_dis(gen))));
+		}
+		return {boxes, rays};
+	}
+	// Evenly spread p_count points on a unit sphere, a stand-in for the icosphere meshes.
+	static std::vector<glm::vec3> make_sphere_points(size_t p_count)
+	{
+		std::vector<glm::vec3> points;
+		points.reserve(p_count);
+		const float golden_angle = glm::pi<float>() * (3.f - std::sqrt(5.f));
+		for (size_t i = 0; i < p_count; i++)
+		{
+			const float y      = 1.f - (static_cast<float>(i) + 0.5f) / static_cast<float>(p_count) * 2.f;
+			const float radius = std::sqrt(1.f - y * y);
+			const float theta  = golden_angle * static_cast<float>(i);
+			points.push_back(glm::vec3(std::cos(theta) * radius, y, std::sin(theta) * radius));
+		}
+		return points;
+	}
+	// Make p_count pairs of p_hull_1 and p_hull_2 at random positions within p_spread of each other.
+	// Uses a fixed seed so runs are repeatable.
+	static std::vector<GJK::HullPair> make_hull_pairs(const Geometry::ConvexHull& p_hull_1, const Geometry::ConvexHull& p_hull_2, size_t p_count, float p_spread)
+	{
+		std::mt19937 gen(42);
+		std::uniform_real_distribution<float> position_dis(-p_spread, p_spread);
+		std::uniform_real_distribution<float> angle_dis(-glm::pi<float>(), glm::pi<float>());
+
+		std::vector<GJK::HullPair> pairs;
+		pairs.reserve(p_count);
+		for (size_t i = 0; i < p_count; i++)
+		{
+			const auto orientation_1 = Utility::to_quaternion(angle_dis(gen), angle_dis(gen), angle_dis(gen));
+			const auto orientation_2 = Utility::to_quaternion(angle_dis(gen), angle_dis(gen), angle_dis(gen));
+			const auto position_2    = glm::vec3(position_dis(gen), position_dis(gen), position_dis(gen));
+			pairs.push_back({&p_hull_1, glm::mat4_cast(orientation_1), glm::inverse(orientation_1),
+			                 &p_hull_2, glm::translate(glm::mat4(1.f), position_2) * glm::mat4_cast(orientation_2), glm::inverse(orientation_2)});
+		}
+		return pairs;
+	}
+
+	// Make p_count AABBs with random positions, orientations and non-uniform scales to transform. Uses a fixed seed so runs are repeatable.
+	struct AABBTransforms
+	{
+		std::vector<Geometry::AABB> AABBs;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::quat> orientations;
+		std::vector<glm::vec3> scales;
+	};
+	static AABBTransforms make_AABB_transforms(size_t p_count)
+	{
+		const auto [boxes, rays] = make_boxes_and_rays(p_count, 10.f);
+		std::mt19937 gen(3);
+		std::uniform_real_distribution<float> angle_dis(-glm::pi<float>(), glm::pi<float>());
+		std::uniform_real_distribution<float> scale_dis(-3.f, 3.f);
+
+		AABBTransforms transforms{boxes, {}, {}, {}};
+		for (size_t i = 0; i < p_count; i++)
+		{
+			transforms.positions.push_back(rays[i].m_start);
+			transforms.orientations.push_back(Utility::to_quaternion(angle_dis(gen), angle_dis(gen), angle_dis(gen)));
+			transforms.scales.push_back(glm::vec3(scale_dis(gen), scale_dis(gen), scale_dis(gen)));
+		}
+		return transforms;
+	}
+
 	void GeometryTester::run_performance_tests()
 	{
+		{// BVH vs linear ray casts.
+			for (size_t box_count : {100, 1000, 10000})
+			{
+				const auto [boxes, rays] = make_boxes_and_rays(box_count, 100.f);
+				float length_along_ray   = 0.f;
+				size_t hit_count         = 0;
+
+				Utility::Stopwatch linear_stopwatch;
+				for (const auto& ray : rays)
+				{
+					for (const auto& box : boxes)
+						hit_count += Geometry::get_intersection(box, ray, &length_along_ray).has_value();
+				}
+				const auto linear_time = linear_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch build_stopwatch;
+				const auto bvh = Geometry::BVH(boxes);
+				const auto build_time = build_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch closest_stopwatch;
+				for (const auto& ray : rays)
+					bvh.traverse(ray, [&](size_t, float p_length_along_ray) { hit_count++; return p_length_along_ray; });
+				const auto closest_time = closest_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch all_stopwatch;
+				for (const auto& ray : rays)
+					bvh.traverse(ray, [&](size_t, float) { hit_count++; return Geometry::BVH::Max_distance; });
+				const auto all_time = all_stopwatch.duration_since_start<float, std::milli>().count();
+
+				printf("BVH %zu rays v %zu AABBs (%zu hits): linear %fms, build %fms, closest hit %fms, all hits %fms\n",
+					rays.size(), box_count, hit_count, linear_time, build_time, closest_time, all_time);
+			}
+		}
+		{// Loose octree vs linear AABB queries.
+			for (size_t box_count : {1000, 10000, 100000})
+			{
+				const auto [boxes, rays] = make_boxes_and_rays(box_count, 100.f);
+				size_t found_count = 0;
+
+				Utility::Stopwatch build_stopwatch;
+				auto octree = Geometry::LooseOctree(Geometry::AABB(glm::vec3(-100.f), glm::vec3(100.f)));
+				for (const auto& box : boxes)
+					octree.insert(box);
+				const auto build_time = build_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch linear_stopwatch;
+				for (size_t r = 0; r < 1000; r++)
+				{
+					const auto range = Geometry::AABB(rays[r].m_start, rays[r].m_start + glm::vec3(10.f));
+					for (const auto& box : boxes)
+						found_count += Geometry::intersecting(box, range);
+				}
+				const auto linear_time = linear_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch octree_stopwatch;
+				for (size_t r = 0; r < 1000; r++)
+					octree.query(Geometry::AABB(rays[r].m_start, rays[r].m_start + glm::vec3(10.f)), [&](Geometry::LooseOctree::ItemID) { found_count++; });
+				const auto octree_time = octree_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch move_stopwatch;
+				for (size_t i = 0; i < box_count; i++)
+					octree.move(static_cast<Geometry::LooseOctree::ItemID>(i), Geometry::AABB(boxes[i].m_min + glm::vec3(0.5f), boxes[i].m_max + glm::vec3(0.5f)));
+				const auto move_time = move_stopwatch.duration_since_start<float, std::milli>().count();
+
+				printf("Octree 1000 AABB queries v %zu AABBs (%zu found): linear %fms, build %fms, octree %fms, move all %fms\n",
+					box_count, found_count, linear_time, build_time, octree_time, move_time);
+			}
+		}
+		{// AABB transform per AABB vs batched.
+			for (size_t AABB_count : {1000, 10000, 100000})
+			{
+				const auto transforms = make_AABB_transforms(AABB_count);
+				std::vector<Geometry::AABB> world_AABBs(AABB_count);
+
+				Utility::Stopwatch single_stopwatch;
+				for (size_t i = 0; i < AABB_count; i++)
+					world_AABBs[i] = Geometry::AABB::transform(transforms.AABBs[i], transforms.positions[i], glm::mat4_cast(transforms.orientations[i]), transforms.scales[i]);
+				const auto single_time = single_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch batch_stopwatch;
+				Geometry::AABB::transform(transforms.AABBs, transforms.positions, transforms.orientations, transforms.scales, world_AABBs);
+				const auto batch_time = batch_stopwatch.duration_since_start<float, std::milli>().count();
+
+				printf("AABB transform %zu AABBs: per AABB %fms, batched %fms\n", AABB_count, single_time, batch_time);
+			}
+		}
+		{// Mesh v mesh triangle intersection all pairs vs BVH pruned.
+			for (size_t point_count : {162, 642, 2562})
+			{
+				const auto sphere_hull = Geometry::ConvexHull(make_sphere_points(point_count));
+				std::vector<Geometry::Triangle> triangles;
+				for (size_t i = 0; i < sphere_hull.triangles().size(); i += 3)
+					triangles.emplace_back(sphere_hull.vertices()[sphere_hull.triangles()[i]], sphere_hull.vertices()[sphere_hull.triangles()[i + 1]], sphere_hull.vertices()[sphere_hull.triangles()[i + 2]]);
+				const auto transform = glm::translate(glm::identity<glm::mat4>(), glm::vec3(1.2f, 0.3f, 0.f));
+				size_t hit_count = 0;
+
+				Utility::Stopwatch brute_force_stopwatch;
+				for (const auto& triangle : triangles)
+				{
+					for (const auto& other : triangles)
+						hit_count += Geometry::intersecting(triangle, Geometry::Triangle(glm::vec3(transform * glm::vec4(other.m_point_1, 1.f)), glm::vec3(transform * glm::vec4(other.m_point_2, 1.f)), glm::vec3(transform * glm::vec4(other.m_point_3, 1.f))));
+				}
+				const auto brute_force_time = brute_force_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch build_stopwatch;
+				const auto triangle_BVH = Geometry::TriangleBVH(std::vector<Geometry::Triangle>(triangles));
+				const auto build_time = build_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch all_stopwatch;
+				const auto hits = triangle_BVH.get_intersections(triangle_BVH, transform);
+				const auto all_time = all_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch first_stopwatch;
+				hit_count += triangle_BVH.get_intersection(triangle_BVH, transform).has_value();
+				const auto first_time = first_stopwatch.duration_since_start<float, std::milli>().count();
+
+				printf("Mesh v mesh %zu v %zu triangles (%zu hits): all pairs %fms, BVH build %fms, BVH all hits %fms, BVH first hit %fms\n",
+					triangles.size(), triangles.size(), hits.size(), brute_force_time, build_time, all_time, first_time);
+			}
+		}
+		{// Triangle distance per triangle vs batched.
+			for (size_t triangle_count : {1000, 10000, 100000})
+			{
+				std::mt19937 gen(3);
+				std::uniform_real_distribution<float> position_dis(-100.f, 100.f);
+				std::vector<Geometry::Triangle> triangles;
+				for (size_t i = 0; i < triangle_count; i++)
+				{
+					const auto corner = glm::vec3(position_dis(gen), position_dis(gen), position_dis(gen));
+					triangles.push_back(Geometry::Triangle(corner, corner + glm::vec3(1.f, 0.f, 0.f), corner + glm::vec3(0.f, 1.f, 1.f)));
+				}
+				std::vector<float> distances(triangle_count);
+				const auto point = glm::vec3(1.f, 2.f, 3.f);
+
+				Utility::Stopwatch single_stopwatch;
+				for (size_t i = 0; i < triangle_count; i++)
+					distances[i] = Geometry::distance_squared(triangles[i], point);
+				const auto single_time = single_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch batch_stopwatch;
+				Geometry::distance_squared(triangles, point, distances);
+				const auto batch_time = batch_stopwatch.duration_since_start<float, std::milli>().count();
+
+				printf("Point to triangle distance %zu triangles: per triangle %fms, batched %fms\n", triangle_count, single_time, batch_time);
+			}
+		}
+		{// Frustrum culling per AABB vs batched.
+			const auto frustrum = Geometry::Frustrum(glm::perspective(glm::radians(60.f), 1.5f, 0.1f, 100.f) * glm::lookAt(glm::vec3(0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f)));
+			for (size_t AABB_count : {1000, 10000, 100000})
+			{
+				const auto [boxes, rays] = make_boxes_and_rays(AABB_count, 100.f);
+				std::vector<uint8_t> plane_cache(AABB_count, 0);
+				std::vector<uint8_t> visible(AABB_count, 0);
+				size_t visible_count = 0;
+
+				Utility::Stopwatch single_stopwatch;
+				for (const auto& box : boxes)
+					visible_count += Geometry::intersecting(frustrum, box);
+				const auto single_time = single_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch batch_cold_stopwatch;
+				frustrum.cull(boxes, plane_cache, visible);
+				const auto batch_cold_time = batch_cold_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch batch_warm_stopwatch;
+				frustrum.cull(boxes, plane_cache, visible);
+				const auto batch_warm_time = batch_warm_stopwatch.duration_since_start<float, std::milli>().count();
+
+				printf("Frustrum cull %zu AABBs (%zu visible): per AABB %fms, batched cold cache %fms, batched warm cache %fms\n",
+					AABB_count, visible_count, single_time, batch_cold_time, batch_warm_time);
+			}
+		}
+		{// GJK single-pair vs batched.
+			const auto sphere_points = make_sphere_points(642);
+			const auto sphere_hull   = Geometry::ConvexHull(sphere_points);
+
+			for (size_t pair_count : {100, 1000, 10000})
+			{
+				const auto pairs = make_hull_pairs(sphere_hull, sphere_hull, pair_count, 4.f);
+				std::vector<glm::quat> orientations;
+				orientations.reserve(pairs.size() * 2);
+				for (const auto& pair : pairs)
+				{
+					orientations.push_back(glm::inverse(pair.inverse_orientation_1));
+					orientations.push_back(glm::inverse(pair.inverse_orientation_2));
+				}
+
+				size_t point_set_intersect_count = 0;
+				Utility::Stopwatch point_set_stopwatch;
+				for (size_t i = 0; i < pairs.size(); i++)
+					point_set_intersect_count += GJK::intersecting(sphere_points, pairs[i].transform_1, orientations[i * 2], sphere_points, pairs[i].transform_2, orientations[i * 2 + 1]);
+				const auto point_set_time = point_set_stopwatch.duration_since_start<float, std::milli>().count();
+
+				size_t hull_intersect_count = 0;
+				Utility::Stopwatch hull_stopwatch;
+				for (size_t i = 0; i < pairs.size(); i++)
+					hull_intersect_count += GJK::intersecting(*pairs[i].hull_1, pairs[i].transform_1, orientations[i * 2], *pairs[i].hull_2, pairs[i].transform_2, orientations[i * 2 + 1]);
+				const auto hull_time = hull_stopwatch.duration_since_start<float, std::milli>().count();
+
+				std::vector<GJK::PairCache> caches(pairs.size());
+				std::vector<size_t> intersecting;
+				std::vector<GJK::Simplex> simplices;
+				Utility::Stopwatch batch_cold_stopwatch;
+				GJK::intersecting(pairs, caches, intersecting, simplices);
+				const auto batch_cold_time = batch_cold_stopwatch.duration_since_start<float, std::milli>().count();
+
+				Utility::Stopwatch batch_warm_stopwatch;
+				GJK::intersecting(pairs, caches, intersecting, simplices);
+				const auto batch_warm_time = batch_warm_stopwatch.duration_since_start<float, std::milli>().count();
+				CHECK_EQUAL(hull_intersect_count, point_set_intersect_count, "GJK hull intersect count matches point set");
+				CHECK_EQUAL(intersecting.size(), point_set_intersect_count, "GJK batched intersect count matches point set");
+
+				printf("GJK %zu pairs (%zu intersecting): point set %fms, hull %fms, batched cold %fms, batched warm %fms\n",
+					pair_count, intersecting.size(), point_set_time, hull_time, batch_cold_time, batch_warm_time);
+			}
+		}
+
 		//constexpr size_t triangle_count = 1000000 * 2;
 		//std::vector<float> random_triangle_points = Utility::get_random_numbers(std::numeric_limits<float>::min(), std::numeric_limits<float>::max(), triangle_count * 3 * 3);
 		//std::vector<Geometry::Triangle> triangles;
@@ -90,6 +404,21 @@ namespace Test
 			CHECK_EQUAL(aabb.get_size(), glm::vec3(4.f), "AABB initialised with min and max not at origin");
 			CHECK_EQUAL(aabb.get_center(), glm::vec3(3.f), "AABB initialised with min and max not at origin");
 		}
+		{SCOPE_SECTION("Batched transform");
+			// 103 AABBs covers whole groups of SIMD lanes and a remainder.
+			const auto transforms = make_AABB_transforms(103);
+			std::vector<Geometry::AABB> world_AABBs(transforms.AABBs.size());
+			Geometry::AABB::transform(transforms.AABBs, transforms.positions, transforms.orientations, transforms.scales, world_AABBs);
+
+			bool matches = true;
+			for (size_t i = 0; i < world_AABBs.size(); i++)
+			{
+				const auto expected = Geometry::AABB::transform(transforms.AABBs[i], transforms.positions[i], glm::mat4_cast(transforms.orientations[i]), transforms.scales[i]);
+				if (glm::length(world_AABBs[i].m_min - expected.m_min) > 0.001f || glm::length(world_AABBs[i].m_max - expected.m_max) > 0.001f)
+					matches = false;
+			}
+			CHECK_TRUE(matches, "Matches transform per AABB");
+		}
 	}
 
 	void GeometryTester::run_triangle_tests()
@@ -294,6 +623,45 @@ namespace Test
 				CHECK_EQUAL(frustrum.m_far.m_normal,    glm::vec3(0.f, 0.f, -1.f), "Far");
 			}
 		}
+		{SCOPE_SECTION("Culling");
+			// An odd count so the AABBs left over from the batches of four are culled too.
+			const auto [boxes, rays] = make_boxes_and_rays(1003, 20.f);
+			const auto projection    = glm::perspective(glm::radians(60.f), 1.5f, 0.1f, 30.f);
+			std::vector<uint8_t> plane_cache(boxes.size(), 0);
+			std::vector<uint8_t> visible(boxes.size(), 0);
+
+			// Cull boxes from p_eye, checking the visible set against intersecting(Frustrum, AABB) and every rejected box against its cached plane.
+			auto cull_matches = [&](const glm::vec3& p_eye, const glm::vec3& p_target)
+			{
+				const auto frustrum      = Geometry::Frustrum(projection * glm::lookAt(p_eye, p_target, glm::vec3(0.f, 1.f, 0.f)));
+				const auto planes        = frustrum.inside_plane_equations();
+				const auto visible_count = frustrum.cull(boxes, plane_cache, visible);
+
+				bool match = true;
+				size_t expected_count = 0;
+				for (size_t i = 0; i < boxes.size(); i++)
+				{
+					const bool expected = Geometry::intersecting(frustrum, boxes[i]);
+					expected_count += expected;
+					match &= (visible[i] == 1) == expected;
+
+					if (!expected)
+					{
+						const auto& plane = planes[plane_cache[i]];
+						const auto positive_vertex = glm::vec3(plane.x >= 0.f ? boxes[i].m_max.x : boxes[i].m_min.x, plane.y >= 0.f ? boxes[i].m_max.y : boxes[i].m_min.y, plane.z >= 0.f ? boxes[i].m_max.z : boxes[i].m_min.z);
+						match &= glm::dot(glm::vec3(plane), positive_vertex) + plane.w < 0.f;
+					}
+				}
+				return match && visible_count == expected_count && expected_count > 0 && expected_count < boxes.size();
+			};
+
+			CHECK_TRUE(cull_matches(glm::vec3(-10.f, 5.f, 10.f), glm::vec3(0.f)), "Matches intersecting with an empty cache");
+			CHECK_TRUE(cull_matches(glm::vec3(-9.f, 5.f, 10.f), glm::vec3(1.f, 0.f, 0.f)), "Matches intersecting after the camera moves");
+			CHECK_TRUE(cull_matches(glm::vec3(10.f, -5.f, -10.f), glm::vec3(0.f)), "Matches intersecting after the camera turns around");
+
+			std::fill(plane_cache.begin(), plane_cache.end(), uint8_t(255));
+			CHECK_TRUE(cull_matches(glm::vec3(-10.f, 5.f, 10.f), glm::vec3(0.f)), "Out of range cache entries are ignored");
+		}
 	}
 
 	void GeometryTester::run_sphere_tests()
@@ -524,5 +892,642 @@ namespace Test
 			CHECK_TRUE(!Geometry::point_inside(ray, point_on_ray_behind), "Point behind ray start");
 		}
 	}
+
+	void GeometryTester::run_distance_tests()
+	{SCOPE_SECTION("Batch distance");
+		// An odd count so the shapes left over from the batches of four are covered too.
+		// Points are spread beyond the shapes so every Voronoi region of the triangles is hit.
+		constexpr size_t count = 1003;
+		std::mt19937 gen(11);
+		std::uniform_real_distribution<float> position_dis(-10.f, 10.f);
+		auto random_point = [&]() { return glm::vec3(position_dis(gen), position_dis(gen), position_dis(gen)); };
+
+		std::vector<glm::vec3> points;
+		std::vector<Geometry::LineSegment> lines;
+		std::vector<Geometry::Triangle> triangles;
+		for (size_t i = 0; i < count; i++)
+		{
+			points.push_back(random_point());
+			lines.push_back(Geometry::LineSegment(random_point(), random_point()));
+			triangles.push_back(Geometry::Triangle(random_point(), random_point(), random_point()));
+		}
+		const auto [AABBs, rays] = make_boxes_and_rays(count, 10.f);
+		// Points on the shapes themselves.
+		points[0] = lines[0].m_start;
+		points[1] = triangles[0].m_point_2;
+		points[2] = AABBs[0].m_max;
+		points[3] = (triangles[0].m_point_1 + triangles[0].m_point_3) * 0.5f;
+
+		// Compare every batched distance against the single shape distance_squared.
+		std::vector<float> distances(count);
+		auto matches = [&](auto p_expected)
+		{
+			bool match = true;
+			for (size_t i = 0; i < count; i++)
+			{
+				const float expected = p_expected(i);
+				match &= std::abs(distances[i] - expected) <= 1e-5f * std::max(1.f, expected);
+			}
+			return match;
+		};
+
+		{SCOPE_SECTION("Point to many");
+			const auto point = points[5];
+			Geometry::distance_squared(lines, point, distances);
+			CHECK_TRUE(matches([&](size_t i) { return Geometry::distance_squared(lines[i], point); }), "Line segments");
+			Geometry::distance_squared(AABBs, point, distances);
+			CHECK_TRUE(matches([&](size_t i) { return Geometry::distance_squared(AABBs[i], point); }), "AABBs");
+			Geometry::distance_squared(triangles, point, distances);
+			CHECK_TRUE(matches([&](size_t i) { return Geometry::distance_squared(triangles[i], point); }), "Triangles");
+		}
+		{SCOPE_SECTION("Many to shape");
+			Geometry::distance_squared(lines[0], points, distances);
+			CHECK_TRUE(matches([&](size_t i) { return Geometry::distance_squared(lines[0], points[i]); }), "Line segment");
+			Geometry::distance_squared(AABBs[0], points, distances);
+			CHECK_TRUE(matches([&](size_t i) { return Geometry::distance_squared(AABBs[0], points[i]); }), "AABB");
+			Geometry::distance_squared(triangles[0], points, distances);
+			CHECK_TRUE(matches([&](size_t i) { return Geometry::distance_squared(triangles[0], points[i]); }), "Triangle");
+			CHECK_EQUAL(distances[1], 0.f, "Triangle vertex");
+			CHECK_EQUAL_FLOAT(distances[3], 0.f, "Triangle edge", 0.0001f);
+		}
+		{SCOPE_SECTION("Single shape");
+			const auto AABB = Geometry::AABB(glm::vec3(-1.f), glm::vec3(1.f));
+			CHECK_EQUAL(Geometry::distance_squared(AABB, glm::vec3(0.5f, 0.f, 0.f)), 0.f, "Point inside AABB");
+			CHECK_EQUAL(Geometry::distance_squared(AABB, glm::vec3(3.f, 2.f, 0.f)), 5.f, "Point outside AABB");
+
+			const auto triangle = Geometry::Triangle(glm::vec3(0.f), glm::vec3(2.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 2.f));
+			CHECK_EQUAL(Geometry::distance_squared(triangle, glm::vec3(0.5f, 3.f, 0.5f)), 9.f, "Point above triangle face");
+			CHECK_EQUAL(Geometry::distance_squared(triangle, glm::vec3(-1.f, 0.f, -1.f)), 2.f, "Point outside triangle vertex");
+		}
+	}
+	void GeometryTester::run_convex_hull_tests()
+	{SCOPE_SECTION("Convex hull");
+		// Unit cube corners with points on the faces, edges and inside which are not part of the hull.
+		std::vector<glm::vec3> points;
+		for (float x : {-1.f, 0.f, 1.f})
+			for (float y : {-1.f, 0.f, 1.f})
+				for (float z : {-1.f, 0.5f, 1.f})
+					points.push_back(glm::vec3(x, y, z));
+
+		const auto hull = Geometry::ConvexHull(points);
+
+		{SCOPE_SECTION("Cube");
+			CHECK_EQUAL(hull.vertices().size(), 8, "Vertex count");
+			CHECK_EQUAL(hull.triangles().size(), 36, "Triangle index count");
+
+			bool neighbours_valid = true;
+			for (size_t i = 0; i < hull.vertices().size(); i++)
+			{
+				// Every cube corner has its 3 edge neighbours plus up to 3 face diagonals depending on triangulation.
+				const auto neighbours = hull.neighbours(i);
+				if (neighbours.size() < 3 || neighbours.size() > 6)
+					neighbours_valid = false;
+			}
+			CHECK_TRUE(neighbours_valid, "Neighbour count");
+		}
+		{SCOPE_SECTION("Support matches brute force");
+			const std::array<glm::vec3, 6> directions = {glm::vec3(1.f, 1.f, 1.f), glm::vec3(-1.f, 1.f, -1.f), glm::vec3(1.f, -2.f, 0.5f),
+			                                             glm::vec3(0.1f, 0.2f, -1.f), glm::vec3(-3.f, -0.5f, 0.2f), glm::vec3(0.f, 1.f, 0.1f)};
+			bool support_matches = true;
+			for (const auto& direction : directions)
+			{
+				float furthest = std::numeric_limits<float>::lowest();
+				for (const auto& point : points)
+					furthest = std::max(furthest, glm::dot(direction, point));
+
+				// Every start vertex must climb to the same furthest distance.
+				for (size_t start = 0; start < hull.vertices().size(); start++)
+				{
+					size_t vertex = start;
+					if (glm::dot(direction, hull.support_point(direction, vertex)) != furthest)
+						support_matches = false;
+				}
+			}
+			CHECK_TRUE(support_matches, "Support point");
+		}
+		{SCOPE_SECTION("Degenerate");
+			// Coplanar points have no volume, every unique point is kept.
+			const auto quad = Geometry::ConvexHull({glm::vec3(0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(1.f, 1.f, 0.f), glm::vec3(0.f, 1.f, 0.f), glm::vec3(1.f, 0.f, 0.f)});
+			CHECK_EQUAL(quad.vertices().size(), 4, "Vertex count");
+
+			size_t vertex = 0;
+			CHECK_EQUAL(quad.support_point(glm::vec3(1.f, 1.f, 0.f), vertex), glm::vec3(1.f, 1.f, 0.f), "Support point");
+		}
+	}
+
+	void GeometryTester::run_GJK_batch_tests()
+	{SCOPE_SECTION("GJK batch");
+		const auto sphere_points = make_sphere_points(162);
+		const auto sphere_hull   = Geometry::ConvexHull(sphere_points);
+		const std::vector<glm::vec3> cube_points = {glm::vec3(-1.f, -1.f, -1.f), glm::vec3(1.f, -1.f, -1.f), glm::vec3(1.f, 1.f, -1.f), glm::vec3(-1.f, 1.f, -1.f),
+		                                            glm::vec3(-1.f, -1.f,  1.f), glm::vec3(1.f, -1.f,  1.f), glm::vec3(1.f, 1.f,  1.f), glm::vec3(-1.f, 1.f,  1.f)};
+		const auto cube_hull = Geometry::ConvexHull(cube_points);
+
+		const auto pairs = make_hull_pairs(sphere_hull, cube_hull, 200, 3.f);
+		std::vector<GJK::PairCache> caches(pairs.size());
+		std::vector<size_t> intersecting;
+		std::vector<GJK::Simplex> simplices;
+
+		std::vector<size_t> expected_intersecting;
+		for (size_t i = 0; i < pairs.size(); i++)
+		{
+			if (GJK::intersecting(sphere_points, pairs[i].transform_1, glm::inverse(pairs[i].inverse_orientation_1), cube_points, pairs[i].transform_2, glm::inverse(pairs[i].inverse_orientation_2)))
+				expected_intersecting.push_back(i);
+		}
+
+		{SCOPE_SECTION("Cold");
+			GJK::intersecting(pairs, caches, intersecting, simplices);
+			CHECK_CONTAINER_EQUAL(intersecting, expected_intersecting, "Matches single-pair");
+			CHECK_EQUAL(simplices.size(), intersecting.size(), "Simplex per intersecting pair");
+		}
+		{SCOPE_SECTION("Warm");
+			// The second query runs from the cached separating axes and support vertices.
+			GJK::intersecting(pairs, caches, intersecting, simplices);
+			CHECK_CONTAINER_EQUAL(intersecting, expected_intersecting, "Matches single-pair");
+		}
+		{SCOPE_SECTION("EPA");
+			std::vector<GJK::CollisionPoint> collision_points;
+			GJK::EPA(pairs, intersecting, simplices, caches, collision_points);
+			CHECK_EQUAL(collision_points.size(), intersecting.size(), "Collision point per intersecting pair");
+
+			bool depths_match = true;
+			for (size_t i = 0; i < intersecting.size(); i++)
+			{
+				const auto& pair    = pairs[intersecting[i]];
+				const auto expected = GJK::EPA(simplices[i], sphere_points, pair.transform_1, glm::inverse(pair.inverse_orientation_1), cube_points, pair.transform_2, glm::inverse(pair.inverse_orientation_2));
+				if (std::abs(collision_points[i].penetration_depth - expected.penetration_depth) > 0.01f)
+					depths_match = false;
+			}
+			CHECK_TRUE(depths_match, "Penetration depth matches single-pair");
+		}
+	}
+
+	void GeometryTester::run_BVH_tests()
+	{SCOPE_SECTION("BVH");
+		const auto [boxes, rays] = make_boxes_and_rays(500, 20.f);
+		const auto bvh = Geometry::BVH(boxes);
+
+		{SCOPE_SECTION("Empty");
+			const auto empty_bvh = Geometry::BVH(std::vector<Geometry::AABB>{});
+			size_t visit_count = 0;
+			empty_bvh.traverse(rays.front(), [&](size_t, float p_length_along_ray) { visit_count++; return p_length_along_ray; });
+			CHECK_TRUE(empty_bvh.empty(), "Empty");
+			CHECK_EQUAL(visit_count, 0, "No visits");
+		}
+		{SCOPE_SECTION("Leaves");
+			size_t item_count = 0;
+			for (const auto& node : bvh.nodes())
+			{
+				if (node.is_leaf())
+					item_count += node.count;
+			}
+			CHECK_EQUAL(item_count, boxes.size(), "Every item in one leaf");
+		}
+
+		// Brute force the hits of every ray for comparison.
+		std::vector<std::vector<std::pair<size_t, float>>> expected_hits(rays.size());
+		for (size_t r = 0; r < rays.size(); r++)
+		{
+			for (size_t i = 0; i < boxes.size(); i++)
+			{
+				float length_along_ray = 0.f;
+				if (Geometry::get_intersection(boxes[i], rays[r], &length_along_ray))
+					expected_hits[r].push_back({i, length_along_ray});
+			}
+			std::sort(expected_hits[r].begin(), expected_hits[r].end());
+		}
+
+		{SCOPE_SECTION("All hits");
+			bool hits_match = true;
+			for (size_t r = 0; r < rays.size(); r++)
+			{
+				std::vector<std::pair<size_t, float>> hits;
+				bvh.traverse(rays[r], [&](size_t p_item, float p_length_along_ray) { hits.push_back({p_item, p_length_along_ray}); return Geometry::BVH::Max_distance; });
+				std::sort(hits.begin(), hits.end());
+				if (hits != expected_hits[r])
+					hits_match = false;
+			}
+			CHECK_TRUE(hits_match, "Matches brute force");
+		}
+		{SCOPE_SECTION("Closest hit");
+			bool closest_match = true;
+			std::vector<float> packet_distances(rays.size(), Geometry::BVH::Max_distance);
+			bvh.traverse(std::span<const Geometry::Ray>(rays), std::span<float>(packet_distances), [](size_t, size_t, float p_length_along_ray) { return p_length_along_ray; });
+
+			for (size_t r = 0; r < rays.size(); r++)
+			{
+				float expected = Geometry::BVH::Max_distance;
+				for (const auto& [item, length_along_ray] : expected_hits[r])
+					expected = std::min(expected, length_along_ray);
+
+				float closest = Geometry::BVH::Max_distance;
+				bvh.traverse(rays[r], [&](size_t, float p_length_along_ray) { closest = p_length_along_ray; return p_length_along_ray; });
+				if (closest != expected || packet_distances[r] != expected)
+					closest_match = false;
+			}
+			CHECK_TRUE(closest_match, "Single ray and packet match brute force");
+		}
+		{SCOPE_SECTION("Refit");
+			// Scatter every other box so the refitted nodes no longer follow the partition the tree was built on.
+			auto moved_boxes = boxes;
+			for (size_t i = 0; i < moved_boxes.size(); i += 2)
+			{
+				const auto offset = glm::vec3(static_cast<float>(i % 7) - 3.f, static_cast<float>(i % 5) - 2.f, static_cast<float>(i % 3) - 1.f) * 4.f;
+				moved_boxes[i] = Geometry::AABB(moved_boxes[i].m_min + offset, moved_boxes[i].m_max + offset);
+			}
+			auto refitted = bvh;
+			refitted.refit(moved_boxes);
+
+			bool hits_match = true;
+			for (const auto& ray : rays)
+			{
+				std::vector<std::pair<size_t, float>> expected;
+				for (size_t i = 0; i < moved_boxes.size(); i++)
+				{
+					float length_along_ray = 0.f;
+					if (Geometry::get_intersection(moved_boxes[i], ray, &length_along_ray))
+						expected.push_back({i, length_along_ray});
+				}
+				std::vector<std::pair<size_t, float>> hits;
+				refitted.traverse(ray, [&](size_t p_item, float p_length_along_ray) { hits.push_back({p_item, p_length_along_ray}); return Geometry::BVH::Max_distance; });
+				std::sort(expected.begin(), expected.end());
+				std::sort(hits.begin(), hits.end());
+				if (hits != expected)
+					hits_match = false;
+			}
+			CHECK_TRUE(hits_match, "Refitted hits match brute force");
+			CHECK_TRUE(refitted.SAH_cost() > Geometry::BVH(moved_boxes).SAH_cost(), "Rebuilding lowers the SAH cost of a refitted tree");
+
+			refitted.refit(boxes);
+			bool nodes_match = true;
+			for (size_t i = 0; i < bvh.nodes().size(); i++)
+			{
+				if (refitted.nodes()[i].bounds.m_min != bvh.nodes()[i].bounds.m_min || refitted.nodes()[i].bounds.m_max != bvh.nodes()[i].bounds.m_max)
+					nodes_match = false;
+			}
+			CHECK_TRUE(nodes_match, "Refit to the built bounds restores the nodes");
+			CHECK_EQUAL_FLOAT(refitted.SAH_cost(), bvh.SAH_cost(), "Refit to the built bounds restores the SAH cost", 0.0001f);
+		}
+		{SCOPE_SECTION("Ray v Triangle");
+			const auto triangle = Geometry::Triangle(glm::vec3(-1.f, 0.f, -1.f), glm::vec3(1.f, 0.f, -1.f), glm::vec3(0.f, 0.f, 1.f));
+			float length_along_ray = 0.f;
+			auto hit = Geometry::get_intersection(Geometry::Ray(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, -0.5f, 0.f)), triangle, &length_along_ray);
+			CHECK_TRUE(hit.has_value(), "Hit from above");
+			CHECK_EQUAL(length_along_ray, 4.f, "Distance in multiples of direction");
+			CHECK_TRUE(Geometry::get_intersection(Geometry::Ray(glm::vec3(0.f, -2.f, 0.f), glm::vec3(0.f, 1.f, 0.f)), triangle).has_value(), "Hit from below");
+			CHECK_TRUE(!Geometry::get_intersection(Geometry::Ray(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, 1.f, 0.f)), triangle).has_value(), "Behind ray start");
+			CHECK_TRUE(!Geometry::get_intersection(Geometry::Ray(glm::vec3(3.f, 2.f, 0.f), glm::vec3(0.f, -1.f, 0.f)), triangle).has_value(), "Miss");
+		}
+		{SCOPE_SECTION("Triangles");
+			const auto sphere_hull = Geometry::ConvexHull(make_sphere_points(642));
+			std::vector<Geometry::Triangle> triangles;
+			for (size_t i = 0; i < sphere_hull.triangles().size(); i += 3)
+				triangles.emplace_back(sphere_hull.vertices()[sphere_hull.triangles()[i]], sphere_hull.vertices()[sphere_hull.triangles()[i + 1]], sphere_hull.vertices()[sphere_hull.triangles()[i + 2]]);
+			const auto triangle_BVH = Geometry::TriangleBVH(std::vector<Geometry::Triangle>(triangles));
+
+			bool closest_match = true;
+			bool any_match     = true;
+			const auto [sphere_boxes, sphere_rays] = make_boxes_and_rays(200, 2.f);
+			for (const auto& ray : sphere_rays)
+			{
+				std::optional<float> expected;
+				for (const auto& triangle : triangles)
+				{
+					float length_along_ray = 0.f;
+					if (Geometry::get_intersection(ray, triangle, &length_along_ray) && (!expected || length_along_ray < *expected))
+						expected = length_along_ray;
+				}
+
+				const auto hit = triangle_BVH.get_intersection(ray);
+				if (hit.has_value() != expected.has_value() || (hit && hit->distance_along_ray != *expected))
+					closest_match = false;
+				if (triangle_BVH.intersecting(ray) != expected.has_value())
+					any_match = false;
+			}
+			CHECK_TRUE(closest_match, "Closest hit matches brute force");
+			CHECK_TRUE(any_match, "Any hit matches brute force");
+		}
+		{SCOPE_SECTION("Mesh v mesh");
+			const auto sphere_hull = Geometry::ConvexHull(make_sphere_points(162));
+			std::vector<Geometry::Triangle> triangles;
+			for (size_t i = 0; i < sphere_hull.triangles().size(); i += 3)
+				triangles.emplace_back(sphere_hull.vertices()[sphere_hull.triangles()[i]], sphere_hull.vertices()[sphere_hull.triangles()[i + 1]], sphere_hull.vertices()[sphere_hull.triangles()[i + 2]]);
+			const auto triangle_BVH = Geometry::TriangleBVH(std::vector<Geometry::Triangle>(triangles));
+
+			// Every pair found testing each triangle of the sphere against each triangle of the sphere transformed by p_transform.
+			auto brute_force = [&](const glm::mat4& p_transform)
+			{
+				std::vector<std::pair<size_t, size_t>> pairs;
+				for (size_t i = 0; i < triangles.size(); i++)
+				{
+					for (size_t j = 0; j < triangles.size(); j++)
+					{
+						const auto other = Geometry::Triangle(glm::vec3(p_transform * glm::vec4(triangles[j].m_point_1, 1.f)),
+						                                      glm::vec3(p_transform * glm::vec4(triangles[j].m_point_2, 1.f)),
+						                                      glm::vec3(p_transform * glm::vec4(triangles[j].m_point_3, 1.f)));
+						if (Geometry::intersecting(triangles[i], other))
+							pairs.push_back({i, j});
+					}
+				}
+				return pairs;
+			};
+			auto all_match = [&](const glm::mat4& p_transform)
+			{
+				std::vector<std::pair<size_t, size_t>> found;
+				for (const auto& pair : triangle_BVH.get_intersections(triangle_BVH, p_transform))
+					found.push_back({pair.triangle, pair.other_triangle});
+				std::sort(found.begin(), found.end());
+				return found == brute_force(p_transform);
+			};
+
+			const auto overlapping = glm::translate(glm::identity<glm::mat4>(), glm::vec3(1.2f, 0.3f, 0.f)) * glm::rotate(glm::identity<glm::mat4>(), glm::radians(30.f), glm::vec3(0.f, 1.f, 1.f)) * glm::scale(glm::identity<glm::mat4>(), glm::vec3(0.8f));
+			const auto separate    = glm::translate(glm::identity<glm::mat4>(), glm::vec3(2.5f, 0.f, 0.f));
+			CHECK_TRUE(all_match(overlapping), "All hits match brute force");
+			CHECK_TRUE(!brute_force(overlapping).empty(), "Overlapping meshes intersect");
+			CHECK_TRUE(all_match(separate), "No hits match brute force");
+
+			const auto first_hit = triangle_BVH.get_intersection(triangle_BVH, overlapping);
+			const auto expected  = brute_force(overlapping);
+			CHECK_TRUE(first_hit.has_value() && std::find(expected.begin(), expected.end(), std::make_pair(first_hit->triangle, first_hit->other_triangle)) != expected.end(), "First hit is an intersecting pair");
+			CHECK_TRUE(!triangle_BVH.get_intersection(triangle_BVH, separate).has_value(), "No first hit for separate meshes");
+		}
+	}
+	void GeometryTester::run_heightfield_tests()
+	{SCOPE_SECTION("Heightfield");
+		{SCOPE_SECTION("Height");
+			// A 2x1 field sloping up along X with a 2m cell size.
+			const auto slope = Geometry::Heightfield(2, 1, 2.f, std::vector<float>{0.f, 1.f, 2.f, 0.f, 1.f, 2.f});
+			CHECK_EQUAL_FLOAT(*slope.get_height(0.f, 0.f), 0.f, "Sample", 0.0001f);
+			CHECK_EQUAL_FLOAT(*slope.get_height(3.f, 1.f), 1.5f, "Bilinear", 0.0001f);
+			CHECK_EQUAL_FLOAT(*slope.get_height(4.f, 2.f), 2.f, "Far edge", 0.0001f);
+			CHECK_TRUE(!slope.get_height(-0.1f, 1.f).has_value(), "Outside");
+			CHECK_TRUE(glm::length(*slope.get_normal(1.f, 1.f) - glm::normalize(glm::vec3(-0.5f, 1.f, 0.f))) < 0.0001f, "Normal");
+		}
+
+		std::mt19937 generator(7);
+		std::uniform_real_distribution<float> height_distribution(-2.f, 2.f);
+		const size_t cells = 32;
+		std::vector<float> heights((cells + 1) * (cells + 1));
+		for (auto& height : heights)
+			height = height_distribution(generator);
+		const auto field = Geometry::Heightfield(cells, cells, 0.5f, std::move(heights));
+
+		{SCOPE_SECTION("Ray");
+			std::vector<Geometry::Triangle> triangles;
+			for (size_t z = 0; z < cells; z++)
+			{
+				for (size_t x = 0; x < cells; x++)
+				{
+					const float x_0 = static_cast<float>(x) * 0.5f;
+					const float z_0 = static_cast<float>(z) * 0.5f;
+					const auto top_left     = glm::vec3(x_0,        field.get_sample(x,     z),     z_0);
+					const auto top_right    = glm::vec3(x_0 + 0.5f, field.get_sample(x + 1, z),     z_0);
+					const auto bottom_left  = glm::vec3(x_0,        field.get_sample(x,     z + 1), z_0 + 0.5f);
+					const auto bottom_right = glm::vec3(x_0 + 0.5f, field.get_sample(x + 1, z + 1), z_0 + 0.5f);
+					triangles.emplace_back(top_left, bottom_left, top_right);
+					triangles.emplace_back(top_right, bottom_left, bottom_right);
+				}
+			}
+
+			std::uniform_real_distribution<float> position_distribution(-4.f, 20.f);
+			std::uniform_real_distribution<float> direction_distribution(-1.f, 1.f);
+			bool hits_match = true;
+			size_t hit_count = 0;
+			for (size_t i = 0; i < 500; i++)
+			{
+				const auto start     = glm::vec3(position_distribution(generator), 4.f, position_distribution(generator));
+				const auto direction = glm::normalize(glm::vec3(direction_distribution(generator), -std::abs(direction_distribution(generator)) - 0.1f, direction_distribution(generator)));
+				const auto ray       = Geometry::Ray(start, direction);
+
+				std::optional<float> expected;
+				for (const auto& triangle : triangles)
+				{
+					float length_along_ray = 0.f;
+					if (Geometry::get_intersection(ray, triangle, &length_along_ray) && (!expected || length_along_ray < *expected))
+						expected = length_along_ray;
+				}
+
+				const auto hit = field.get_intersection(ray);
+				if (hit.has_value() != expected.has_value() || (hit && std::abs(hit->distance_along_ray - *expected) > 0.0001f))
+					hits_match = false;
+				if (hit)
+					hit_count++;
+			}
+			CHECK_TRUE(hit_count > 0, "Rays hit the surface");
+			CHECK_TRUE(hits_match, "DDA matches brute force");
+			CHECK_TRUE(!field.get_intersection(Geometry::Ray(glm::vec3(1.f, 4.f, 1.f), glm::vec3(0.f, -1.f, 0.f)), 1.f).has_value(), "Beyond max distance");
+		}
+		{SCOPE_SECTION("Contact");
+			const auto flat = Geometry::Heightfield(4, 4, 1.f, std::vector<float>(25, 1.f));
+			auto AABB_contact = flat.get_contact(Geometry::AABB(glm::vec3(1.f, 0.75f, 1.f), glm::vec3(2.f, 1.75f, 2.f)));
+			CHECK_TRUE(AABB_contact.has_value(), "AABB penetrating");
+			CHECK_EQUAL_FLOAT(AABB_contact->penetration_depth, 0.25f, "AABB depth", 0.0001f);
+			CHECK_EQUAL_FLOAT(AABB_contact->normal.y, 1.f, "AABB normal", 0.0001f);
+			CHECK_TRUE(!flat.get_contact(Geometry::AABB(glm::vec3(1.f, 1.25f, 1.f), glm::vec3(2.f, 2.25f, 2.f))).has_value(), "AABB above");
+
+			auto sphere_contact = flat.get_contact(Geometry::Sphere(glm::vec3(2.f, 1.5f, 2.f), 1.f));
+			CHECK_TRUE(sphere_contact.has_value(), "Sphere penetrating");
+			CHECK_EQUAL_FLOAT(sphere_contact->penetration_depth, 0.5f, "Sphere depth", 0.0001f);
+			CHECK_EQUAL_FLOAT(sphere_contact->normal.y, 1.f, "Sphere normal", 0.0001f);
+			sphere_contact = flat.get_contact(Geometry::Sphere(glm::vec3(2.f, 0.5f, 2.f), 1.f));
+			CHECK_EQUAL_FLOAT(sphere_contact->penetration_depth, 1.5f, "Sphere center below surface", 0.0001f);
+			CHECK_TRUE(!flat.get_contact(Geometry::Sphere(glm::vec3(2.f, 2.5f, 2.f), 1.f)).has_value(), "Sphere above");
+		}
+		{SCOPE_SECTION("Chunks");
+			// 38x22 cells split into 16 cell chunks leaves 6 cell chunks on the far edges, which can only drop to LOD 1.
+			const size_t cells_x = 38;
+			const size_t cells_z = 22;
+			std::vector<float> chunk_heights((cells_x + 1) * (cells_z + 1));
+			for (auto& height : chunk_heights)
+				height = height_distribution(generator);
+			const auto chunk_field = Geometry::Heightfield(cells_x, cells_z, 0.5f, std::move(chunk_heights));
+			auto chunks = Geometry::HeightfieldChunks(chunk_field, 16);
+			CHECK_EQUAL(chunks.chunks_x(), 3, "Chunks along X");
+			CHECK_EQUAL(chunks.chunks_z(), 2, "Chunks along Z");
+			CHECK_EQUAL(chunks.chunks()[2].max_lod, 1, "Remainder chunk max LOD");
+
+			chunks.update(glm::vec3(0.f, 0.f, 0.f), 1.f);
+			CHECK_EQUAL(chunks.chunks()[0].lod, 0, "Nearest chunk full detail");
+			CHECK_TRUE(chunks.chunks()[4].lod > 0, "Far chunk reduced detail");
+
+			size_t full_detail_vertex_count = 0;
+			for (const auto& chunk : chunks.chunks())
+				full_detail_vertex_count += (chunk.cells_x + 1) * (chunk.cells_z + 1);
+
+			std::uniform_real_distribution<float> view_distribution(-5.f, 25.f);
+			bool neighbours_within_one = true;
+			bool wound_upward          = true;
+			bool area_covered          = true;
+			bool crack_free            = true;
+			bool fewer_vertices        = true;
+			for (size_t view = 0; view < 20; view++)
+			{
+				chunks.update(glm::vec3(view_distribution(generator), 1.f, view_distribution(generator)), 1.f);
+
+				// Every edge inside the terrain must be shared by exactly two triangles, a crack or T-junction on a seam leaves edges used once.
+				std::map<std::pair<size_t, size_t>, size_t> edge_counts; // Keyed by the sample indices of the edge ends.
+				size_t vertex_count = 0;
+				for (size_t chunk_z = 0; chunk_z < chunks.chunks_z(); chunk_z++)
+				{
+					for (size_t chunk_x = 0; chunk_x < chunks.chunks_x(); chunk_x++)
+					{
+						const auto& chunk = chunks.chunks()[chunk_z * chunks.chunks_x() + chunk_x];
+						if (chunk_x + 1 < chunks.chunks_x() && std::abs(int(chunk.lod) - int(chunks.chunks()[chunk_z * chunks.chunks_x() + chunk_x + 1].lod)) > 1)
+							neighbours_within_one = false;
+						if (chunk_z + 1 < chunks.chunks_z() && std::abs(int(chunk.lod) - int(chunks.chunks()[(chunk_z + 1) * chunks.chunks_x() + chunk_x].lod)) > 1)
+							neighbours_within_one = false;
+
+						auto sample = [&](unsigned int p_index)
+						{
+							const size_t x = chunk.first_x + (p_index % chunk.vertices_x()) * chunk.step();
+							const size_t z = chunk.first_z + (p_index / chunk.vertices_x()) * chunk.step();
+							return std::make_pair(x, z);
+						};
+						auto position = [&](std::pair<size_t, size_t> p_sample) { return glm::vec3(float(p_sample.first) * 0.5f, chunk_field.get_sample(p_sample.first, p_sample.second), float(p_sample.second) * 0.5f); };
+
+						const auto indices = chunks.get_indices(chunk);
+						float area = 0.f;
+						for (size_t i = 0; i + 2 < indices.size(); i += 3)
+						{
+							const std::array<std::pair<size_t, size_t>, 3> samples = {sample(indices[i]), sample(indices[i + 1]), sample(indices[i + 2])};
+							const auto normal = glm::cross(position(samples[1]) - position(samples[0]), position(samples[2]) - position(samples[0]));
+							if (normal.y < 0.f) // Corners stitched on both sides leave one vertical triangle closing the seam.
+								wound_upward = false;
+							area += normal.y / 2.f; // The Y of the cross product depends only on X and Z, twice the area projected onto the XZ plane.
+
+							for (size_t edge = 0; edge < 3; edge++)
+							{
+								const size_t start = samples[edge].second * (cells_x + 1) + samples[edge].first;
+								const size_t end   = samples[(edge + 1) % 3].second * (cells_x + 1) + samples[(edge + 1) % 3].first;
+								edge_counts[std::minmax(start, end)]++;
+							}
+						}
+						if (std::abs(area - float(chunk.cells_x * chunk.cells_z) * 0.25f) > 0.001f)
+							area_covered = false;
+						vertex_count += chunk.vertices_x() * chunk.vertices_z();
+					}
+				}
+				for (const auto& [edge, count] : edge_counts)
+				{
+					const size_t start_x = edge.first % (cells_x + 1), start_z = edge.first / (cells_x + 1);
+					const size_t end_x   = edge.second % (cells_x + 1), end_z  = edge.second / (cells_x + 1);
+					const bool outer = (start_x == end_x && (start_x == 0 || start_x == cells_x)) || (start_z == end_z && (start_z == 0 || start_z == cells_z));
+					if (count != (outer ? 1 : 2))
+						crack_free = false;
+				}
+				if (vertex_count >= full_detail_vertex_count)
+					fewer_vertices = false;
+			}
+			CHECK_TRUE(neighbours_within_one, "Neighbour LODs within one");
+			CHECK_TRUE(wound_upward, "Triangles wound upward");
+			CHECK_TRUE(area_covered, "Triangles cover the chunk");
+			CHECK_TRUE(crack_free, "Seams crack free");
+			CHECK_TRUE(fewer_vertices, "Fewer vertices than full detail");
+		}
+	}
+	void GeometryTester::run_octree_tests()
+	{SCOPE_SECTION("Loose octree");
+		// Boxes scattered slightly beyond the octree bounds so some are kept outside the root cell.
+		auto [boxes, rays] = make_boxes_and_rays(500, 22.f);
+		auto octree = Geometry::LooseOctree(Geometry::AABB(glm::vec3(-20.f), glm::vec3(20.f)), 6);
+		std::vector<Geometry::LooseOctree::ItemID> IDs;
+		for (const auto& box : boxes)
+			IDs.push_back(octree.insert(box));
+
+		auto projection = glm::perspective(glm::radians(60.f), 1.5f, 0.1f, 30.f);
+		auto view       = glm::lookAt(glm::vec3(-10.f, 5.f, 10.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+		const auto frustrum = Geometry::Frustrum(projection * view);
+
+		// Compare every query against testing every box in boxes, where removed boxes are marked by an invalid ID.
+		auto queries_match = [&]()
+		{
+			bool match = true;
+			auto check = [&](auto p_query, auto p_expected)
+			{
+				std::vector<Geometry::LooseOctree::ItemID> found;
+				p_query([&](Geometry::LooseOctree::ItemID p_item) { found.push_back(p_item); });
+				std::vector<Geometry::LooseOctree::ItemID> expected;
+				for (size_t i = 0; i < boxes.size(); i++)
+				{
+					if (IDs[i] != Geometry::LooseOctree::Invalid_item && p_expected(boxes[i]))
+						expected.push_back(IDs[i]);
+				}
+				std::sort(found.begin(), found.end());
+				std::sort(expected.begin(), expected.end());
+				match &= found == expected;
+			};
+
+			for (size_t r = 0; r < 20; r++)
+			{
+				const auto range  = Geometry::AABB(rays[r].m_start, rays[r].m_start + glm::vec3(8.f));
+				const auto sphere = Geometry::Sphere(rays[r].m_start, 6.f);
+				check([&](auto p_visitor) { octree.query(range, p_visitor); },  [&](const Geometry::AABB& p_box) { return Geometry::intersecting(p_box, range); });
+				check([&](auto p_visitor) { octree.query(sphere, p_visitor); }, [&](const Geometry::AABB& p_box) { return Geometry::intersecting(p_box, sphere); });
+				check([&](auto p_visitor) { octree.traverse(rays[r], [&](Geometry::LooseOctree::ItemID p_item, float) { p_visitor(p_item); return Geometry::LooseOctree::Max_distance; }); },
+				      [&](const Geometry::AABB& p_box) { return Geometry::get_intersection(p_box, rays[r]).has_value(); });
+
+				float expected_closest = Geometry::LooseOctree::Max_distance;
+				for (size_t i = 0; i < boxes.size(); i++)
+				{
+					float length_along_ray = 0.f;
+					if (IDs[i] != Geometry::LooseOctree::Invalid_item && Geometry::get_intersection(boxes[i], rays[r], &length_along_ray))
+						expected_closest = std::min(expected_closest, length_along_ray);
+				}
+				float closest = Geometry::LooseOctree::Max_distance;
+				octree.traverse(rays[r], [&](Geometry::LooseOctree::ItemID, float p_length_along_ray) { closest = std::min(closest, p_length_along_ray); return closest; });
+				match &= closest == expected_closest;
+			}
+			check([&](auto p_visitor) { octree.query(frustrum, p_visitor); }, [&](const Geometry::AABB& p_box) { return Geometry::intersecting(frustrum, p_box); });
+			return match;
+		};
+
+		{SCOPE_SECTION("Insert");
+			CHECK_EQUAL(octree.size(), boxes.size(), "Size");
+			CHECK_TRUE(queries_match(), "Queries match brute force");
+		}
+		{SCOPE_SECTION("Move and remove");
+			std::mt19937 gen(5);
+			std::uniform_real_distribution<float> offset_dis(-5.f, 5.f);
+			for (size_t i = 0; i < boxes.size(); i += 2)
+			{
+				const auto offset = glm::vec3(offset_dis(gen), offset_dis(gen), offset_dis(gen));
+				boxes[i] = Geometry::AABB(boxes[i].m_min + offset, boxes[i].m_max + offset * (i % 4 == 0 ? 2.f : 1.f));
+				octree.move(IDs[i], boxes[i]);
+			}
+			std::vector<Geometry::LooseOctree::ItemID> removed_IDs;
+			for (size_t i = 1; i < boxes.size(); i += 4)
+			{
+				octree.remove(IDs[i]);
+				removed_IDs.push_back(IDs[i]);
+				IDs[i] = Geometry::LooseOctree::Invalid_item;
+			}
+			CHECK_EQUAL(octree.size(), boxes.size() - boxes.size() / 4, "Size");
+			CHECK_TRUE(queries_match(), "Queries match brute force");
+
+			// Removed IDs are reused.
+			const auto reused_ID = octree.insert(boxes[1]);
+			CHECK_TRUE(std::find(removed_IDs.begin(), removed_IDs.end(), reused_ID) != removed_IDs.end(), "ID is reused");
+			CHECK_TRUE(std::find(IDs.begin(), IDs.end(), reused_ID) == IDs.end(), "ID is not in use");
+			octree.remove(reused_ID);
+		}
+		{SCOPE_SECTION("Statistics");
+			const auto statistics = octree.get_statistics();
+			size_t node_count = 0;
+			size_t item_count = 0;
+			octree.for_each_node([&](const Geometry::LooseOctree::NodeStatistics& p_node)
+			{
+				node_count++;
+				item_count += p_node.item_count;
+			});
+			CHECK_EQUAL(statistics.node_count, node_count, "Node count");
+			CHECK_EQUAL(statistics.item_count, octree.size(), "Item count");
+			CHECK_EQUAL(item_count, octree.size(), "Node item counts");
+			CHECK_TRUE(statistics.max_depth <= 6, "Max depth");
+
+			octree.clear();
+			CHECK_TRUE(octree.empty(), "Empty after clear");
+			CHECK_EQUAL(octree.get_statistics().node_count, 1, "Root remains after clear");
+		}
+	}
 } // namespace Test
 DISABLE_WARNING_POP
\ No newline at end of file
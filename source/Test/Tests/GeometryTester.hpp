@@ -19,5 +19,11 @@ namespace Test
 		void run_frustrum_tests();
 		void run_sphere_tests();
 		void run_point_tests();
+		void run_distance_tests();
+		void run_convex_hull_tests();
+		void run_GJK_batch_tests();
+		void run_BVH_tests();
+		void run_heightfield_tests();
+		void run_octree_tests();
 	};
 } // namespace Test
\ No newline at end of file
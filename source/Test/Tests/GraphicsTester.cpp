@@ -1,5 +1,6 @@
 #include "GraphicsTester.hpp"
 
+#include "Data/Vertex.hpp"
 #include "OpenGL/Types.hpp"
 #include "OpenGL/Shader.hpp"
 #include "OpenGL/GLState.hpp"
@@ -51,6 +52,28 @@ namespace Test
 		}
 
 
+		{SCOPE_SECTION("Terrain vertex")
+			{SCOPE_SECTION("Height")
+				const auto lowest  = Data::TerrainVertex(-20.f, -20.f, 40.f, glm::vec3(0.f, 1.f, 0.f));
+				const auto highest = Data::TerrainVertex(20.f, -20.f, 40.f, glm::vec3(0.f, 1.f, 0.f));
+				const auto middle  = Data::TerrainVertex(3.7f, -20.f, 40.f, glm::vec3(0.f, 1.f, 0.f));
+				CHECK_EQUAL(lowest.height, 0, "Lowest height");
+				CHECK_EQUAL(highest.height, 65535, "Highest height");
+				CHECK_EQUAL_FLOAT(middle.get_height(-20.f, 40.f), 3.7f, "Quantised height", 40.f / 65535.f);
+				CHECK_EQUAL(Data::TerrainVertex(30.f, -20.f, 40.f, glm::vec3(0.f, 1.f, 0.f)).height, 65535, "Height above range clamped");
+			}
+			{SCOPE_SECTION("Octahedral normal")
+				const std::array<glm::vec3, 8> normals = {
+					glm::vec3(0.f, 1.f, 0.f), glm::vec3(0.f, -1.f, 0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 0.f, -1.f),
+					glm::normalize(glm::vec3(1.f, 2.f, 3.f)), glm::normalize(glm::vec3(-0.3f, 0.9f, 0.1f)),
+					glm::normalize(glm::vec3(-2.f, -1.f, 0.5f)), glm::normalize(glm::vec3(0.7f, -0.2f, -0.6f))};
+
+				// 8 bits per component keep the decoded normal within a degree of the original.
+				for (const auto& normal : normals)
+					CHECK_TRUE(glm::dot(Data::TerrainVertex(0.f, 0.f, 1.f, normal).get_normal(), normal) > std::cos(glm::radians(1.f)), "Decoded normal");
+			}
+		}
+
 		{SCOPE_SECTION("Compute")
 			{SCOPE_SECTION("Increment")
 				std::array<unsigned int, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
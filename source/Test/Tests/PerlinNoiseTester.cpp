@@ -0,0 +1,108 @@
+#include "PerlinNoiseTester.hpp"
+
+#include "Utility/PerlinNoise.hpp"
+#include "Utility/Stopwatch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Test
+{
+	void PerlinNoiseTester::run_unit_tests()
+	{
+		SCOPE_SECTION("PerlinNoise")
+		{
+			// Tolerance documented on siv::BasicPerlinNoise batched noise.
+			constexpr double tolerance = 1e-5;
+			// An odd count so the samples left over from the batches of four are covered too.
+			constexpr size_t count = 1003;
+			const siv::PerlinNoise perlin{1234u};
+
+			std::mt19937 generator(5);
+			std::vector<double> x(count);
+			std::vector<double> y(count);
+			std::vector<double> batch(count);
+
+			for (double range : {1.0, 100.0, 100000.0})
+			{
+				std::uniform_real_distribution<double> coordinate_distribution(-range, range);
+				for (size_t i = 0; i < count; i++)
+				{
+					x[i] = coordinate_distribution(generator);
+					y[i] = coordinate_distribution(generator);
+				}
+				x[0] = 0.0; // Lattice points.
+				y[0] = 0.0;
+				x[1] = -3.0;
+				y[1] = 7.0;
+
+				double noise_error = 0.0;
+				perlin.noise2DBatch(x.data(), y.data(), batch.data(), count);
+				for (size_t i = 0; i < count; i++)
+					noise_error = std::max(noise_error, std::abs(batch[i] - perlin.noise2D(x[i], y[i])));
+
+				constexpr std::int32_t octaves = 6;
+				double octave_error = 0.0;
+				perlin.octave2DBatch(x.data(), y.data(), batch.data(), count, octaves, 0.5);
+				for (size_t i = 0; i < count; i++)
+					octave_error = std::max(octave_error, std::abs(batch[i] - perlin.octave2D(x[i], y[i], octaves, 0.5)));
+
+				CHECK_TRUE(noise_error <= tolerance, "noise2DBatch matches noise2D");
+				CHECK_TRUE(octave_error <= tolerance * siv::perlin_detail::MaxAmplitude(octaves, 0.5), "octave2DBatch matches octave2D");
+			}
+			{SCOPE_SECTION("Float");
+				const siv::BasicPerlinNoise<float> perlin_float{1234u};
+				std::vector<float> x_float(x.begin(), x.begin() + 7);
+				std::vector<float> y_float(y.begin(), y.begin() + 7);
+				std::vector<float> batch_float(7);
+				perlin_float.noise2DBatch(x_float.data(), y_float.data(), batch_float.data(), batch_float.size());
+
+				float noise_error = 0.f;
+				for (size_t i = 0; i < batch_float.size(); i++)
+					noise_error = std::max(noise_error, std::abs(batch_float[i] - perlin_float.noise2D(x_float[i], y_float[i])));
+				CHECK_TRUE(noise_error <= static_cast<float>(tolerance), "noise2DBatch matches noise2D");
+			}
+		}
+	}
+	void PerlinNoiseTester::run_performance_tests()
+	{
+		// Grids across the range of the terrain size sliders, sampled as Component::Terrain does with its default scale factor and octaves.
+		const siv::PerlinNoise perlin{1234u};
+		constexpr std::int32_t octaves = 4;
+		constexpr double scale_factor  = 0.03;
+
+		for (size_t size : {64, 256, 1000})
+		{
+			const size_t samples = (size + 1) * (size + 1);
+			std::vector<double> x(samples);
+			std::vector<double> y(samples);
+			for (size_t z = 0; z <= size; z++)
+			{
+				for (size_t i = 0; i <= size; i++)
+				{
+					x[z * (size + 1) + i] = static_cast<double>(i) * scale_factor;
+					y[z * (size + 1) + i] = static_cast<double>(z) * scale_factor;
+				}
+			}
+			std::vector<double> scalar(samples);
+			std::vector<double> batch(samples);
+
+			Utility::Stopwatch scalar_stopwatch;
+			for (size_t i = 0; i < samples; i++)
+				scalar[i] = perlin.octave2D(x[i], y[i], octaves);
+			const auto scalar_time = scalar_stopwatch.duration_since_start<float, std::milli>().count();
+
+			Utility::Stopwatch batch_stopwatch;
+			perlin.octave2DBatch(x.data(), y.data(), batch.data(), samples, octaves);
+			const auto batch_time = batch_stopwatch.duration_since_start<float, std::milli>().count();
+
+			double max_error = 0.0;
+			for (size_t i = 0; i < samples; i++)
+				max_error = std::max(max_error, std::abs(batch[i] - scalar[i]));
+
+			printf("Perlin octave2D %zux%zu grid %d octaves: scalar %fms, batch %fms (max difference %g)\n", size, size, octaves, scalar_time, batch_time, max_error);
+		}
+	}
+} // namespace Test
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "TestManager.hpp"
+
+namespace Test
+{
+	class PerlinNoiseTester : public TestManager
+	{
+	public:
+		PerlinNoiseTester() : TestManager(std::string("PERLIN NOISE TEST")) {}
+
+		void run_unit_tests()        override;
+		void run_performance_tests() override;
+	};
+} // namespace Test
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "PhysicsTester.hpp"
+
+#include "Component/Collider.hpp"
+#include "Component/FirstPersonCamera.hpp"
+#include "Component/Input.hpp"
+#include "Component/Label.hpp"
+#include "Component/Lights.hpp"
+#include "Component/Mesh.hpp"
+#include "Component/ParticleEmitter.hpp"
+#include "Component/RigidBody.hpp"
+#include "Component/Terrain.hpp"
+#include "Component/TerrainStream.hpp"
+#include "Component/Texture.hpp"
+#include "Component/Transform.hpp"
+#include "ECS/Component.hpp"
+#include "System/AssetManager.hpp"
+#include "System/CollisionSystem.hpp"
+#include "System/PhysicsSystem.hpp"
+#include "System/SceneSystem.hpp"
+
+#include "Platform/Core.hpp"
+#include "Platform/Input.hpp"
+#include "Platform/Window.hpp"
+
+#include "Utility/Config.hpp"
+
+DISABLE_WARNING_PUSH
+DISABLE_WARNING_HIDES_PREVIOUS_DECLERATION // Required to allow shadowing for the SCOPE_SECTION macro
+
+namespace Test
+{
+	void PhysicsTester::run_unit_tests()
+	{
+		// Meshes create GL buffers so the physics scenes need a context.
+		Platform::Core::initialise_directories();
+		Platform::Core::initialise_GLFW();
+		Platform::Input input   = Platform::Input();
+		Platform::Window window = Platform::Window({0.5, 0.5}, input);
+		Platform::Core::initialise_OpenGL();
+
+		// Other testers register their own ComponentTypes in place of the engine's, register the engine's as Application does.
+		ECS::Component::clear_info();
+		ECS::Component::set_info<Component::Collider>();
+		ECS::Component::set_info<Component::FirstPersonCamera>();
+		ECS::Component::set_info<Component::Input>();
+		ECS::Component::set_info<Component::Label>();
+		ECS::Component::set_info<Component::PointLight>();
+		ECS::Component::set_info<Component::DirectionalLight>();
+		ECS::Component::set_info<Component::SpotLight>();
+		ECS::Component::set_info<Component::Mesh>();
+		ECS::Component::set_info<Component::ParticleEmitter>();
+		ECS::Component::set_info<Component::RigidBody>();
+		ECS::Component::set_info<Component::Terrain>();
+		ECS::Component::set_info<Component::TerrainStream>();
+		ECS::Component::set_info<Component::Texture>();
+		ECS::Component::set_info<Component::Transform>();
+
+		{// Destroyed before the context is.
+			System::AssetManager asset_manager;
+			System::SceneSystem scene_system(asset_manager);
+			System::CollisionSystem collision_system(scene_system);
+			System::PhysicsSystem physics_system(scene_system, collision_system);
+			const auto delta_time = DeltaTime(1.f / 60.f);
+
+			// Step the simulation as Application does until p_rigid_body falls asleep or p_seconds pass.
+			auto simulate_until_asleep = [&](const Component::RigidBody& p_rigid_body, float p_seconds)
+			{
+				for (float time = 0.f; time < p_seconds && !p_rigid_body.m_asleep; time += delta_time.count())
+				{
+					physics_system.integrate(delta_time);
+					collision_system.update();
+				}
+			};
+
+			{SCOPE_SECTION("Body dropped on terrain falls asleep")
+				auto& scene = scene_system.add_scene();
+				scene_system.set_current_scene(scene);
+				scene.m_entities.add_entity(Component::Terrain({-10.f, 0.f, -10.f}, 20, 20, 0.f));
+				auto body = scene.m_entities.add_entity(Component::RigidBody{}, Component::Transform{glm::vec3(0.f, 5.f, 0.f)}, Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				collision_system.update();
+
+				auto& rigid_body = scene.m_entities.get_component<Component::RigidBody>(body);
+				auto& transform  = scene.m_entities.get_component<Component::Transform>(body);
+				auto& collider   = scene.m_entities.get_component<Component::Collider>(body);
+				simulate_until_asleep(rigid_body, 10.f);
+				CHECK_TRUE(rigid_body.m_asleep, "Asleep");
+				CHECK_EQUAL(physics_system.m_sleeping_body_count, 1, "Sleeping body count");
+				CHECK_EQUAL_FLOAT(collider.m_world_AABB.m_min.y, 0.f, "Resting on the terrain", 0.01f);
+
+				{SCOPE_SECTION("Moved body wakes")
+					transform.m_position.y += 3.f;
+					physics_system.integrate(delta_time);
+					CHECK_TRUE(!rigid_body.m_asleep, "Awake");
+					CHECK_TRUE(collider.m_world_AABB.m_min.y > 2.f, "AABB follows the transform");
+
+					simulate_until_asleep(rigid_body, 10.f);
+					CHECK_TRUE(rigid_body.m_asleep, "Asleep again");
+				}
+			}
+			{SCOPE_SECTION("Continuous collision body dropped on a collider falls asleep")
+				auto& scene = scene_system.add_scene();
+				scene_system.set_current_scene(scene);
+				// A static floor, without a RigidBody only continuous collision stops bodies falling through it.
+				auto floor_transform    = Component::Transform{glm::vec3(0.f, -1.f, 0.f)};
+				floor_transform.m_scale = glm::vec3(10.f, 1.f, 10.f);
+				scene.m_entities.add_entity(std::move(floor_transform), Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+
+				auto continuous_body = Component::RigidBody{};
+				continuous_body.m_continuous_collision = true;
+				auto body = scene.m_entities.add_entity(std::move(continuous_body), Component::Transform{glm::vec3(0.f, 5.f, 0.f)}, Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				collision_system.update();
+
+				auto& rigid_body = scene.m_entities.get_component<Component::RigidBody>(body);
+				auto& collider   = scene.m_entities.get_component<Component::Collider>(body);
+				simulate_until_asleep(rigid_body, 10.f);
+				CHECK_TRUE(rigid_body.m_asleep, "Asleep");
+				CHECK_EQUAL_FLOAT(collider.m_world_AABB.m_min.y, 0.f, "Resting on the collider", 0.01f);
+			}
+			{SCOPE_SECTION("Overlapping Colliders contact")
+				auto& scene = scene_system.add_scene();
+				scene_system.set_current_scene(scene);
+				auto lower = scene.m_entities.add_entity(Component::Transform{glm::vec3(0.f)}, Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				auto upper = scene.m_entities.add_entity(Component::Transform{glm::vec3(0.f, 1.5f, 0.f)}, Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				auto apart = scene.m_entities.add_entity(Component::Transform{glm::vec3(5.f, 0.f, 0.f)}, Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				collision_system.update();
+
+				auto collided_entity = ECS::Entity(0);
+				const auto contact   = collision_system.get_collision(upper, &collided_entity);
+				CHECK_TRUE(contact.has_value(), "Contact found");
+				if (contact)
+				{
+					CHECK_EQUAL(collided_entity.ID, lower.ID, "Collided entity");
+					CHECK_EQUAL_FLOAT(contact->normal.y, 1.f, "Normal points out of the other Collider", 0.01f);
+					CHECK_EQUAL_FLOAT(contact->penetration_depth, 0.5f, "Penetration depth", 0.01f);
+				}
+				CHECK_TRUE(!collision_system.get_collision(apart).has_value(), "No contact when apart");
+
+				{SCOPE_SECTION("Queried from the other Collider")
+					const auto lower_contact = collision_system.get_collision(lower, &collided_entity);
+					CHECK_TRUE(lower_contact.has_value(), "Contact found");
+					if (lower_contact)
+					{
+						CHECK_EQUAL(collided_entity.ID, upper.ID, "Collided entity");
+						CHECK_EQUAL_FLOAT(lower_contact->normal.y, -1.f, "Normal points out of the other Collider", 0.01f);
+						CHECK_EQUAL_FLOAT(lower_contact->penetration_depth, 0.5f, "Penetration depth", 0.01f);
+					}
+				}
+				{SCOPE_SECTION("Pair caches")
+					CHECK_EQUAL(collision_system.m_pair_caches.size(), 1, "Both queries of a pair share one cache");
+					collision_system.update();
+					CHECK_EQUAL(collision_system.m_pair_caches.size(), 1, "Kept while the pair overlaps");
+
+					scene.m_entities.get_component<Component::Transform>(upper).m_position.y = 5.f;
+					collision_system.update();
+					CHECK_EQUAL(collision_system.m_pair_caches.size(), 0, "Dropped once the pair stops overlapping");
+				}
+			}
+			{SCOPE_SECTION("Colliding bodies bounce apart")
+				auto& scene = scene_system.add_scene();
+				scene_system.set_current_scene(scene);
+				// Two cubes overlapping along X, each moving into the other.
+				auto make_body = [](const glm::vec3& p_velocity)
+				{
+					auto rigid_body = Component::RigidBody{};
+					rigid_body.m_apply_gravity = false;
+					rigid_body.m_momentum      = p_velocity * rigid_body.m_mass;
+					return rigid_body;
+				};
+				auto left  = scene.m_entities.add_entity(make_body(glm::vec3(1.f, 0.f, 0.f)),  Component::Transform{glm::vec3(-0.95f, 0.f, 0.f)}, Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				auto right = scene.m_entities.add_entity(make_body(glm::vec3(-1.f, 0.f, 0.f)), Component::Transform{glm::vec3(0.95f, 0.f, 0.f)},  Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				collision_system.update();
+				physics_system.integrate(delta_time);
+
+				const auto& left_body  = scene.m_entities.get_component<Component::RigidBody>(left);
+				const auto& right_body = scene.m_entities.get_component<Component::RigidBody>(right);
+				CHECK_TRUE(left_body.m_velocity.x < 0.f, "Left body bounces back");
+				CHECK_TRUE(right_body.m_velocity.x > 0.f, "Right body bounces back");
+				CHECK_EQUAL_FLOAT(left_body.m_velocity.x, -physics_system.m_restitution, "Left speed after restitution", 0.01f);
+				CHECK_EQUAL_FLOAT(right_body.m_velocity.x, physics_system.m_restitution, "Right speed after restitution", 0.01f);
+
+				physics_system.integrate(delta_time);
+				CHECK_TRUE(left_body.m_velocity.x < 0.f && right_body.m_velocity.x > 0.f, "Impulse kept the next tick");
+			}
+			{SCOPE_SECTION("Ray queries follow moved and added Colliders")
+				auto& scene = scene_system.add_scene();
+				scene_system.set_current_scene(scene);
+				auto cube = scene.m_entities.add_entity(Component::Transform{glm::vec3(0.f)}, Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				collision_system.update();
+
+				// Rays down onto the cube at the origin and onto where it is moved to.
+				const auto ray_at_origin = Geometry::Ray(glm::vec3(0.f, 10.f, 0.f), glm::vec3(0.f, -1.f, 0.f));
+				const auto ray_at_moved  = Geometry::Ray(glm::vec3(10.f, 10.f, 0.f), glm::vec3(0.f, -1.f, 0.f));
+				auto intersection = glm::vec3(0.f);
+				CHECK_TRUE(collision_system.castRay(ray_at_origin, intersection), "Hit before moving");
+
+				scene.m_entities.get_component<Component::Transform>(cube).m_position = glm::vec3(10.f, 0.f, 0.f);
+				collision_system.update();
+				CHECK_TRUE(!collision_system.castRay(ray_at_origin, intersection), "Miss where the moved cube was");
+				CHECK_TRUE(collision_system.castRay(ray_at_moved, intersection), "Hit where the cube moved to");
+				CHECK_EQUAL_FLOAT(intersection.y, 1.f, "Hit the top of the moved cube", 0.001f);
+
+				scene.m_entities.add_entity(Component::Transform{glm::vec3(0.f)}, Component::Mesh{asset_manager.m_cube}, Component::Collider{});
+				collision_system.update();
+				CHECK_TRUE(collision_system.castRay(ray_at_origin, intersection), "Hit an added cube");
+				CHECK_TRUE(collision_system.castRay(ray_at_moved, intersection), "Hit the moved cube after adding another");
+
+				{SCOPE_SECTION("Before the first update of a new scene")
+					auto& other_scene = scene_system.add_scene();
+					scene_system.set_current_scene(other_scene);
+					auto other_cube = Component::Collider{};
+					other_cube.m_world_AABB = Geometry::AABB(glm::vec3(-1.f), glm::vec3(1.f));
+					other_scene.m_entities.add_entity(Component::Transform{glm::vec3(0.f)}, Component::Mesh{asset_manager.m_cube}, std::move(other_cube));
+					CHECK_TRUE(collision_system.castRay(ray_at_origin, intersection), "Hit without an update");
+					CHECK_TRUE(!collision_system.castRay(ray_at_moved, intersection), "Miss the previous scene's cube");
+					CHECK_EQUAL(collision_system.get_entities_along_ray(ray_at_origin).size(), 1, "Entities along ray found without an update");
+				}
+			}
+		}
+		ECS::Component::clear_info();
+
+		Platform::Core::deinitialise_GLFW();
+	}
+
+	void PhysicsTester::run_performance_tests()
+	{
+	}
+} // namespace Test
+DISABLE_WARNING_POP
\ No newline at end of file
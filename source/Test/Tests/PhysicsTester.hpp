@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Test/TestManager.hpp"
+
+namespace Test
+{
+	class PhysicsTester : public TestManager
+	{
+	public:
+		PhysicsTester() : TestManager(std::string("PHYSICS")) {}
+
+		void run_unit_tests()        override;
+		void run_performance_tests() override;
+	};
+} // namespace Test
\ No newline at end of file
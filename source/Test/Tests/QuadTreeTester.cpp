@@ -3,7 +3,12 @@
 
 #include "Test/MemoryCorrectnessItem.hpp"
 
+#include "Utility/Stopwatch.hpp"
+
+#include <algorithm>
 #include <array>
+#include <random>
+#include <vector>
 
 namespace Test
 {
@@ -117,6 +122,107 @@ namespace Test
 					}
 				}
 			}
+			{SCOPE_SECTION("Free node reuse")
+				QuadTree quad_tree;
+				size_t A = quad_tree.add_root_node(Geometry::AABB2D{glm::vec2{min}, glm::vec2{max}}, 'A');
+				size_t B = quad_tree.subdivide(quad_tree[A], 'B', 'C', 'D', 'E');
+				quad_tree.subdivide(quad_tree[B], 'F', 'G', 'H', 'I');
+
+				quad_tree.merge(quad_tree[A]);
+				CHECK_EQUAL(quad_tree.size(), 1, "Merge deletes grandchildren");
+
+				// The freed slots are reused, parent indices and node_index must follow the new nodes.
+				B = quad_tree.subdivide(quad_tree[A], 'J', 'K', 'L', 'M');
+				size_t F = quad_tree.subdivide(quad_tree[B + 1], 'N', 'O', 'P', 'Q');
+				CHECK_EQUAL(quad_tree.size(), 9, "Size after reuse");
+				CHECK_TRUE(!quad_tree[A].parent_index.has_value(), "Root has no parent");
+				CHECK_EQUAL(*quad_tree[F].parent_index, B + 1, "Parent index");
+				CHECK_EQUAL(quad_tree.node_index(quad_tree[F]), F, "Node index");
+				CHECK_EQUAL(quad_tree.node_index(quad_tree[A]), A, "Root node index");
+
+				std::array expected_BFS_order = {'A', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q'};
+				size_t index = 0;
+				quad_tree.breadth_first_traversal([&](Node& node)
+				{
+					CHECK_EQUAL(node.data, expected_BFS_order[index], "BFS order " + std::to_string(index));
+					++index;
+				});
+			}
+			{SCOPE_SECTION("Spatial queries")
+				// Subdivide a random set of leaves to get an uneven tree.
+				QuadTree quad_tree;
+				quad_tree.add_root_node(Geometry::AABB2D{glm::vec2{min}, glm::vec2{max}}, 'A');
+				std::mt19937 gen(11);
+				for (size_t i = 0; i < 200; i++)
+				{
+					std::vector<size_t> leaves;
+					for (auto it = quad_tree.begin(); it != quad_tree.end(); ++it)
+					{
+						if (it->leaf())
+							leaves.push_back(it.index);
+					}
+					const size_t leaf = leaves[std::uniform_int_distribution<size_t>(0, leaves.size() - 1)(gen)];
+					quad_tree.subdivide(quad_tree[leaf], 'B', 'C', 'D', 'E');
+				}
+
+				std::vector<size_t> all_leaves;
+				for (auto it = quad_tree.begin(); it != quad_tree.end(); ++it)
+				{
+					if (it->leaf())
+						all_leaves.push_back(it.index);
+				}
+
+				std::uniform_real_distribution<float> position_dis(min - 10.f, max + 10.f);
+				std::uniform_real_distribution<float> size_dis(0.f, 30.f);
+				std::vector<size_t> found(all_leaves.size());
+				bool range_match  = true;
+				bool circle_match = true;
+				bool nearest_match = true;
+				for (size_t i = 0; i < 100; i++)
+				{
+					const auto point = glm::vec2(position_dis(gen), position_dis(gen));
+					const auto range = Geometry::AABB2D{point, point + glm::vec2(size_dis(gen), size_dis(gen))};
+					const float radius = size_dis(gen);
+
+					std::vector<size_t> expected_range;
+					std::vector<size_t> expected_circle;
+					std::vector<float> expected_distances;
+					for (size_t leaf : all_leaves)
+					{
+						const auto& bounds = quad_tree[leaf].bounds;
+						const auto offset  = bounds.closest_point(point) - point;
+						const float distance_squared = offset.x * offset.x + offset.y * offset.y;
+						if (bounds.intersects(range))
+							expected_range.push_back(leaf);
+						if (distance_squared <= radius * radius)
+							expected_circle.push_back(leaf);
+						expected_distances.push_back(distance_squared);
+					}
+					std::sort(expected_distances.begin(), expected_distances.end());
+
+					size_t count = quad_tree.query(range, found);
+					std::sort(found.begin(), found.begin() + count);
+					range_match &= std::vector<size_t>(found.begin(), found.begin() + count) == expected_range;
+
+					count = quad_tree.query(point, radius, found);
+					std::sort(found.begin(), found.begin() + count);
+					circle_match &= std::vector<size_t>(found.begin(), found.begin() + count) == expected_circle;
+
+					std::array<QuadTree::Neighbour, 5> nearest;
+					count = quad_tree.nearest(point, nearest);
+					nearest_match &= count == nearest.size();
+					for (size_t n = 0; n < count; n++)
+						nearest_match &= nearest[n].distance_squared == expected_distances[n];
+				}
+				CHECK_TRUE(range_match, "Range matches brute force");
+				CHECK_TRUE(circle_match, "Circle matches brute force");
+				CHECK_TRUE(nearest_match, "Nearest matches brute force");
+
+				std::array<size_t, 1> too_small;
+				CHECK_EQUAL(quad_tree.query(Geometry::AABB2D{glm::vec2{min}, glm::vec2{max}}, too_small), all_leaves.size(), "Count exceeds buffer");
+				std::array<QuadTree::Neighbour, 1> nearest;
+				CHECK_EQUAL(QuadTree().nearest(glm::vec2(0.f), nearest), 0, "Nearest in empty tree");
+			}
 			{SCOPE_SECTION("Memory correctness")
 				MemoryCorrectnessItem::reset();
 				Geometry::QuadTree<MemoryCorrectnessItem> quad_tree;
@@ -198,4 +304,53 @@ namespace Test
 			}
 		}
 	}
+	void QuadTreeTester::run_performance_tests()
+	{
+		// Subdivide every leaf down to depth 8, then merge every other depth 6 node and subdivide it again to scatter reused slots through the tree.
+		Geometry::QuadTree<char> quad_tree;
+		quad_tree.add_root_node(Geometry::AABB2D{glm::vec2{0.f}, glm::vec2{1000.f}}, 'A');
+		for (size_t depth = 0; depth < 8; depth++)
+		{
+			std::vector<size_t> leaves;
+			for (auto it = quad_tree.begin(); it != quad_tree.end(); ++it)
+			{
+				if (it->leaf())
+					leaves.push_back(it.index);
+			}
+			for (size_t leaf : leaves)
+				quad_tree.subdivide(quad_tree[leaf], 'B', 'C', 'D', 'E');
+		}
+		std::vector<size_t> depth_6;
+		for (auto it = quad_tree.begin(); it != quad_tree.end(); ++it)
+		{
+			if (it->depth == 6)
+				depth_6.push_back(it.index);
+		}
+		for (size_t i = 0; i < depth_6.size(); i += 2)
+			quad_tree.merge(quad_tree[depth_6[i]]);
+		for (size_t i = 0; i < depth_6.size(); i += 2)
+			quad_tree.subdivide(quad_tree[depth_6[i]], 'B', 'C', 'D', 'E');
+
+		size_t visit_count = 0;
+		Utility::Stopwatch iterate_stopwatch;
+		for (auto it = quad_tree.begin(); it != quad_tree.end(); ++it)
+			visit_count++;
+		const auto iterate_time = iterate_stopwatch.duration_since_start<float, std::milli>().count();
+
+		Utility::Stopwatch depth_first_stopwatch;
+		quad_tree.depth_first_traversal([&](Geometry::QuadTree<char>::Node&) { visit_count++; });
+		const auto depth_first_time = depth_first_stopwatch.duration_since_start<float, std::milli>().count();
+
+		Utility::Stopwatch breadth_first_stopwatch;
+		quad_tree.breadth_first_traversal([&](Geometry::QuadTree<char>::Node&) { visit_count++; });
+		const auto breadth_first_time = breadth_first_stopwatch.duration_since_start<float, std::milli>().count();
+
+		Utility::Stopwatch node_index_stopwatch;
+		for (auto it = quad_tree.begin(); it != quad_tree.end(); ++it)
+			visit_count += quad_tree.node_index(*it) == it.index;
+		const auto node_index_time = node_index_stopwatch.duration_since_start<float, std::milli>().count();
+
+		printf("QuadTree %zu nodes (%zu visits): iterate %fms, depth-first %fms, breadth-first %fms, node_index all %fms\n",
+			quad_tree.size(), visit_count, iterate_time, depth_first_time, breadth_first_time, node_index_time);
+	}
 } // namespace Test
\ No newline at end of file
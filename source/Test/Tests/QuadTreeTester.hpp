@@ -10,6 +10,6 @@ namespace Test
 		QuadTreeTester() : TestManager(std::string("QUAD TREE TEST")) {}
 
 		void run_unit_tests()        override;
-		void run_performance_tests() override {};
+		void run_performance_tests() override;
 	};
 } // namespace Test
\ No newline at end of file
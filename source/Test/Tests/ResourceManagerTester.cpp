@@ -2,6 +2,8 @@
 #include "MemoryCorrectnessItem.hpp"
 #include "Utility/ResourceManager.hpp"
 
+#include <algorithm>
+#include <thread>
 #include <vector>
 
 namespace Test
@@ -177,7 +179,37 @@ namespace Test
 			CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 0, "Memory leak check");
 			CHECK_EQUAL(MemoryCorrectnessItem::count_errors(), 0, "Memory Error check");
 		}
-		{// Test range-based for - these depend on the ResourceManager leaving gaps inside the buffer when erasing from non-end positions.
+		{// Check inserting into the slot of an erased resource leaves the other resources intact
+			MemoryCorrectnessItem::reset();
+			{
+				Manager manager;
+				std::vector<Ref> refs;
+				for (int i = 0; i < 3; i++)
+				{
+					refs.push_back(manager.insert(MemoryCorrectnessItem{}));
+					refs.back()->m_member = i;
+				}
+
+				refs[1] = Ref();
+				refs[1] = manager.insert(MemoryCorrectnessItem{});
+				refs[1]->m_member = 3;
+				CHECK_EQUAL(manager.size(), 3, "Size check after inserting into a freed slot");
+				CHECK_EQUAL(refs[0]->m_member.value(), 0, "Check data intact after inserting into a freed slot 0");
+				CHECK_EQUAL(refs[1]->m_member.value(), 3, "Check data intact after inserting into a freed slot 1");
+				CHECK_EQUAL(refs[2]->m_member.value(), 2, "Check data intact after inserting into a freed slot 2");
+
+				refs.erase(refs.begin());
+				refs.push_back(manager.insert(MemoryCorrectnessItem{}));
+				refs.back()->m_member = 4;
+				CHECK_EQUAL(manager.size(), 3, "Size check after inserting into a second freed slot");
+				CHECK_EQUAL(refs[0]->m_member.value(), 3, "Check data intact after inserting into a second freed slot 0");
+				CHECK_EQUAL(refs[1]->m_member.value(), 2, "Check data intact after inserting into a second freed slot 1");
+				CHECK_EQUAL(refs[2]->m_member.value(), 4, "Check data intact after inserting into a second freed slot 2");
+			}
+			CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 0, "Memory leak check");
+			CHECK_EQUAL(MemoryCorrectnessItem::count_errors(), 0, "Memory Error check");
+		}
+		{// Test range-based for - erasing moves the last resource into the gap so the values are sorted before checking.
 			{ // Test range-based for non-const
 				MemoryCorrectnessItem::reset();
 				{
@@ -209,6 +241,7 @@ namespace Test
 						std::vector<int> values;
 						for (auto& resource : manager)
 							values.push_back(*resource.m_member);
+						std::sort(values.begin(), values.end());
 
 						CHECK_EQUAL(values.size(), 4, "Range-based for loop iteration middle-gap buffer count");
 						CHECK_EQUAL(values[0], 0, "Range-based for loop iteration middle-gap buffer data validity 0");
@@ -222,6 +255,7 @@ namespace Test
 						std::vector<int> values;
 						for (auto& resource : manager)
 							values.push_back(*resource.m_member);
+						std::sort(values.begin(), values.end());
 
 						CHECK_EQUAL(values.size(), 3, "Range-based for loop iteration start-gap buffer count");
 						CHECK_EQUAL(values[0], 1, "Range-based for loop iteration start-gap buffer data validity 0");
@@ -235,6 +269,7 @@ namespace Test
 						std::vector<int> values;
 						for (auto& resource : manager)
 							values.push_back(*resource.m_member);
+						std::sort(values.begin(), values.end());
 
 						CHECK_EQUAL(values.size(), 2, "Range-based for loop iteration end-gap buffer count");
 						CHECK_EQUAL(values[0], 1, "Range-based for loop iteration end-gap buffer data validity 0");
@@ -287,6 +322,7 @@ namespace Test
 						std::vector<int> values;
 						for (auto resource : manager)
 							values.push_back(*resource.m_member);
+						std::sort(values.begin(), values.end());
 
 						CHECK_EQUAL(values.size(), 4, "Range-based for loop iteration middle-gap buffer count");
 						CHECK_EQUAL(values[0], 0, "Range-based for loop iteration middle-gap buffer data validity 0");
@@ -300,6 +336,7 @@ namespace Test
 						std::vector<int> values;
 						for (const auto& resource : manager)
 							values.push_back(*resource.m_member);
+						std::sort(values.begin(), values.end());
 
 						CHECK_EQUAL(values.size(), 3, "Range-based for loop iteration start-gap buffer count");
 						CHECK_EQUAL(values[0], 1, "Range-based for loop iteration start-gap buffer data validity 0");
@@ -313,6 +350,7 @@ namespace Test
 						std::vector<int> values;
 						for (const auto& resource : manager)
 							values.push_back(*resource.m_member);
+						std::sort(values.begin(), values.end());
 
 						CHECK_EQUAL(values.size(), 2, "Range-based for loop iteration end-gap buffer count");
 						CHECK_EQUAL(values[0], 1, "Range-based for loop iteration end-gap buffer data validity 0");
@@ -334,7 +372,147 @@ namespace Test
 			}
 		}
 
-		{// TODO test get_or_create
+		{// Check get_or_create by key
+			MemoryCorrectnessItem::reset();
+			{
+				Manager manager;
+				auto has_member = [](int p_member) { return [p_member](const MemoryCorrectnessItem& p_item) { return p_item.m_member == p_member; }; };
+
+				auto ref_1 = manager.get_or_create(1, has_member(1));
+				ref_1->m_member = 1;
+				auto ref_2 = manager.get_or_create(2, has_member(2));
+				ref_2->m_member = 2;
+				CHECK_EQUAL(manager.size(), 2, "Size check after creating two keys");
+
+				auto ref_1_again = manager.get_or_create(1, has_member(1));
+				CHECK_EQUAL(manager.size(), 2, "Size check after getting an existing key");
+				CHECK_EQUAL(ref_1_again->m_member.value(), 1, "Get existing key returns the resource created with it");
+
+				// A resource with the same key that find_if_func doesn't match is a distinct resource.
+				auto ref_3 = manager.get_or_create(1, has_member(3));
+				ref_3->m_member = 3;
+				CHECK_EQUAL(manager.size(), 3, "Size check after creating a colliding key");
+				CHECK_EQUAL(manager.get_or_create(1, has_member(3))->m_member.value(), 3, "Get colliding key returns the matching resource");
+				CHECK_EQUAL(manager.get_or_create(1, has_member(1))->m_member.value(), 1, "Get colliding key returns the matching resource");
+
+				// Once erased a key is created again.
+				ref_3 = Ref();
+				CHECK_EQUAL(manager.size(), 2, "Size check after erasing a keyed resource");
+				auto ref_3_again = manager.get_or_create(1, has_member(3));
+				CHECK_EQUAL(manager.size(), 3, "Size check after recreating an erased key");
+				CHECK_TRUE(!ref_3_again->m_member.has_value(), "Recreated key constructs a new resource");
+
+				// get_or_create_with only calls the create function for keys it doesn't find.
+				size_t create_count = 0;
+				auto create_4 = [&create_count]() { create_count++; MemoryCorrectnessItem item; item.m_member = 4; return item; };
+				auto ref_4 = manager.get_or_create_with(4, has_member(4), create_4);
+				CHECK_EQUAL(ref_4->m_member.value(), 4, "Get with create function returns the created resource");
+				auto ref_4_again = manager.get_or_create_with(4, has_member(4), create_4);
+				CHECK_EQUAL(create_count, 1, "Get with create function doesn't call it for an existing key");
+				CHECK_EQUAL(manager.size(), 4, "Size check after getting with a create function");
+			}
+			CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 0, "Memory leak check");
+			CHECK_EQUAL(MemoryCorrectnessItem::count_errors(), 0, "Memory Error check");
+		}
+		{// Check ResourceRefs copied and released across threads
+			MemoryCorrectnessItem::reset();
+			{
+				Manager manager;
+				auto ref = manager.insert(MemoryCorrectnessItem{});
+				{
+					std::vector<std::thread> threads;
+					for (int t = 0; t < 4; t++)
+						threads.emplace_back([&ref]() { for (int i = 0; i < 10000; i++) { auto copy = ref; } });
+					for (auto& thread : threads)
+						thread.join();
+				}
+				CHECK_EQUAL(manager.size(), 1, "Size check after copying a ResourceRef across threads");
+
+				{// Every thread gets the same 16 keys, each is created once and released on the thread.
+					std::vector<std::thread> threads;
+					for (int t = 0; t < 4; t++)
+					{
+						threads.emplace_back([&manager]()
+						{
+							std::vector<Ref> refs;
+							for (size_t key = 0; key < 16; key++)
+								refs.push_back(manager.get_or_create(key, [](const MemoryCorrectnessItem&) { return true; }));
+						});
+					}
+					for (auto& thread : threads)
+						thread.join();
+				}
+				CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 17, "Resources released on other threads are alive until destroy_released");
+				manager.destroy_released();
+				CHECK_EQUAL(manager.size(), 1, "Size check after destroy_released");
+				CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 1, "Resources released on other threads destroyed by destroy_released");
+			}
+			CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 0, "Memory leak check");
+			CHECK_EQUAL(MemoryCorrectnessItem::count_errors(), 0, "Memory Error check");
+		}
+		{// Check resources are created without the manager locked
+			MemoryCorrectnessItem::reset();
+			{
+				Manager manager;
+				auto any = []() { return [](const MemoryCorrectnessItem&) { return true; }; };
+
+				// Another thread uses the manager while this one creates, it would wait forever if the manager were locked.
+				bool other_thread_used_manager = false;
+				auto ref = manager.get_or_create_with(0, any(), [&]()
+				{
+					std::thread([&]() { other_thread_used_manager = manager.size() == 0; }).join();
+					return MemoryCorrectnessItem{};
+				});
+				CHECK_TRUE(other_thread_used_manager, "Manager usable by other threads while creating");
+
+				// The same key is inserted while the outer call is creating, the outer call loses the race and returns the inserted resource.
+				Ref inner_ref;
+				auto outer_ref = manager.get_or_create_with(1, any(), [&]()
+				{
+					inner_ref = manager.get_or_create_with(1, any(), []() { MemoryCorrectnessItem item; item.m_member = 1; return item; });
+					return MemoryCorrectnessItem{};
+				});
+				CHECK_EQUAL(manager.size(), 2, "Size check after losing a race to create");
+				CHECK_TRUE(outer_ref->m_member == 1, "Losing a race returns the resource inserted first");
+				CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 2, "Resource created losing a race destroyed");
+			}
+			CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 0, "Memory leak check");
+			CHECK_EQUAL(MemoryCorrectnessItem::count_errors(), 0, "Memory Error check");
+		}
+		{// Check released resources are cached within the budget, least recently released evicted first
+			MemoryCorrectnessItem::reset();
+			{
+				Manager manager;
+				manager.set_cache_budget(2 * sizeof(MemoryCorrectnessItem));
+				auto any = []() { return [](const MemoryCorrectnessItem&) { return true; }; };
+
+				{
+					std::vector<Ref> refs;
+					for (size_t key = 0; key < 3; key++)
+						refs.push_back(manager.get_or_create(key, any()));
+				}// Released in order 0, 1, 2. Caching 2 exceeds the budget evicting 0.
+				CHECK_EQUAL(manager.size(), 2, "Size check after releasing over the cache budget");
+				CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 2, "Cached resources are alive");
+				CHECK_EQUAL(manager.cache_stats().count, 2, "Cache count after releasing over the cache budget");
+				CHECK_EQUAL(manager.cache_stats().bytes, 2 * sizeof(MemoryCorrectnessItem), "Cache bytes after releasing over the cache budget");
+				CHECK_EQUAL(manager.cache_stats().evictions, 1, "Cache evictions after releasing over the cache budget");
+				CHECK_EQUAL(manager.cache_stats().misses, 3, "Cache misses creating the resources");
+
+				auto ref_1 = manager.get_or_create(1, any());
+				CHECK_EQUAL(manager.cache_stats().hits, 1, "Getting a cached resource is a hit");
+				CHECK_EQUAL(manager.cache_stats().count, 1, "Getting a cached resource takes it out of the cache");
+				auto ref_0 = manager.get_or_create(0, any());
+				CHECK_EQUAL(manager.cache_stats().misses, 4, "Getting an evicted resource is a miss");
+				CHECK_EQUAL(manager.size(), 3, "Size check after getting cached and evicted resources");
+
+				manager.set_cache_budget(0);
+				CHECK_EQUAL(manager.size(), 2, "Disabling the cache evicts the cached resources");
+				CHECK_EQUAL(manager.cache_stats().bytes, 0, "Cache bytes after disabling the cache");
+				ref_1 = Ref();
+				CHECK_EQUAL(manager.size(), 1, "Releasing with the cache disabled erases the resource");
+			}
+			CHECK_EQUAL(MemoryCorrectnessItem::count_alive(), 0, "Memory leak check");
+			CHECK_EQUAL(MemoryCorrectnessItem::count_errors(), 0, "Memory Error check");
 		}
 		{// TODO Check move assigning and move constructing a ResourceManager
 		}
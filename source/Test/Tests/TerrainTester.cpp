@@ -0,0 +1,217 @@
+#include "TerrainTester.hpp"
+
+#include "Component/Terrain.hpp"
+#include "Component/TerrainStream.hpp"
+
+#include "Utility/Logger.hpp"
+#include "Utility/PerlinNoise.hpp"
+#include "Utility/Stopwatch.hpp"
+
+#include <cstring>
+#include <span>
+#include <vector>
+
+DISABLE_WARNING_PUSH
+DISABLE_WARNING_HIDES_PREVIOUS_DECLERATION // Required to allow shadowing for the SCOPE_SECTION macro
+
+namespace Test
+{
+	// True if p_lhs and p_rhs hold the same quantised heights and normals.
+	static bool equal_vertices(const Data::TerrainVertex& p_lhs, const Data::TerrainVertex& p_rhs)
+	{
+		return p_lhs.height == p_rhs.height && p_lhs.normal == p_rhs.normal;
+	}
+
+	// The heights of p_terrain computed as one band of every row on the calling thread, following Component::Terrain::regenerate.
+	static std::vector<float> single_band_heights(const Component::Terrain& p_terrain)
+	{
+		const size_t rows    = static_cast<size_t>(p_terrain.m_size_z + 1);
+		const size_t columns = static_cast<size_t>(p_terrain.m_size_x + 1);
+		const size_t count   = (columns + 3) / 4 * 4;
+		const siv::PerlinNoise perlin{p_terrain.m_seed};
+		std::vector<double> x_coords(count);
+		std::vector<double> z_coords(count);
+		std::vector<double> row_noise(count);
+		std::vector<float> heights(rows * columns, 0.f);
+
+		float octave_frequency = 1.f;
+		float octave_amplitude = 1.f;
+		float max_value        = 0.f;
+		for (int octave = 0; octave < p_terrain.m_octaves; octave++)
+		{
+			for (size_t z = 0; z < rows; z++)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					x_coords[i] = static_cast<float>(i) * p_terrain.m_scale_factor * octave_frequency;
+					z_coords[i] = static_cast<float>(z) * p_terrain.m_scale_factor * octave_frequency;
+				}
+				perlin.noise2DBatch(x_coords.data(), z_coords.data(), row_noise.data(), count);
+
+				for (size_t x = 0; x < columns; x++)
+					heights[z * columns + x] += static_cast<float>(row_noise[x]) * octave_amplitude;
+			}
+			max_value        += octave_amplitude;
+			octave_amplitude *= p_terrain.m_persistence;
+			octave_frequency *= p_terrain.m_lacunarity;
+		}
+		for (auto& height : heights)
+			height = height / max_value * p_terrain.m_amplitude;
+
+		return heights;
+	}
+	static bool equal_heights(std::span<const float> p_lhs, std::span<const float> p_rhs)
+	{
+		return p_lhs.size() == p_rhs.size() && std::memcmp(p_lhs.data(), p_rhs.data(), p_lhs.size_bytes()) == 0;
+	}
+
+	void TerrainTester::run_unit_tests()
+	{
+		run_terrain_tests();
+		run_terrain_stream_tests();
+	}
+
+	void TerrainTester::run_terrain_tests()
+	{SCOPE_SECTION("Terrain")
+		{SCOPE_SECTION("Parallel matches single band")
+			// Sizes below, equal to and not a multiple of the 16 rows a band covers, with more bands than threads for the largest.
+			for (int size : {4, 15, 16, 37, 100, 257})
+			{
+				Component::Terrain terrain({0.f, 0.f, 0.f}, size, size / 2 + 1, 10.f);
+				CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), single_band_heights(terrain)), "Heights");
+			}
+		}
+		{SCOPE_SECTION("Regenerate matches a fresh terrain")
+			// A terrain generated from scratch with the settings of p_terrain. The seed is changed and restored so no noise is reused.
+			auto fresh_heights = [](const Component::Terrain& p_terrain)
+			{
+				Component::Terrain fresh = p_terrain;
+				fresh.m_seed++;
+				fresh.regenerate();
+				fresh.m_seed--;
+				fresh.regenerate();
+				return std::vector<float>(fresh.m_heightfield.heights().begin(), fresh.m_heightfield.heights().end());
+			};
+
+			Component::Terrain terrain({0.f, 0.f, 0.f}, 50, 40, 5.f);
+			terrain.m_seed = 77u;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "Initial");
+
+			terrain.m_amplitude = 9.f;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "Amplitude");
+			terrain.m_persistence = 0.7f;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "Persistence");
+			terrain.m_octaves = 6;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "More octaves");
+			terrain.m_octaves = 2;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "Fewer octaves");
+			terrain.m_octaves = 5;
+			terrain.m_lacunarity = 2.5f;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "Lacunarity");
+			terrain.m_size_x = 73;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "Grow X");
+			terrain.m_size_x = 31;
+			terrain.m_size_z = 67;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "Shrink X grow Z");
+			terrain.m_size_z = 10;
+			terrain.regenerate();
+			CHECK_TRUE(equal_heights(terrain.m_heightfield.heights(), fresh_heights(terrain)), "Shrink Z");
+		}
+		{SCOPE_SECTION("Copies share noise layers")
+			Component::Terrain original({0.f, 0.f, 0.f}, 40, 30, 5.f);
+			Component::Terrain copy = original;
+			const auto copy_heights = std::vector<float>(copy.m_heightfield.heights().begin(), copy.m_heightfield.heights().end());
+			CHECK_TRUE(copy.m_noise_layers == original.m_noise_layers, "Copy shares noise layers");
+
+			original.m_size_x    = 60;
+			original.m_amplitude = 12.f;
+			original.m_octaves   = 6;
+			original.regenerate();
+			CHECK_TRUE(copy.m_noise_layers != original.m_noise_layers, "Regenerating stops sharing");
+			CHECK_EQUAL(copy.m_noise_layers->columns, 41, "Copy noise layers unchanged");
+			CHECK_EQUAL(copy.m_noise_layers->octaves.size(), 4, "Copy noise octaves unchanged");
+			CHECK_TRUE(equal_heights(copy.m_heightfield.heights(), copy_heights), "Copy heights unchanged");
+
+			copy.regenerate();
+			CHECK_TRUE(equal_heights(copy.m_heightfield.heights(), copy_heights), "Copy regenerates the same heights");
+		}
+	}
+
+	void TerrainTester::run_terrain_stream_tests()
+	{SCOPE_SECTION("TerrainStream")
+		using TerrainStream = Component::TerrainStream;
+		TerrainStream::Settings settings;
+		settings.seed         = 1234u;
+		settings.chunk_cells  = 15; // Not a multiple of the batches of four samples are generated in.
+		settings.scale_factor = 0.03f;
+		settings.amplitude    = 20.f;
+		settings.lacunarity   = 2.f;
+		settings.persistence  = 0.5f;
+		settings.octaves      = 4;
+		const size_t vertices_x = static_cast<size_t>(settings.chunk_cells + 1);
+
+		{SCOPE_SECTION("Deterministic")
+			const auto first  = TerrainStream::generate(settings, {3, -2});
+			const auto second = TerrainStream::generate(settings, {3, -2});
+			CHECK_EQUAL(first.vertices.size(), vertices_x * vertices_x, "Vertex count");
+			CHECK_EQUAL(second.vertices.size(), first.vertices.size(), "Same vertex count");
+			CHECK_TRUE(std::memcmp(first.vertices.data(), second.vertices.data(), first.vertices.size() * sizeof(Data::TerrainVertex)) == 0, "Same vertices");
+			CHECK_TRUE(first.bounds.m_min == second.bounds.m_min && first.bounds.m_max == second.bounds.m_max, "Same bounds");
+
+			auto other_seed = settings;
+			other_seed.seed++;
+			const auto reseeded = TerrainStream::generate(other_seed, {3, -2});
+			CHECK_TRUE(std::memcmp(first.vertices.data(), reseeded.vertices.data(), first.vertices.size() * sizeof(Data::TerrainVertex)) != 0, "Seed changes vertices");
+		}
+		{SCOPE_SECTION("Neighbouring borders match")
+			// Chunks either side of the origin too, where the sample coordinates change sign.
+			for (TerrainStream::Coord coord : {TerrainStream::Coord{0, 0}, TerrainStream::Coord{-1, -1}, TerrainStream::Coord{4, -3}})
+			{
+				const auto chunk = TerrainStream::generate(settings, coord);
+				const auto right = TerrainStream::generate(settings, {coord.x + 1, coord.z});
+				const auto above = TerrainStream::generate(settings, {coord.x, coord.z + 1});
+
+				bool right_border_matches = true;
+				bool above_border_matches = true;
+				for (size_t i = 0; i < vertices_x; i++)
+				{
+					right_border_matches &= equal_vertices(chunk.vertices[i * vertices_x + vertices_x - 1], right.vertices[i * vertices_x]);
+					above_border_matches &= equal_vertices(chunk.vertices[(vertices_x - 1) * vertices_x + i], above.vertices[i]);
+				}
+				CHECK_TRUE(right_border_matches, "Border along X matches");
+				CHECK_TRUE(above_border_matches, "Border along Z matches");
+			}
+		}
+	}
+
+	void TerrainTester::run_performance_tests()
+	{
+		Component::TerrainStream::Settings settings;
+		settings.seed         = 1234u;
+		settings.scale_factor = 0.03f;
+		settings.amplitude    = 20.f;
+		settings.lacunarity   = 2.f;
+		settings.persistence  = 0.5f;
+		settings.octaves      = 4;
+
+		for (int chunk_cells : {32, 64, 128})
+		{
+			settings.chunk_cells = chunk_cells;
+			Utility::Stopwatch stopwatch;
+			for (int z = 0; z < 4; z++)
+				for (int x = 0; x < 4; x++)
+					Component::TerrainStream::generate(settings, {x, z});
+
+			printf("TerrainStream::generate 16 chunks of %dx%d cells: %fms\n", chunk_cells, chunk_cells, stopwatch.duration_since_start<float, std::milli>().count());
+		}
+	}
+} // namespace Test
+DISABLE_WARNING_POP
\ No newline at end of file
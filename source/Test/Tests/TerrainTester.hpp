@@ -0,0 +1,18 @@
+#pragma once
+
+#include "TestManager.hpp"
+
+namespace Test
+{
+	class TerrainTester : public TestManager
+	{
+	public:
+		TerrainTester() : TestManager(std::string("TERRAIN TEST")) {}
+
+		void run_unit_tests()        override;
+		void run_performance_tests() override;
+	private:
+		void run_terrain_tests();
+		void run_terrain_stream_tests();
+	};
+} // namespace Test
\ No newline at end of file
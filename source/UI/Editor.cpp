@@ -9,6 +9,7 @@
 #include "Component/ParticleEmitter.hpp"
 #include "Component/RigidBody.hpp"
 #include "Component/Terrain.hpp"
+#include "Component/TerrainStream.hpp"
 #include "Component/Texture.hpp"
 #include "Component/Transform.hpp"
 #include "ECS/Storage.hpp"
@@ -552,6 +553,8 @@ namespace UI
 			scene.get_component<Component::ParticleEmitter>(p_entity).draw_UI(m_asset_manager);
 		if (scene.has_components<Component::Terrain>(p_entity))
 			scene.get_component<Component::Terrain>(p_entity).draw_UI(m_asset_manager);
+		if (scene.has_components<Component::TerrainStream>(p_entity))
+			scene.get_component<Component::TerrainStream>(p_entity).draw_UI(m_asset_manager);
 		if (scene.has_components<Component::Mesh>(p_entity))
 			scene.get_component<Component::Mesh>(p_entity).draw_UI();
 		if (scene.has_components<Component::Texture>(p_entity))
@@ -686,6 +689,16 @@ namespace UI
 			ImGui::Slider("Position offset factor", debug_options.m_position_offset_factor, -10.f, 10.f);
 			ImGui::Slider("Position offset units",  debug_options.m_position_offset_units,  -10.f, 10.f);
 
+			ImGui::SeparatorText("Sleeping");
+			ImGui::Checkbox("Allow sleeping", &m_physics_system.m_allow_sleeping);
+			if (!m_physics_system.m_allow_sleeping) ImGui::BeginDisabled();
+			ImGui::Slider("Linear velocity threshold (m/s)",    m_physics_system.m_sleep_linear_velocity, 0.f, 1.f);
+			ImGui::Slider("Angular velocity threshold (rad/s)", m_physics_system.m_sleep_angular_velocity, 0.f, 1.f);
+			ImGui::Slider("Time to sleep (s)", m_physics_system.m_time_to_sleep, DeltaTime(0.f), DeltaTime(5.f));
+			if (!m_physics_system.m_allow_sleeping) ImGui::EndDisabled();
+			ImGui::Text("Islands",         m_physics_system.m_island_count);
+			ImGui::Text("Sleeping bodies", m_physics_system.m_sleeping_body_count);
+
 			if (ImGui::Button("Reset"))
 			{
 				debug_options.m_show_orientations            = false;
@@ -742,6 +755,16 @@ namespace UI
 							Component::Label{"Terrain"},
 							Component::Terrain{*m_cursor_intersection, 10, 10, 5.f});
 					}
+					else if (ImGui::Button("Terrain stream"))
+					{
+						auto stream = Component::TerrainStream{*m_cursor_intersection, 5.f};
+						stream.m_grass_tex = m_asset_manager.get_texture(Config::Texture_PBR_Directory / "Grass" / "Color.jpg");
+						stream.m_rock_tex  = m_asset_manager.get_texture(Config::Texture_PBR_Directory / "Rock" / "Color.jpg");
+						stream.m_snow_tex  = m_asset_manager.get_texture(Config::Texture_PBR_Directory / "Snow" / "Color.jpg");
+						m_scene_system.get_current_scene_entities().add_entity(
+							Component::Label{"Terrain stream"},
+							std::move(stream));
+					}
 					ImGui::EndMenu();
 				}
 				if (ImGui::BeginMenu("Light"))
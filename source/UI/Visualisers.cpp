@@ -266,15 +266,29 @@ namespace UI
 
 			if (entity_1_transform && entity_2_transform && entity_1_mesh && entity_2_mesh && entity_1_mesh->m_mesh && entity_2_mesh->m_mesh)
 			{
+				// Step through GJK as the physics does, hill-climbing the convex hulls of the meshes warm-started by the cache.
+				// The cache is kept between frames while the same pair is shown, as CollisionSystem keeps one per pair between ticks.
+				const auto& hull_1               = entity_1_mesh->m_mesh->get_convex_hull();
+				const auto& hull_2               = entity_2_mesh->m_mesh->get_convex_hull();
+				const auto inverse_orientation_1 = glm::inverse(entity_1_transform->m_orientation);
+				const auto inverse_orientation_2 = glm::inverse(entity_2_transform->m_orientation);
+				static GJK::SupportCache support_cache;
+				static auto support_cache_pair = std::pair<EntityID, EntityID>{0, 0};
+				if (support_cache_pair != std::pair<EntityID, EntityID>{p_entity_1.ID, p_entity_2.ID})
+				{
+					support_cache      = GJK::SupportCache{};
+					support_cache_pair = {p_entity_1.ID, p_entity_2.ID};
+				}
+
 				{ // Render a debug point cloud of the Minkowski difference.
 					ImGui::Separator();
-					ImGui::Text("Mesh 1 vertex count", entity_1_mesh->m_mesh->vertex_positions.size());
-					ImGui::Text("Mesh 2 vertex count", entity_2_mesh->m_mesh->vertex_positions.size());
+					ImGui::Text("Hull 1 vertex count", hull_1.vertices().size());
+					ImGui::Text("Hull 2 vertex count", hull_2.vertices().size());
 					ImGui::Text("Current step", p_debug_step + 1);
 
 					// The GJK algorithm avoids ever doing this by transforming the support point directions into the local space of the objects and transforming the result.
-					for (auto& vertex_1 : entity_1_mesh->m_mesh->vertex_positions)
-						for (auto& vertex_2 : entity_2_mesh->m_mesh->vertex_positions)
+					for (auto& vertex_1 : hull_1.vertices())
+						for (auto& vertex_2 : hull_2.vertices())
 						{
 							auto vertex_1_world_space = glm::vec3(entity_1_transform->get_model() * glm::vec4(vertex_1, 1.f));
 							auto vertex_2_world_space = glm::vec3(entity_2_transform->get_model() * glm::vec4(vertex_2, 1.f));
@@ -285,8 +299,8 @@ namespace UI
 				// Start direction is the vector between the two entities. Improvement would be to use the previous GJK result as the starting direction.
 				glm::vec3 direction = glm::normalize(entity_2_transform->m_position - entity_1_transform->m_position);
 				GJK::Simplex simplex = {GJK::support_point(direction,
-				                                           entity_1_mesh->m_mesh->vertex_positions, entity_1_transform->get_model(), entity_1_transform->m_orientation,
-				                                           entity_2_mesh->m_mesh->vertex_positions, entity_2_transform->get_model(), entity_2_transform->m_orientation)};
+				                                           hull_1, entity_1_transform->get_model(), inverse_orientation_1,
+				                                           hull_2, entity_2_transform->get_model(), inverse_orientation_2, support_cache)};
 				direction = -simplex[0]; // AO, search in the direction of the origin. Reversed direction to point towards the origin.
 
 				std::optional<bool> intersecting;
@@ -298,8 +312,8 @@ namespace UI
 					while (true) // Main GJK loop. Converge on a simplex that encloses the origin.
 					{
 						auto new_support_point = GJK::support_point(direction,
-						                                            entity_1_mesh->m_mesh->vertex_positions, entity_1_transform->get_model(), entity_1_transform->m_orientation,
-						                                            entity_2_mesh->m_mesh->vertex_positions, entity_2_transform->get_model(), entity_2_transform->m_orientation);
+						                                            hull_1, entity_1_transform->get_model(), inverse_orientation_1,
+						                                            hull_2, entity_2_transform->get_model(), inverse_orientation_2, support_cache);
 
 						if (glm::dot(new_support_point, direction) <= 0.f)
 						{// If the new support point is not past the origin then its impossible to enclose the origin.
@@ -338,8 +352,8 @@ namespace UI
 						if (*intersecting)
 						{
 							auto cp = GJK::EPA(simplex,
-											entity_1_mesh->m_mesh->vertex_positions, entity_1_transform->get_model(), entity_1_transform->m_orientation,
-											entity_2_mesh->m_mesh->vertex_positions, entity_2_transform->get_model(), entity_2_transform->m_orientation);
+											hull_1, entity_1_transform->get_model(), entity_1_transform->m_orientation,
+											hull_2, entity_2_transform->get_model(), entity_2_transform->m_orientation, &support_cache);
 
 							cp.A = glm::vec3(entity_1_transform->get_model() * glm::vec4(cp.A, 1.f));
 							cp.B = glm::vec3(entity_2_transform->get_model() * glm::vec4(cp.B, 1.f));
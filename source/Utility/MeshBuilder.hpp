@@ -61,9 +61,10 @@ namespace Utility
 			static_assert(Data::has_colour_member<VertexType>, "VertexType must have a colour member.");
 			current_colour = glm::vec4(colour, 1.f);
 		}
-		[[nodiscard]] Data::Mesh get_mesh()
+		//@param p_retain_triangles Keep the triangles of the mesh on the CPU for exact raycasts, see Data::Mesh::triangle_BVH.
+		[[nodiscard]] Data::Mesh get_mesh(bool p_retain_triangles = false)
 		{
-			return Data::Mesh{data, primitive_mode};
+			return Data::Mesh{data, primitive_mode, p_retain_triangles};
 		}
 
 	private:
@@ -4,9 +4,18 @@
 #include "FunctionTraits.hpp"
 
 #include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <type_traits>
-#include <unordered_set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -18,8 +27,24 @@ namespace Utility
 	template <typename Resource>
 	class ResourceRef;
 
+	// Resources providing memory_size() are measured by it in the ResourceManager cache, others by their sizeof.
+	template <typename Resource>
+	concept Has_Memory_Size = requires(const Resource& p_resource)
+	{
+		{ p_resource.memory_size() } -> std::convertible_to<size_t>;
+	};
+
 	// ResourceManager is a container for a Resource type.
 	// It manages the lifetime of the Resource instances and provides a way to access them via ResourceRef objects.
+	// The manager can be used from any thread. ResourceRefs count references atomically and reach their Resource without locking the manager.
+	// A Resource released on the thread that constructed the manager is destroyed immediately, one released on any other thread is destroyed
+	// by the next call to destroy_released. Resources holding GPU objects must only be destroyed on the thread owning the GL context.
+	//
+	// Resources are stored as a slot map. A ResourceRef identifies its Resource by a Handle to a slot, the slot holds the position of the
+	// Resource in m_resources which is packed for iteration. Erasing moves the last Resource into the gap and frees the slot for reuse.
+	//
+	// With a cache budget set, released Resources stay resident until the bytes they hold exceed the budget, then the least recently
+	// released are destroyed. A get_or_create finding a cached Resource returns it rather than constructing it again.
 	template<typename Resource>
 	class ResourceManager
 	{
@@ -28,48 +53,156 @@ namespace Utility
 		using RefType = ResourceRef<Resource>;
 		friend RefType;
 
+		// Identifies the Resource in a slot. The generation of a slot increments every time its Resource is erased,
+		// a Handle held past the erase never matches the Resource reusing the slot.
+		struct Handle
+		{
+			uint32_t slot;
+			uint32_t generation;
+			bool operator==(const Handle&) const = default;
+		};
+		struct Slot
+		{
+			static constexpr size_t Free = std::numeric_limits<size_t>::max();
+
+			size_t dense_index;  // The index of the slot's Resource in m_resources, Free if the slot has no Resource.
+			uint32_t generation; // The generation of the Resource in the slot, or the next Resource if the slot is free.
+		};
+		using CacheList = std::list<Handle>; // Released resources kept resident, least recently released first.
+
 		struct ResourceData
 		{
-			ResourceData(Resource&& p_resource, size_t p_count) noexcept : m_resource(std::move(p_resource)), m_count(p_count) {}
+			ResourceData(Resource&& p_resource, size_t p_count, uint32_t p_slot) noexcept
+				: m_resource(std::move(p_resource)), m_count(p_count), m_key(std::nullopt), m_slot(p_slot), m_cache_entry(std::nullopt), m_cached_bytes(0)
+			{}
 			~ResourceData() noexcept = default;
-			ResourceData& operator=(ResourceData&& p_other) noexcept = default;
-			ResourceData(ResourceData&& p_other) noexcept            = default;
+			ResourceData& operator=(ResourceData&& p_other) noexcept = delete;
+			ResourceData(ResourceData&& p_other) noexcept            = delete;
 			ResourceData& operator=(const ResourceData& p_other)     = delete;
 			ResourceData(const ResourceData& p_other)                = delete;
 
 			Resource m_resource;
-			size_t m_count;
+			std::atomic<size_t> m_count;
+			std::optional<size_t> m_key; // The key the resource is indexed under in m_key_index, if it was created with one.
+			uint32_t m_slot;             // The slot referring to this resource, updated when erasing another resource moves this one.
+			std::optional<typename CacheList::iterator> m_cache_entry; // The entry of the resource in m_cache while only the cache keeps it resident.
+			size_t m_cached_bytes;       // The memory_size of the resource when it was cached.
+		};
+
+	public:
+		struct CacheStats
+		{
+			size_t budget    = 0; // Bytes of released resources kept resident. 0 if the cache is disabled.
+			size_t bytes     = 0; // Bytes of released resources resident.
+			size_t count     = 0; // Released resources resident.
+			size_t hits      = 0; // get_or_create calls returning a resource the cache kept resident.
+			size_t misses    = 0; // get_or_create calls constructing the resource.
+			size_t evictions = 0; // Released resources destroyed to stay within the budget.
 		};
 
-		std::vector<std::optional<ResourceData>> m_resources;
-		std::unordered_set<size_t> m_free_indices; // Indices of free elements in the buffer. Memory at these addresses is allocated but not initialised.
+	private:
+
+		// The members below are guarded by m_mutex. It is recursive so for_each functions and range-based for bodies can use the manager.
+		mutable std::recursive_mutex m_mutex;
+		std::vector<std::unique_ptr<ResourceData>> m_resources; // Packed, every element is a live resource. Heap allocated so ResourceRefs keep their address while it's reordered or other threads insert.
+		std::vector<Slot> m_slots;
+		std::vector<uint32_t> m_free_slots;                  // Slots without a Resource, reused by insert before adding a slot.
+		std::unordered_multimap<size_t, Handle> m_key_index; // Key to the resources created with it. Distinct resources can share a key.
+		std::vector<Handle> m_released; // Resources released on threads other than m_owner_thread, destroyed by destroy_released.
+		CacheList m_cache;
+		CacheStats m_cache_stats;
+		std::thread::id m_owner_thread; // The thread that constructed the manager and destroys its resources.
 
 	public:
-		ResourceManager() noexcept                                     = default;
-		~ResourceManager() noexcept                                    = default;
-		ResourceManager& operator=(ResourceManager&& p_other) noexcept = default;
-		ResourceManager(ResourceManager&& p_other) noexcept            = default;
+		ResourceManager() noexcept
+			: m_mutex{}
+			, m_resources{}
+			, m_slots{}
+			, m_free_slots{}
+			, m_key_index{}
+			, m_released{}
+			, m_cache{}
+			, m_cache_stats{}
+			, m_owner_thread{std::this_thread::get_id()}
+		{}
+		~ResourceManager() noexcept = default;
+		ResourceManager& operator=(ResourceManager&& p_other) noexcept
+		{
+			if (this != &p_other)
+			{
+				std::scoped_lock lock(m_mutex, p_other.m_mutex);
+				m_resources    = std::move(p_other.m_resources);
+				m_slots        = std::move(p_other.m_slots);
+				m_free_slots   = std::move(p_other.m_free_slots);
+				m_key_index    = std::move(p_other.m_key_index);
+				m_released     = std::move(p_other.m_released);
+				m_cache        = std::move(p_other.m_cache);
+				m_cache_stats  = std::exchange(p_other.m_cache_stats, CacheStats{});
+				m_owner_thread = p_other.m_owner_thread;
+			}
+			return *this;
+		}
+		ResourceManager(ResourceManager&& p_other) noexcept
+			: ResourceManager()
+		{
+			*this = std::move(p_other);
+		}
 
 		// Delete the copy constructor and assignment operators.
 		ResourceManager(const ResourceManager& p_other)            = delete;
 		ResourceManager& operator=(const ResourceManager& p_other) = delete;
 
-		size_t size()     const { return m_resources.size() - m_free_indices.size(); }
-		size_t capacity() const { return m_resources.capacity(); }
+		// The resources resident, including those only the cache keeps resident.
+		size_t size()     const { std::lock_guard lock(m_mutex); return m_resources.size(); }
+		size_t capacity() const { std::lock_guard lock(m_mutex); return m_resources.capacity(); }
 		bool empty()      const { return size() == 0; }
 		void clear()
 		{
+			std::lock_guard lock(m_mutex);
 			// TODO: ResourceRefs given out should be invalidated when a buffer is cleared.
 			// Call the destructor for all initialised instances of ResourceData.
-			for (size_t i = 0; i < m_resources.size(); i++)
-				if (!m_free_indices.contains(i))
-					m_resources[i].reset();
+			for (const auto& resource : m_resources)
+				free_slot(resource->m_slot);
+			m_resources.clear();
+			m_key_index.clear();
+			m_released.clear();
+			m_cache.clear();
+			m_cache_stats.bytes = 0;
+			m_cache_stats.count = 0;
 
 			if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Cleared all resources");
 		}
 		void reserve(std::size_t p_capacity)
 		{
+			std::lock_guard lock(m_mutex);
 			m_resources.reserve(p_capacity);
+			m_slots.reserve(p_capacity);
+		}
+		// Destroy the resources released on other threads since the last call, unless they were got again since.
+		// Call on the thread that constructed the manager at a point no Resource is in use by it, e.g. between frames.
+		void destroy_released()
+		{
+			std::lock_guard lock(m_mutex);
+			ASSERT(std::this_thread::get_id() == m_owner_thread, "[ResourceManager] Resources can only be destroyed on the thread that constructed the manager.");
+
+			for (auto handle : m_released)
+				erase_if_released(handle);
+			m_released.clear();
+		}
+		// Keep released resources resident up to p_bytes, measured by Has_Memory_Size, so getting them again doesn't construct them.
+		// 0 disables the cache, destroying resources as soon as they are released. Call on the thread that constructed the manager.
+		void set_cache_budget(size_t p_bytes)
+		{
+			std::lock_guard lock(m_mutex);
+			ASSERT(std::this_thread::get_id() == m_owner_thread, "[ResourceManager] Resources can only be destroyed on the thread that constructed the manager.");
+
+			m_cache_stats.budget = p_bytes;
+			evict_over_budget();
+		}
+		CacheStats cache_stats() const
+		{
+			std::lock_guard lock(m_mutex);
+			return m_cache_stats;
 		}
 
 		// Move the Resource into the manager.
@@ -77,46 +210,91 @@ namespace Utility
 		//@return a ResourceRef to the Resource owned by the manager.
 		[[nodiscard]] RefType insert(Resource&& p_value)
 		{
-			if (m_free_indices.empty())
-			{// Constructing into the end of the buffer.
-				m_resources.emplace_back(ResourceData(std::move(p_value), 0));
-				if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Inserting ResourceRef at end index {}",  m_resources.size() - 1);
-				return RefType{*this, m_resources.size() - 1};
+			std::lock_guard lock(m_mutex);
+			uint32_t slot;
+			if (m_free_slots.empty())
+			{// Adding a slot to the end.
+				ASSERT_THROW(m_slots.size() < std::numeric_limits<uint32_t>::max(), "[ResourceManager] Out of slots.");
+				slot = static_cast<uint32_t>(m_slots.size());
+				m_slots.push_back(Slot{Slot::Free, 0});
 			}
 			else
-			{ // Constructing into a gap inside the buffer where a resource was previously erased.
-				auto index = *m_free_indices.begin();
-				m_resources.emplace(m_resources.begin() + index, ResourceData(std::move(p_value), 0));
-				m_free_indices.erase(m_free_indices.begin());
-				if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Inserting ResourceRef into gap at index {}", index);
-				return RefType{*this, index};
+			{// Reusing the slot of a resource previously erased.
+				slot = m_free_slots.back();
+				m_free_slots.pop_back();
 			}
+
+			m_slots[slot].dense_index = m_resources.size();
+			m_resources.push_back(std::make_unique<ResourceData>(std::move(p_value), 0, slot));
+			if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Inserting ResourceRef at slot {} generation {}", slot, m_slots[slot].generation);
+			return RefType{*this, Handle{slot, m_slots[slot].generation}};
 		}
 		// Copy the Resource into the buffer is removed. Prefer to use move insert if possible.
 		RefType insert(const Resource& p_value) = delete;
 
 		// Find a Resource in the buffer. If the Resource is not found then create one using construction args and return it.
 		// If multiple Resources are found then the first one is returned.
+		// The Resource is constructed without the manager locked, so a worker thread loading a large Resource doesn't block other threads using the manager.
+		// Two threads missing the same Resource at once both construct it, the second to finish returns the first's and destroys its own.
 		//@param find_if_func A function that takes a Resource and returns true if it is the Resource we are looking for.
 		//@param construction_args The arguments to pass to the Resource constructor if the Resource is not found.
 		//@return A valid ResourceRef to the Resource in the buffer.
 		template <typename Func, typename... Args>
+		requires std::is_invocable_r_v<bool, const Func&, const Resource&>
 		[[nodiscard]] RefType get_or_create(const Func&& find_if_func, Args&&... construction_args)
 		{
 			static_assert(std::is_constructible_v<Resource, Args...>, "construction_args given cannot be used to construct a Resource type");
 			static_assert(FunctionTraits<Func>::NumArgs == 1, "find_if_func must take 1 argument");
 			static_assert(std::is_same_v<ArgTypeN<Func, 0>, const Resource&>, "Function argument must be a 'const Resource&'");
 
-			for (size_t i = 0; i < m_resources.size(); i++)
-			{
-				if (!m_free_indices.contains(i))
-				{
-					if (find_if_func(get_resource(i)))
-						return RefType(*this, i);
-				}
-			}
+			if (auto ref = find(find_if_func))
+				return std::move(*ref);
+
+			auto resource = Resource(std::forward<Args>(construction_args)...);
+			std::lock_guard lock(m_mutex);
+			if (auto ref = find(find_if_func)) // Another thread inserted it while this one was constructing.
+				return std::move(*ref);
+
+			m_cache_stats.misses++;
+			return insert(std::move(resource));
+		}
+		// Find a Resource created with p_key. If none match then create one using construction args and index it under p_key.
+		// Only the Resources created with p_key are visited, prefer this over the find_if_func overload when a Resource has an identity to hash.
+		// Constructs without the manager locked as the find_if_func overload does.
+		//@param p_key A hash of the identity of the Resource e.g. its filepath or its contents.
+		//@param find_if_func A function that takes a Resource and returns true if it is the Resource we are looking for. Tells apart Resources sharing p_key.
+		//@param construction_args The arguments to pass to the Resource constructor if the Resource is not found.
+		//@return A valid ResourceRef to the Resource in the buffer.
+		template <typename Func, typename... Args>
+		[[nodiscard]] RefType get_or_create(size_t p_key, const Func&& find_if_func, Args&&... construction_args)
+		{
+			static_assert(std::is_constructible_v<Resource, Args...>, "construction_args given cannot be used to construct a Resource type");
+			return get_or_create_with(p_key, std::move(find_if_func), [&]() { return Resource(std::forward<Args>(construction_args)...); });
+		}
+		// Find a Resource created with p_key, see get_or_create. If none match then create one by calling p_create_func and index it under p_key.
+		// For Resources built rather than constructed from arguments e.g. a Data::Mesh from a MeshBuilder, p_create_func is only called on a miss.
+		// p_create_func is called without the manager locked, it may use the manager itself.
+		//@param p_create_func A function taking no arguments returning the Resource to insert.
+		template <typename Func, typename CreateFunc>
+		requires std::is_invocable_r_v<Resource, const CreateFunc&>
+		[[nodiscard]] RefType get_or_create_with(size_t p_key, const Func&& find_if_func, const CreateFunc& p_create_func)
+		{
+			static_assert(FunctionTraits<Func>::NumArgs == 1, "find_if_func must take 1 argument");
+			static_assert(std::is_same_v<ArgTypeN<Func, 0>, const Resource&>, "Function argument must be a 'const Resource&'");
 
-			return insert(Resource(std::forward<Args>(construction_args)...));
+			if (auto ref = find(p_key, find_if_func))
+				return std::move(*ref);
+
+			auto resource = p_create_func();
+			std::lock_guard lock(m_mutex);
+			if (auto ref = find(p_key, find_if_func)) // Another thread inserted it while this one was creating.
+				return std::move(*ref);
+
+			m_cache_stats.misses++;
+			auto ref = insert(std::move(resource));
+			get_data(*ref.m_handle).m_key = p_key;
+			m_key_index.emplace(p_key, *ref.m_handle);
+			return ref;
 		}
 		template <typename Func>
 		void for_each(const Func&& func) const
@@ -124,9 +302,9 @@ namespace Utility
 			static_assert(FunctionTraits<Func>::NumArgs == 1, "func must take 1 argument");
 			static_assert(std::is_same_v<ArgTypeN<Func, 0>, const Resource&>, "Function argument must be a 'const Resource&'");
 
-			for (size_t i = 0; i < m_resources.size(); i++)
-				if (!m_free_indices.contains(i))
-					func(get_resource(i));
+			std::lock_guard lock(m_mutex);
+			for (const auto& resource : m_resources)
+				func(std::as_const(resource->m_resource));
 		}
 		template <typename Func>
 		void for_each(const Func&& func)
@@ -134,31 +312,29 @@ namespace Utility
 			static_assert(FunctionTraits<Func>::NumArgs == 1, "func must take 1 argument");
 			static_assert(std::is_same_v<ArgTypeN<Func, 0>, Resource&>, "Function argument must be a 'Resource&'");
 
-			for (size_t i = 0; i < m_resources.size(); i++)
-				if (!m_free_indices.contains(i))
-					func(get_resource(i));
+			std::lock_guard lock(m_mutex);
+			for (const auto& resource : m_resources)
+				func(resource->m_resource);
 		}
 
+		// Iterates the packed resources. The order is not the order of insertion, erasing moves the last Resource into the gap.
 		class ResourceIterator
 		{
 			ResourceManager& m_resource_manager;
 			size_t m_index;
+			std::unique_lock<std::recursive_mutex> m_lock; // Held for the lifetime of the iterator.
 
 		public:
 			ResourceIterator(ResourceManager& resource_manager, size_t index)
-				: m_resource_manager(resource_manager), m_index(index)
-			{
-				while (m_index < m_resource_manager.m_resources.size() && m_resource_manager.m_free_indices.contains(m_index))
-					++m_index;
-			}
+				: m_resource_manager(resource_manager), m_index(index), m_lock(resource_manager.m_mutex)
+			{}
 			ResourceIterator& operator++()
 			{
-				do { ++m_index; }
-				while (m_index < m_resource_manager.m_resources.size() && m_resource_manager.m_free_indices.contains(m_index));
+				++m_index;
 				return *this;
 			}
 
-			Resource& operator*() { return m_resource_manager.get_resource(m_index); }
+			Resource& operator*() { return m_resource_manager.m_resources[m_index]->m_resource; }
 			bool operator!=(const ResourceIterator& other) const { return m_index != other.m_index; }
 		};
 
@@ -166,79 +342,175 @@ namespace Utility
 		{
 			const ResourceManager& m_resource_manager;
 			size_t m_index;
+			std::unique_lock<std::recursive_mutex> m_lock; // Held for the lifetime of the iterator.
 
 		public:
 			ConstResourceIterator(const ResourceManager& resource_manager, size_t index)
-				: m_resource_manager(resource_manager), m_index(index)
-			{
-				while (m_index < m_resource_manager.m_resources.size() && m_resource_manager.m_free_indices.contains(m_index))
-					++m_index;
-			}
+				: m_resource_manager(resource_manager), m_index(index), m_lock(resource_manager.m_mutex)
+			{}
 			ConstResourceIterator& operator++()
 			{
-				do { ++m_index; }
-				while (m_index < m_resource_manager.m_resources.size() && m_resource_manager.m_free_indices.contains(m_index));
+				++m_index;
 				return *this;
 			}
 
-			const Resource& operator*() { return m_resource_manager.get_resource(m_index); }
+			const Resource& operator*() { return m_resource_manager.m_resources[m_index]->m_resource; }
 			bool operator!=(const ConstResourceIterator& other) const { return m_index != other.m_index; }
 		};
 
+		// Iterators lock the manager until destroyed, other threads wait to use the manager while iterating.
 		ResourceIterator begin()            { return ResourceIterator(*this, 0); }
-		ResourceIterator end()              { return ResourceIterator(*this, m_resources.size()); }
+		ResourceIterator end()              { std::lock_guard lock(m_mutex); return ResourceIterator(*this, m_resources.size()); }
 		ConstResourceIterator begin() const { return ConstResourceIterator(*this, 0); }
-		ConstResourceIterator end()   const { return ConstResourceIterator(*this, m_resources.size()); }
+		ConstResourceIterator end()   const { std::lock_guard lock(m_mutex); return ConstResourceIterator(*this, m_resources.size()); }
 		ConstResourceIterator cbegin() const noexcept { return begin(); }
 		ConstResourceIterator cend()   const noexcept { return end(); }
 
 	private:
-		[[nodiscard]] Resource& get_resource(size_t p_index)
+		// m_mutex must be held by the callers of the functions below.
+
+		// Is p_handle the Resource in its slot, false once the Resource has been erased.
+		[[nodiscard]] bool is_live(Handle p_handle) const
 		{
-			ASSERT_THROW(m_free_indices.contains(p_index) == false, "Trying to access a free p_index!");
-			return m_resources[p_index]->m_resource;
+			return p_handle.slot < m_slots.size() && m_slots[p_handle.slot].generation == p_handle.generation && m_slots[p_handle.slot].dense_index != Slot::Free;
 		}
-		[[nodiscard]] const Resource& get_resource(size_t p_index) const
+		[[nodiscard]] Handle handle(const ResourceData& p_data) const
 		{
-			ASSERT_THROW(m_free_indices.contains(p_index) == false, "Trying to access a free p_index!");
-			return m_resources[p_index]->m_resource;
+			return Handle{p_data.m_slot, m_slots[p_data.m_slot].generation};
 		}
-
-		[[nodiscard]] size_t& get_counter(size_t p_index)
+		[[nodiscard]] ResourceData& get_data(Handle p_handle)
 		{
-			ASSERT_THROW(m_free_indices.contains(p_index) == false, "Trying to access a free p_index!");
-			return m_resources[p_index]->m_count;
+			ASSERT_THROW(is_live(p_handle), "[ResourceManager] Trying to access an erased resource at slot {} generation {}!", p_handle.slot, p_handle.generation);
+			return *m_resources[m_slots[p_handle.slot].dense_index];
 		}
 
-		// Increment the count for resource at p_index.
-		void increment(size_t p_index)
+		// A ResourceRef to the first Resource find_if_func matches, nullopt if none do. Locks m_mutex itself.
+		template <typename Func>
+		[[nodiscard]] std::optional<RefType> find(const Func& find_if_func)
+		{
+			std::lock_guard lock(m_mutex);
+			for (const auto& resource : m_resources)
+			{
+				if (find_if_func(resource->m_resource))
+					return acquire(handle(*resource));
+			}
+			return std::nullopt;
+		}
+		// A ResourceRef to the first Resource created with p_key find_if_func matches, nullopt if none do. Locks m_mutex itself.
+		template <typename Func>
+		[[nodiscard]] std::optional<RefType> find(size_t p_key, const Func& find_if_func)
+		{
+			std::lock_guard lock(m_mutex);
+			const auto [first, last] = m_key_index.equal_range(p_key);
+			for (auto it = first; it != last; it++)
+			{
+				if (find_if_func(get_data(it->second).m_resource))
+					return acquire(it->second);
+			}
+			return std::nullopt;
+		}
+		// A ResourceRef to the existing resource p_handle, taking it out of the cache if only the cache kept it resident.
+		[[nodiscard]] RefType acquire(Handle p_handle)
+		{
+			auto& data = get_data(p_handle);
+			if (data.m_cache_entry)
+			{
+				uncache(data);
+				m_cache_stats.hits++;
+			}
+			return RefType(*this, p_handle);
+		}
+		void uncache(ResourceData& p_data)
 		{
-			get_counter(p_index)++;
-			if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Incremented ResourceRef at index {} with count {}", p_index, get_counter(p_index));
+			m_cache.erase(*p_data.m_cache_entry);
+			p_data.m_cache_entry.reset();
+			m_cache_stats.bytes -= p_data.m_cached_bytes;
+			m_cache_stats.count--;
 		}
-		// Decrement the count for ResourceData at p_index.
-		// If the count reaches 0 then the ResourceData is removed from the manager.
-		void decrement(size_t p_index)
+		// Destroy the least recently released resources until the cache is within its budget.
+		void evict_over_budget()
 		{
-			ASSERT_THROW(m_free_indices.contains(p_index) == false, "Trying to access a free p_index!");
-			if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Decremented ResourceRef at index {} with count {}", p_index, get_counter(p_index) - 1);
+			while (m_cache_stats.bytes > m_cache_stats.budget && !m_cache.empty())
+			{
+				erase(m_cache.front());
+				m_cache_stats.evictions++;
+			}
+		}
 
-			if (--get_counter(p_index) == 0)
-				erase(p_index);
+		// Increment the count for p_data. The caller holds a reference to p_data or m_mutex so it can't be destroyed meanwhile.
+		void increment([[maybe_unused]] Handle p_handle, ResourceData& p_data)
+		{
+			[[maybe_unused]] const size_t count = p_data.m_count.fetch_add(1, std::memory_order_relaxed) + 1;
+			if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Incremented ResourceRef at slot {} with count {}", p_handle.slot, count);
 		}
-		void erase(size_t index)
+		// Decrement the count for p_data identified by p_handle. Doesn't require m_mutex.
+		// If the count reaches 0 then the ResourceData is removed from the manager, immediately on m_owner_thread otherwise by destroy_released.
+		void decrement(Handle p_handle, ResourceData& p_data)
 		{
-			// Erase maintains the index order of m_resources making all the ResourceRefs remain valid after a 'resize'.
-			if (index == m_resources.size() - 1)
-			{// Erasing the last element in the buffer.
-				m_resources.pop_back();
+			// Release orders the uses of the resource by this thread before its destruction on another.
+			const size_t count = p_data.m_count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+			if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Decremented ResourceRef at slot {} with count {}", p_handle.slot, count);
+			if (count != 0)
+				return;
+
+			std::lock_guard lock(m_mutex);
+			if (std::this_thread::get_id() == m_owner_thread)
+				erase_if_released(p_handle);
+			else
+				m_released.push_back(p_handle);
+		}
+		// Cache or erase the resource p_handle if it has no references.
+		// get_or_create can have given out a reference to a released resource, or the handle been erased or cached already, since it was released.
+		void erase_if_released(Handle p_handle)
+		{
+			if (!is_live(p_handle))
+				return;
+
+			auto& data = get_data(p_handle);
+			if (data.m_count.load(std::memory_order_acquire) != 0 || data.m_cache_entry)
+				return;
+
+			if (m_cache_stats.budget == 0)
+			{
+				erase(p_handle);
+				return;
 			}
+
+			if constexpr (Has_Memory_Size<Resource>)
+				data.m_cached_bytes = static_cast<size_t>(data.m_resource.memory_size());
 			else
-			{// Erasing an element in the middle of the buffer. Leaves gap that can be used constructing new Resource.
-				m_resources[index].reset();
-				m_free_indices.insert(index);
+				data.m_cached_bytes = sizeof(Resource);
+			data.m_cache_entry = m_cache.insert(m_cache.end(), p_handle);
+			m_cache_stats.bytes += data.m_cached_bytes;
+			m_cache_stats.count++;
+			evict_over_budget();
+		}
+		void erase(Handle p_handle)
+		{
+			const size_t index = m_slots[p_handle.slot].dense_index;
+			if (m_resources[index]->m_cache_entry)
+				uncache(*m_resources[index]);
+			if (const auto key = m_resources[index]->m_key)
+			{
+				const auto [first, last] = m_key_index.equal_range(*key);
+				m_key_index.erase(std::find_if(first, last, [p_handle](const auto& p_entry) { return p_entry.second == p_handle; }));
 			}
-			if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Erased ResourceRef at index {}", index);
+
+			// Fill the gap with the last resource so m_resources stays packed, only the slot of the moved resource changes.
+			if (index != m_resources.size() - 1)
+			{
+				m_resources[index] = std::move(m_resources.back());
+				m_slots[m_resources[index]->m_slot].dense_index = index;
+			}
+			m_resources.pop_back();
+			free_slot(p_handle.slot);
+			if constexpr (LOG_REF_EVENTS) LOG("[ResourceManager] Erased ResourceRef at slot {}", p_handle.slot);
+		}
+		void free_slot(uint32_t p_slot)
+		{
+			m_slots[p_slot].dense_index = Slot::Free;
+			m_slots[p_slot].generation++;
+			m_free_slots.push_back(p_slot);
 		}
 	};
 	// A ResourceRef is a non-owning pointer to a Resource managed by a ResourceManager.
@@ -247,23 +519,27 @@ namespace Utility
 	class ResourceRef
 	{
 		using Manager = ResourceManager<Resource>;
+		using Handle  = typename Manager::Handle;
+		using Data    = typename Manager::ResourceData;
 
-		Manager* m_manager;            // A non-owning pointer to the ResourceManager that owns the resource.
-		std::optional<size_t> m_index; // The index of the ResourceData in the ResourceManager, used as opposed to a pointer to avoid dangling pointers when m_resources is resized.
+		Manager* m_manager;              // A non-owning pointer to the ResourceManager that owns the resource.
+		std::optional<Handle> m_handle;  // The slot of the ResourceData in the ResourceManager, used to erase it when the count reaches 0.
+		Data* m_data;                    // The ResourceData is heap allocated by the manager and stays at this address while it's referenced.
 
-		// The ResourceManager is a friend so it can access the only valid constructor (private).
+		// The ResourceManager is a friend so it can access the only valid constructor (private). Constructed with the manager's mutex held.
 		friend Manager;
-		ResourceRef(Manager& p_manager, size_t p_index) noexcept : m_manager(&p_manager), m_index(p_index)
+		ResourceRef(Manager& p_manager, Handle p_handle) noexcept : m_manager(&p_manager), m_handle(p_handle), m_data(&p_manager.get_data(p_handle))
 		{
-			if constexpr (LOG_REF_EVENTS) LOG("[ResourceRef] Constructed valid at address {} at index {}", (void*)(this), m_index.value());
-			p_manager.increment(*m_index);
+			if constexpr (LOG_REF_EVENTS) LOG("[ResourceRef] Constructed valid at address {} at slot {}", (void*)(this), m_handle->slot);
+			p_manager.increment(*m_handle, *m_data);
 		}
 
 	public:
 		// Default construct an invalid ResourceRef. Equivalent to constructing a nullopt optional in std.
 		ResourceRef() noexcept
 			: m_manager{nullptr}
-			, m_index(std::nullopt)
+			, m_handle(std::nullopt)
+			, m_data{nullptr}
 		{
 			if constexpr (LOG_REF_EVENTS) LOG("[ResourceRef] Constructed empty at address {}", (void*)(this));
 		}
@@ -271,18 +547,19 @@ namespace Utility
 		~ResourceRef() noexcept
 		{
 			if (has_value())
-				m_manager->decrement(*m_index);
+				m_manager->decrement(*m_handle, *m_data);
 
 			if constexpr (LOG_REF_EVENTS) LOG("[ResourceRef] Destroyed at address {}", (void*)(this));
 		}
 
-		// On copy construct, copy the index and manager ptr and increment the count.
+		// On copy construct, copy the handle and manager ptr and increment the count.
 		ResourceRef(const ResourceRef& p_other) noexcept
 			: m_manager{p_other.m_manager}
-			, m_index{p_other.m_index}
+			, m_handle{p_other.m_handle}
+			, m_data{p_other.m_data}
 		{
 			if (has_value())
-				m_manager->increment(*m_index);
+				m_manager->increment(*m_handle, *m_data);
 
 			if constexpr (LOG_REF_EVENTS) LOG("[ResourceRef] Copy-constructing {} from {}", (void*)(this), (void*)(&p_other));
 		}
@@ -293,22 +570,24 @@ namespace Utility
 			if (this != &p_other)
 			{
 				if (has_value())
-					m_manager->decrement(*m_index);
+					m_manager->decrement(*m_handle, *m_data);
 
 				m_manager = p_other.m_manager;
-				m_index   = p_other.m_index;
+				m_handle  = p_other.m_handle;
+				m_data    = p_other.m_data;
 
 				if (has_value())
-					m_manager->increment(*m_index);
+					m_manager->increment(*m_handle, *m_data);
 			}
 
 			if constexpr (LOG_REF_EVENTS) LOG("[ResourceRef] Copy-assigning {} from {}", (void*)(this), (void*)(&p_other));
 			return *this;
 		}
-		// On move construct, move the resource ptr and manager ptr and index. Leave the old ResourceRef in an invalid state.
+		// On move construct, move the resource ptr and manager ptr and handle. Leave the old ResourceRef in an invalid state.
 		ResourceRef(ResourceRef&& p_other) noexcept
 			: m_manager{std::exchange(p_other.m_manager, nullptr)}
-			, m_index{std::exchange(p_other.m_index, std::nullopt)}
+			, m_handle{std::exchange(p_other.m_handle, std::nullopt)}
+			, m_data{std::exchange(p_other.m_data, nullptr)}
 		{
 			if constexpr (LOG_REF_EVENTS) LOG("[ResourceRef] Move-constructing {} from {}", (void*)(this), (void*)(&p_other));
 		}
@@ -318,26 +597,27 @@ namespace Utility
 			if (this != &p_other)
 			{
 				if (has_value())
-					m_manager->decrement(*m_index);
+					m_manager->decrement(*m_handle, *m_data);
 
 				m_manager = std::exchange(p_other.m_manager, nullptr);
-				m_index   = std::exchange(p_other.m_index, std::nullopt);
+				m_handle  = std::exchange(p_other.m_handle, std::nullopt);
+				m_data    = std::exchange(p_other.m_data, nullptr);
 			}
 			if constexpr (LOG_REF_EVENTS) LOG("[ResourceRef] Move-assigning {} from {}", (void*)(this), (void*)(&p_other));
 			return *this;
 		}
 
-		constexpr const Resource* operator->() const noexcept   { return &m_manager->get_resource(m_index.value()); };
-		constexpr Resource* operator->() noexcept               { return &m_manager->get_resource(m_index.value()); };
-		constexpr const Resource& operator*() const& noexcept   { return m_manager->get_resource(m_index.value()); };
-		constexpr Resource& operator*() & noexcept              { return m_manager->get_resource(m_index.value()); };
-		constexpr const Resource&& operator*() const&& noexcept { return m_manager->get_resource(m_index.value()); };
-		constexpr Resource&& operator*() && noexcept            { return m_manager->get_resource(m_index.value()); };
-		constexpr Resource& value() noexcept                    { return m_manager->get_resource(m_index.value()); };
-		constexpr const Resource& value() const noexcept        { return m_manager->get_resource(m_index.value()); };
+		constexpr const Resource* operator->() const noexcept   { return &m_data->m_resource; };
+		constexpr Resource* operator->() noexcept               { return &m_data->m_resource; };
+		constexpr const Resource& operator*() const& noexcept   { return m_data->m_resource; };
+		constexpr Resource& operator*() & noexcept              { return m_data->m_resource; };
+		constexpr const Resource&& operator*() const&& noexcept { return m_data->m_resource; };
+		constexpr Resource&& operator*() && noexcept            { return m_data->m_resource; };
+		constexpr Resource& value() noexcept                    { return m_data->m_resource; };
+		constexpr const Resource& value() const noexcept        { return m_data->m_resource; };
 		constexpr bool has_value() const noexcept               { return m_manager != nullptr; };
 		constexpr explicit operator bool() const noexcept       { return has_value(); };
-		constexpr operator Resource&() noexcept                 { return m_manager->get_resource(m_index.value()); }
-		constexpr operator const Resource&() const noexcept     { return m_manager->get_resource(m_index.value()); }
+		constexpr operator Resource&() noexcept                 { return m_data->m_resource; }
+		constexpr operator const Resource&() const noexcept     { return m_data->m_resource; }
 	};
 } // namespace Utility
\ No newline at end of file
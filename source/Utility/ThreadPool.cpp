@@ -0,0 +1,96 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace Utility
+{
+	ThreadPool::ThreadPool(size_t p_thread_count)
+		: m_workers{}
+		, m_mutex{}
+		, m_job_available{}
+		, m_job_complete{}
+		, m_job{nullptr}
+		, m_job_count{0}
+		, m_next_index{0}
+		, m_busy_workers{0}
+		, m_job_generation{0}
+		, m_stopping{false}
+	{
+		if (p_thread_count == 0)
+			p_thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+		m_workers.reserve(p_thread_count - 1);
+		for (size_t i = 0; i < p_thread_count - 1; i++)
+			m_workers.emplace_back([this]() { worker_loop(); });
+	}
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopping = true;
+		}
+		m_job_available.notify_all();
+
+		for (auto& worker : m_workers)
+			worker.join();
+	}
+
+	void ThreadPool::parallel_for(size_t p_count, const std::function<void(size_t)>& p_function)
+	{
+		if (p_count == 0)
+			return;
+
+		if (m_workers.empty() || p_count == 1)
+		{
+			for (size_t i = 0; i < p_count; i++)
+				p_function(i);
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_job          = &p_function;
+			m_job_count    = p_count;
+			m_next_index   = 0;
+			m_busy_workers = m_workers.size();
+			m_job_generation++;
+		}
+		m_job_available.notify_all();
+
+		run_job();
+
+		std::unique_lock lock(m_mutex);
+		m_job_complete.wait(lock, [this]() { return m_busy_workers == 0; });
+		m_job = nullptr;
+	}
+
+	void ThreadPool::worker_loop()
+	{
+		size_t last_generation = 0;
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_job_available.wait(lock, [this, last_generation]() { return m_stopping || m_job_generation != last_generation; });
+				if (m_stopping)
+					return;
+
+				last_generation = m_job_generation;
+			}
+
+			run_job();
+
+			{
+				std::lock_guard lock(m_mutex);
+				m_busy_workers--;
+			}
+			m_job_complete.notify_one();
+		}
+	}
+
+	void ThreadPool::run_job()
+	{
+		for (size_t i = m_next_index.fetch_add(1); i < m_job_count; i = m_next_index.fetch_add(1))
+			(*m_job)(i);
+	}
+} // namespace Utility
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utility
+{
+	// A fixed set of worker threads used to split a loop of independent iterations across cores.
+	// The thread calling parallel_for takes part in the work and the call returns once every iteration is complete.
+	// parallel_for is not re-entrant, it must not be called from inside a job or from more than one thread at a time.
+	class ThreadPool
+	{
+	public:
+		// Construct a pool using p_thread_count threads in total including the calling thread.
+		// 0 uses std::thread::hardware_concurrency. 1 creates no workers and runs every job on the calling thread.
+		explicit ThreadPool(size_t p_thread_count = 0);
+		~ThreadPool();
+		ThreadPool(const ThreadPool&)            = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Number of threads parallel_for distributes work over including the calling thread.
+		size_t thread_count() const { return m_workers.size() + 1; }
+		// Call p_function(index) for every index in [0, p_count).
+		// Indices are claimed by threads as they become free so p_function must not depend on the order they run in.
+		void parallel_for(size_t p_count, const std::function<void(size_t)>& p_function);
+
+	private:
+		std::vector<std::thread> m_workers;
+		std::mutex m_mutex;
+		std::condition_variable m_job_available;
+		std::condition_variable m_job_complete;
+
+		const std::function<void(size_t)>* m_job; // The job being executed, valid while m_busy_workers > 0.
+		size_t m_job_count;                        // Number of indices in the current job.
+		std::atomic<size_t> m_next_index;          // Next unclaimed index of the current job.
+		size_t m_busy_workers;                     // Workers yet to finish the current job.
+		size_t m_job_generation;                   // Incremented per job so workers can tell a new job from a spurious wakeup.
+		bool m_stopping;
+
+		void worker_loop();
+		// Claim and run indices of the current job until none remain.
+		void run_job();
+	};
+} // namespace Utility
\ No newline at end of file